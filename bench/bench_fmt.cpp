@@ -1,6 +1,8 @@
 #include <benchmark/benchmark.h>
 #include "zen_fmt.h"
 #include <charconv>
+#include <string_view>
+#include <array>
 
 static void fmt__std_to_chars(benchmark::State& state) {
     char buffer[20];
@@ -21,3 +23,485 @@ static void fmt__fmt_int_to_chars(benchmark::State& state) {
     }
 }
 BENCHMARK(fmt__fmt_int_to_chars);
+
+// Every digit count, so the benches are not tuned to one length
+static constexpr u64 INT_VALUES[] = { 
+    7, 42, 123, 4096, 65535, 1234567, 12345678, 987654321, 4294967295, 123123123123123, 9007199254740993, 18446744073709551615u };
+
+template<int Base>
+static void fmt__std_to_chars_base(benchmark::State& state) {
+    char buffer[64];
+    for (auto _ : state) {
+        for (u64 v : INT_VALUES) {
+            std::to_chars(buffer, buffer + 64, v, Base);
+            benchmark::DoNotOptimize(buffer);
+        }
+    }
+}
+BENCHMARK(fmt__std_to_chars_base<10>);
+BENCHMARK(fmt__std_to_chars_base<16>);
+BENCHMARK(fmt__std_to_chars_base<8>);
+BENCHMARK(fmt__std_to_chars_base<2>);
+
+template<usize Base>
+static void fmt__fmt_int_to_chars_base(benchmark::State& state) {
+    char buffer[64];
+    for (auto _ : state) {
+        for (u64 v : INT_VALUES) {
+            zen::fmt::int_to_chars<Base>(buffer, buffer + 64, v);
+            benchmark::DoNotOptimize(buffer);
+        }
+    }
+}
+BENCHMARK(fmt__fmt_int_to_chars_base<10>);
+BENCHMARK(fmt__fmt_int_to_chars_base<16>);
+BENCHMARK(fmt__fmt_int_to_chars_base<8>);
+BENCHMARK(fmt__fmt_int_to_chars_base<2>);
+
+static void fmt__fmt_int_to_chars_i64(benchmark::State& state) {
+    char buffer[64];
+    for (auto _ : state) {
+        for (u64 v : INT_VALUES) {
+            zen::fmt::int_to_chars(buffer, buffer + 64, -i64(v >> 1));
+            benchmark::DoNotOptimize(buffer);
+        }
+    }
+}
+BENCHMARK(fmt__fmt_int_to_chars_i64);
+
+#ifdef ZEN_INT128
+static void fmt__fmt_int_to_chars_u128(benchmark::State& state) {
+    char buffer[64];
+    for (auto _ : state) {
+        for (u64 v : INT_VALUES) {
+            zen::fmt::int_to_chars(buffer, buffer + 64, u128(v) * v);
+            benchmark::DoNotOptimize(buffer);
+        }
+    }
+}
+BENCHMARK(fmt__fmt_int_to_chars_u128);
+#endif
+
+
+// Short, medium and full-width inputs
+static constexpr std::string_view INT_STRINGS[] = { 
+    "7", "1234", "65535", "12345678", "4294967295", "123123123123123", "9007199254740993", "18446744073709551615" };
+
+static void fmt__std_from_chars(benchmark::State& state) {
+    u64 v{};
+    usize i{};
+    for (auto _ : state) {
+        const auto s = INT_STRINGS[i++ & 7];
+        std::from_chars(s.data(), s.data() + s.size(), v);
+        benchmark::DoNotOptimize(v);
+    }
+}
+BENCHMARK(fmt__std_from_chars);
+
+static void fmt__fmt_chars_to_int(benchmark::State& state) {
+    u64 v{};
+    usize i{};
+    for (auto _ : state) {
+        const auto s = INT_STRINGS[i++ & 7];
+        zen::fmt::chars_to_int(s.data(), s.data() + s.size(), v);
+        benchmark::DoNotOptimize(v);
+    }
+}
+BENCHMARK(fmt__fmt_chars_to_int);
+
+static void fmt__std_from_chars_hex(benchmark::State& state) {
+    const std::string_view s{"cafebabe12345678"};
+    u64 v{};
+    for (auto _ : state) {
+        std::from_chars(s.data(), s.data() + s.size(), v, 16);
+        benchmark::DoNotOptimize(v);
+    }
+}
+BENCHMARK(fmt__std_from_chars_hex);
+
+static void fmt__fmt_chars_to_int_hex(benchmark::State& state) {
+    const std::string_view s{"cafebabe12345678"};
+    u64 v{};
+    for (auto _ : state) {
+        zen::fmt::chars_to_int<16>(s.data(), s.data() + s.size(), v);
+        benchmark::DoNotOptimize(v);
+    }
+}
+BENCHMARK(fmt__fmt_chars_to_int_hex);
+
+
+// Mixed magnitudes so the fixed/scientific choice is not always the same
+static constexpr f64 FLOAT_VALUES[] = { 
+    3.141592653589793, 0.1, 1234.5678, 6.02214076e23, 
+    -2.718281828459045e-11, 1e100, 0.30000000000000004, 42.0 };
+
+static void fmt__snprintf_f64(benchmark::State& state) {
+    char buffer[32];
+    usize i{};
+    for (auto _ : state) {
+        snprintf(buffer, sizeof(buffer), "%.17g", FLOAT_VALUES[i++ & 7]);
+        benchmark::DoNotOptimize(buffer);
+    }
+}
+BENCHMARK(fmt__snprintf_f64);
+
+static void fmt__std_to_chars_f64(benchmark::State& state) {
+    char buffer[32];
+    usize i{};
+    for (auto _ : state) {
+        std::to_chars(buffer, buffer + 32, FLOAT_VALUES[i++ & 7]);
+        benchmark::DoNotOptimize(buffer);
+    }
+}
+BENCHMARK(fmt__std_to_chars_f64);
+
+static void fmt__fmt_float_to_chars_f64(benchmark::State& state) {
+    char buffer[32];
+    usize i{};
+    for (auto _ : state) {
+        zen::fmt::float_to_chars(buffer, buffer + 32, FLOAT_VALUES[i++ & 7]);
+        benchmark::DoNotOptimize(buffer);
+    }
+}
+BENCHMARK(fmt__fmt_float_to_chars_f64);
+
+static void fmt__std_to_chars_f32(benchmark::State& state) {
+    char buffer[32];
+    usize i{};
+    for (auto _ : state) {
+        std::to_chars(buffer, buffer + 32, f32(FLOAT_VALUES[i++ & 7]));
+        benchmark::DoNotOptimize(buffer);
+    }
+}
+BENCHMARK(fmt__std_to_chars_f32);
+
+static void fmt__fmt_float_to_chars_f32(benchmark::State& state) {
+    char buffer[32];
+    usize i{};
+    for (auto _ : state) {
+        zen::fmt::float_to_chars(buffer, buffer + 32, f32(FLOAT_VALUES[i++ & 7]));
+        benchmark::DoNotOptimize(buffer);
+    }
+}
+BENCHMARK(fmt__fmt_float_to_chars_f32);
+
+// Shortest round-trip strings of FLOAT_VALUES, plus a long input that needs the exact fallback
+static constexpr std::string_view FLOAT_STRINGS[] = { 
+    "3.141592653589793", "0.1", "1234.5678", "6.02214076e+23", 
+    "-2.718281828459045e-11", "1e+100", "0.30000000000000004", "42" };
+
+static constexpr std::string_view FLOAT_STRING_LONG{"9007199254740993.00000000000000000000000000000000000001"};
+
+static void fmt__strtod_f64(benchmark::State& state) {
+    usize i{};
+    for (auto _ : state) {
+        f64 v = strtod(FLOAT_STRINGS[i++ & 7].data(), nullptr);
+        benchmark::DoNotOptimize(v);
+    }
+}
+BENCHMARK(fmt__strtod_f64);
+
+static void fmt__std_from_chars_f64(benchmark::State& state) {
+    f64 v{};
+    usize i{};
+    for (auto _ : state) {
+        const auto s = FLOAT_STRINGS[i++ & 7];
+        std::from_chars(s.data(), s.data() + s.size(), v);
+        benchmark::DoNotOptimize(v);
+    }
+}
+BENCHMARK(fmt__std_from_chars_f64);
+
+static void fmt__fmt_chars_to_float_f64(benchmark::State& state) {
+    f64 v{};
+    usize i{};
+    for (auto _ : state) {
+        const auto s = FLOAT_STRINGS[i++ & 7];
+        zen::fmt::chars_to_float(s.data(), s.data() + s.size(), v);
+        benchmark::DoNotOptimize(v);
+    }
+}
+BENCHMARK(fmt__fmt_chars_to_float_f64);
+
+static void fmt__std_from_chars_f32(benchmark::State& state) {
+    f32 v{};
+    usize i{};
+    for (auto _ : state) {
+        const auto s = FLOAT_STRINGS[i++ & 7];
+        std::from_chars(s.data(), s.data() + s.size(), v);
+        benchmark::DoNotOptimize(v);
+    }
+}
+BENCHMARK(fmt__std_from_chars_f32);
+
+static void fmt__fmt_chars_to_float_f32(benchmark::State& state) {
+    f32 v{};
+    usize i{};
+    for (auto _ : state) {
+        const auto s = FLOAT_STRINGS[i++ & 7];
+        zen::fmt::chars_to_float(s.data(), s.data() + s.size(), v);
+        benchmark::DoNotOptimize(v);
+    }
+}
+BENCHMARK(fmt__fmt_chars_to_float_f32);
+
+static void fmt__std_from_chars_f64_long(benchmark::State& state) {
+    f64 v{};
+    const auto s = FLOAT_STRING_LONG;
+    for (auto _ : state) {
+        std::from_chars(s.data(), s.data() + s.size(), v);
+        benchmark::DoNotOptimize(v);
+    }
+}
+BENCHMARK(fmt__std_from_chars_f64_long);
+
+static void fmt__fmt_chars_to_float_f64_long(benchmark::State& state) {
+    f64 v{};
+    const auto s = FLOAT_STRING_LONG;
+    for (auto _ : state) {
+        zen::fmt::chars_to_float(s.data(), s.data() + s.size(), v);
+        benchmark::DoNotOptimize(v);
+    }
+}
+BENCHMARK(fmt__fmt_chars_to_float_f64_long);
+
+static void fmt__snprintf_f64_precision(benchmark::State& state) {
+    char buffer[512];
+    usize i{};
+    for (auto _ : state) {
+        snprintf(buffer, sizeof(buffer), "%.6f", FLOAT_VALUES[i++ & 7]);
+        benchmark::DoNotOptimize(buffer);
+    }
+}
+BENCHMARK(fmt__snprintf_f64_precision);
+
+static void fmt__std_to_chars_f64_precision(benchmark::State& state) {
+    char buffer[512];
+    usize i{};
+    for (auto _ : state) {
+        std::to_chars(buffer, buffer + 512, FLOAT_VALUES[i++ & 7], std::chars_format::fixed, 6);
+        benchmark::DoNotOptimize(buffer);
+    }
+}
+BENCHMARK(fmt__std_to_chars_f64_precision);
+
+static void fmt__fmt_float_to_chars_f64_precision(benchmark::State& state) {
+    char buffer[512];
+    usize i{};
+    for (auto _ : state) {
+        zen::fmt::float_to_chars(buffer, buffer + 512, FLOAT_VALUES[i++ & 7], 6);
+        benchmark::DoNotOptimize(buffer);
+    }
+}
+BENCHMARK(fmt__fmt_float_to_chars_f64_precision);
+
+
+// Whole format calls, a few conversions plus literal text
+static void fmt__snprintf_format(benchmark::State& state) {
+    char buffer[128];
+    for (auto _ : state) {
+        snprintf(buffer, sizeof(buffer), "id=%d name=%s value=%.3f hex=%x", 123456, "zen", 3.14159, 0xcafe);
+        benchmark::DoNotOptimize(buffer);
+    }
+}
+BENCHMARK(fmt__snprintf_format);
+
+static void fmt__format_buffer(benchmark::State& state) {
+    for (auto _ : state) {
+        zen::fmt::buffer<128> out{};
+        zen::format(out, "id={} name={} value={:.3} hex={x:}", 123456, "zen", 3.14159, 0xcafe);
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(fmt__format_buffer);
+
+static void fmt__format_dynamic_buffer(benchmark::State& state) {
+    zen::fmt::dynamic_buffer<16> out{};
+    for (auto _ : state) {
+        out.clear();
+        zen::format(out, "id={} name={} value={:.3} hex={x:}", 123456, "zen", 3.14159, 0xcafe);
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(fmt__format_dynamic_buffer);
+
+// Table row with runtime column widths, padded through a temporary against a dynamic width
+static void fmt__format_column_temporary(benchmark::State& state) {
+    zen::fmt::dynamic_buffer<16> out{};
+    const int widths[]{12, 8};
+    for (auto _ : state) {
+        out.clear();
+        zen::fmt::buffer<32> name{}, value{};
+        zen::format(name, "{}", "latency");
+        zen::format(value, "{}", 123456);
+        out.append_n(' ', usize(widths[0]) - name.size());
+        out << name.view() << '|';
+        out.append_n(' ', usize(widths[1]) - value.size());
+        out << value.view();
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(fmt__format_column_temporary);
+
+static void fmt__format_column_dynamic(benchmark::State& state) {
+    zen::fmt::dynamic_buffer<16> out{};
+    const int widths[]{12, 8};
+    for (auto _ : state) {
+        out.clear();
+        zen::format(out, "{:>{}}|{:>{}}", "latency", widths[0], 123456, widths[1]);
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(fmt__format_column_dynamic);
+
+
+// Line output, stdio against the batched fd writer
+static void fmt__fprintf_lines(benchmark::State& state) {
+    FILE* f = fopen("/dev/null", "w");
+    for (auto _ : state)
+        fprintf(f, "id=%d name=%s value=%.3f\n", 123456, "zen", 3.14159);
+    fclose(f);
+}
+BENCHMARK(fmt__fprintf_lines);
+
+static void fmt__fd_writer_lines(benchmark::State& state) {
+    FILE* f = fopen("/dev/null", "w");
+    {
+        zen::fmt::fd_writer w{fileno(f), true};
+        for (auto _ : state) {
+            w.begin_message();
+            zen::format(w, "id={} name={} value={:.3}\n", 123456, "zen", 3.14159);
+            w.end_message();
+        }
+    }
+    fclose(f);
+}
+BENCHMARK(fmt__fd_writer_lines);
+
+// Sizing pass against the full format it predicts
+static void fmt__formatted_size(benchmark::State& state) {
+    for (auto _ : state) {
+        auto n = zen::fmt::formatted_size("id={} name={} count={} hex={x:}", 123456, "zen", u64(987654321987), 0xcafe);
+        benchmark::DoNotOptimize(n);
+    }
+}
+BENCHMARK(fmt__formatted_size);
+
+static void fmt__formatted_size_format(benchmark::State& state) {
+    zen::fmt::dynamic_buffer<16> out{};
+    for (auto _ : state) {
+        out.clear();
+        zen::format(out, "id={} name={} count={} hex={x:}", 123456, "zen", u64(987654321987), 0xcafe);
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(fmt__formatted_size_format);
+
+// Byte spans as hex, a printf loop against the vector encoder
+static const auto BYTES_4K = []{
+    std::array<u8, 4096> b{};
+    for (usize i = 0; i < b.size(); ++i) b[i] = u8(i * 131 + 7);
+    return b;
+}();
+
+static void fmt__snprintf_hex_4k(benchmark::State& state) {
+    static char out[8192 + 1];
+    for (auto _ : state) {
+        for (usize i = 0; i < BYTES_4K.size(); ++i) snprintf(out + i * 2, 3, "%02x", BYTES_4K[i]);
+        benchmark::DoNotOptimize(out);
+    }
+}
+BENCHMARK(fmt__snprintf_hex_4k);
+
+static void fmt__fmt_hex_encode_4k(benchmark::State& state) {
+    static char out[8192];
+    for (auto _ : state) {
+        zen::fmt::hex_encode(out, BYTES_4K);
+        benchmark::DoNotOptimize(out);
+    }
+}
+BENCHMARK(fmt__fmt_hex_encode_4k);
+
+static void fmt__fmt_binary_encode_4k(benchmark::State& state) {
+    static char out[32768];
+    for (auto _ : state) {
+        zen::fmt::binary_encode(out, BYTES_4K);
+        benchmark::DoNotOptimize(out);
+    }
+}
+BENCHMARK(fmt__fmt_binary_encode_4k);
+
+static void fmt__fmt_hexdump_4k(benchmark::State& state) {
+    zen::fmt::dynamic_buffer<> out{};
+    for (auto _ : state) {
+        out.clear();
+        out << zen::fmt::hexdump{BYTES_4K};
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(fmt__fmt_hexdump_4k);
+
+// Mostly clean log text with an occasional control char, only those leave the vector loop
+static void fmt__fmt_escaped(benchmark::State& state) {
+    zen::fmt::dynamic_buffer<> out{};
+    std::string s(usize(state.range(0)), 'x');
+    for (usize i = 0; i < s.size(); i += 97)
+        s[i] = '\n';
+    for (auto _ : state) {
+        out.clear();
+        zen::format(out, "{?:}", s);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(i64(state.iterations() * s.size()));
+}
+BENCHMARK(fmt__fmt_escaped)->Arg(16)->Arg(256)->Arg(4096);
+
+// A log prefix per message, strftime and the sub-second digits against the cached prefix
+static void fmt__strftime_timestamp(benchmark::State& state) {
+    char out[64];
+    i64 ns = INT64_C(1792182043000000000);
+    for (auto _ : state) {
+        const time_t s = time_t(ns / 1000000000);
+        const usize n = strftime(out, sizeof(out), "%Y-%m-%dT%H:%M:%S.", gmtime(&s));
+        snprintf(out + n, sizeof(out) - n, "%03dZ", int(ns / 1000000 % 1000));
+        benchmark::DoNotOptimize(out);
+        ns += 1000;
+    }
+}
+BENCHMARK(fmt__strftime_timestamp);
+
+static void fmt__fmt_timestamp(benchmark::State& state) {
+    zen::fmt::buffer<> out{};
+    i64 ns = INT64_C(1792182043000000000);
+    for (auto _ : state) {
+        out.clear();
+        out << zen::fmt::timestamp{ns};
+        benchmark::DoNotOptimize(out.data());
+        ns += 1000;
+    }
+}
+BENCHMARK(fmt__fmt_timestamp);
+
+// Framing a large payload, copied into a buffer or referenced by a gather sink
+static const std::string PAYLOAD_64K(64 * 1024, 'p');
+
+static void fmt__fmt_frame_copy_64k(benchmark::State& state) {
+    zen::fmt::dynamic_buffer<> out{};
+    for (auto _ : state) {
+        out.clear();
+        zen::format(out, "HTTP/1.1 200 OK\r\nContent-Length: {}\r\n\r\n{}", PAYLOAD_64K.size(), PAYLOAD_64K);
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(fmt__fmt_frame_copy_64k);
+
+static void fmt__fmt_frame_gather_64k(benchmark::State& state) {
+    zen::fmt::gather_sink<> out{};
+    zen::string_view chunks[3];
+    for (auto _ : state) {
+        out.clear();
+        zen::format(out, "HTTP/1.1 200 OK\r\nContent-Length: {}\r\n\r\n{}", PAYLOAD_64K.size(), PAYLOAD_64K);
+        benchmark::DoNotOptimize(out.chunks(chunks));
+    }
+}
+BENCHMARK(fmt__fmt_frame_gather_64k);
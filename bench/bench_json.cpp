@@ -0,0 +1,60 @@
+#include <benchmark/benchmark.h>
+#include "zen_json.h"
+#include <string>
+
+// Records with a long message, like a log line or an event payload
+struct json_record { u64 id; i32 code; f64 latency; const char* host; std::string message; };
+
+static json_record json_make_record(u64 i, bool escapes) {
+    std::string message = "request " + std::to_string(i) + " finished after retrying the upstream connection twice, cache was cold";
+    if (escapes)
+        message += "\n\t\"quoted\" path C:\\tmp";
+    return {i, i32(200 + i % 7), 0.125 * f64(i % 13), "api-eu-west-1.internal", message};
+}
+
+// Unchecked and unescaped, what the writer replaces
+static void json__hand_rolled(benchmark::State& state) {
+    zen::fmt::dynamic_buffer<> out{};
+    const json_record r = json_make_record(12345, false);
+    for (auto _ : state) {
+        out.clear();
+        out << "{\"id\":" << r.id << ",\"code\":" << r.code << ",\"latency\":" << r.latency
+            << ",\"host\":\"" << r.host << "\",\"message\":\"" << zen::string_view{r.message} << "\"}";
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(i64(state.iterations() * out.size()));
+}
+BENCHMARK(json__hand_rolled);
+
+static void json__writer(benchmark::State& state) {
+    zen::json_writer<> json{};
+    const json_record r = json_make_record(12345, state.range(0) != 0);
+    for (auto _ : state) {
+        json.reset();
+        json.begin_object()
+            .member("id", r.id)
+            .member("code", r.code)
+            .member("latency", r.latency)
+            .member("host", r.host)
+            .member("message", r.message)
+            .end_object();
+        benchmark::DoNotOptimize(json.sink().data());
+    }
+    state.SetBytesProcessed(i64(state.iterations() * json.sink().size()));
+}
+BENCHMARK(json__writer)->Arg(0)->Arg(1);
+
+// Clean text is copied in bulk, only the escaped chars take the slow path
+static void json__write_string(benchmark::State& state) {
+    zen::fmt::dynamic_buffer<> out{};
+    std::string s(usize(state.range(0)), 'x');
+    for (usize i = 0; i < s.size(); i += 97)
+        s[i] = '"';
+    for (auto _ : state) {
+        out.clear();
+        zen::json::write_string(out, s);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(i64(state.iterations() * s.size()));
+}
+BENCHMARK(json__write_string)->Arg(16)->Arg(256)->Arg(4096);
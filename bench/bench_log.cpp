@@ -0,0 +1,26 @@
+#include <benchmark/benchmark.h>
+#include "zen_log.h"
+
+// Producer side cost, the logger thread formats into /dev/null
+static void log__zen_log_info(benchmark::State& state) {
+    FILE* f = fopen("/dev/null", "w");
+    {
+        zen::logging::logger log{fileno(f), {.ring_size = 1 << 22, .policy = zen::logging::overflow::block}};
+        for (auto _ : state)
+            ZEN_LOG_INFO(log, "id={} name={} value={:.3}", 123456, "zen", 3.14159);
+        log.flush();
+    }
+    fclose(f);
+}
+BENCHMARK(log__zen_log_info);
+
+static void log__zen_log_filtered(benchmark::State& state) {
+    FILE* f = fopen("/dev/null", "w");
+    {
+        zen::logging::logger log{fileno(f), {.min_level = zen::logging::level::warn}};
+        for (auto _ : state)
+            ZEN_LOG_INFO(log, "id={} name={} value={:.3}", 123456, "zen", 3.14159);
+    }
+    fclose(f);
+}
+BENCHMARK(log__zen_log_filtered);
@@ -0,0 +1,48 @@
+#include <benchmark/benchmark.h>
+#include "zen_multi_matcher.h"
+#include <string>
+#include <vector>
+
+// Log lines scanned for a keyword set, about one line in eight has a hit
+static std::string log_text() {
+    std::string text;
+    for (int i = 0; i < 2000; ++i) {
+        text += "2024-05-01T12:00:" + std::to_string(i % 60) + " worker-" + std::to_string(i % 17) + " handled request id=" + std::to_string(i * 7919);
+        text += i % 8 == 0 ? " status=timeout\n" : " status=ok\n";
+    }
+    return text;
+}
+
+static std::vector<std::string> keywords(usize n) {
+    std::vector<std::string> words{"timeout", "refused", "panic", "oom-killer", "segfault", "denied", "corrupt", "deadlock"};
+    for (usize i = words.size(); i < n; ++i)
+        words.push_back("keyword" + std::to_string(i * 31) + "x");
+    words.resize(n);
+    return words;
+}
+
+static void multi_match__find_per_keyword(benchmark::State& state) {
+    const std::string text = log_text();
+    const auto words = keywords(usize(state.range(0)));
+    for (auto _ : state) {
+        usize n = 0;
+        for (const auto& w: words) {
+            for (usize pos = text.find(w); pos != std::string::npos; pos = text.find(w, pos + 1))
+                ++n;
+        }
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetBytesProcessed(i64(state.iterations() * text.size()));
+}
+BENCHMARK(multi_match__find_per_keyword)->Arg(8)->Arg(32)->Arg(300);
+
+static void multi_match__multi_matcher(benchmark::State& state) {
+    const std::string text = log_text();
+    const auto words = keywords(usize(state.range(0)));
+    const std::vector<zen::string_view> patterns{words.begin(), words.end()};
+    const zen::multi_matcher m{patterns};
+    for (auto _ : state)
+        benchmark::DoNotOptimize(m.count(text));
+    state.SetBytesProcessed(i64(state.iterations() * text.size()));
+}
+BENCHMARK(multi_match__multi_matcher)->Arg(8)->Arg(32)->Arg(300);
@@ -0,0 +1,32 @@
+#include <benchmark/benchmark.h>
+#include "zen_scan.h"
+#include <cstdio>
+
+// A fixed-layout access log line
+static const char SCAN_LINE[] = "10.0.0.1:8080 GET 200 1532 0.0125";
+
+static void scan__sscanf(benchmark::State& state) {
+    char host[32];
+    unsigned port{}, status{}, bytes{};
+    char method[8];
+    double seconds{};
+    for (auto _ : state) {
+        const int n = sscanf(SCAN_LINE, "%31[^:]:%u %7s %u %u %lf", host, &port, method, &status, &bytes, &seconds);
+        benchmark::DoNotOptimize(n);
+        benchmark::DoNotOptimize(seconds);
+    }
+}
+BENCHMARK(scan__sscanf);
+
+static void scan__zen_scan(benchmark::State& state) {
+    zen::string_view host{}, method{};
+    u16 port{}, status{};
+    u32 bytes{};
+    f64 seconds{};
+    for (auto _ : state) {
+        const auto r = zen::scan(SCAN_LINE, "{}:{} {} {} {} {}", host, port, method, status, bytes, seconds);
+        benchmark::DoNotOptimize(r);
+        benchmark::DoNotOptimize(seconds);
+    }
+}
+BENCHMARK(scan__zen_scan);
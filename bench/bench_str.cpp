@@ -0,0 +1,190 @@
+#include <benchmark/benchmark.h>
+#include "zen_str.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+// 4 KiB of log-like text with the searched for bytes near the end
+static const std::string& str_text() {
+    static const std::string text = [] {
+        std::string t;
+        while (t.size() < 4096)
+            t += "GET /api/v1/items?page=2 200 1532 0.0125 ";
+        t.resize(4096);
+        t.replace(4000, 9, "needle:42");
+        return t;
+    }();
+    return text;
+}
+
+static void str__memchr(benchmark::State& state) {
+    const std::string& t = str_text();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(memchr(t.data(), ':', t.size()));
+}
+BENCHMARK(str__memchr);
+
+static void str__zen_find_char(benchmark::State& state) {
+    const std::string& t = str_text();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(zen::str::find(t, ':'));
+}
+BENCHMARK(str__zen_find_char);
+
+static void str__std_find(benchmark::State& state) {
+    const std::string_view t = str_text();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(t.find("needle"));
+}
+BENCHMARK(str__std_find);
+
+static void str__zen_find(benchmark::State& state) {
+    const std::string_view t = str_text();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(zen::str::find(t, "needle"));
+}
+BENCHMARK(str__zen_find);
+
+// Most chars of the text start a partial match of this one
+static void str__std_find_common(benchmark::State& state) {
+    const std::string_view t = str_text();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(t.find("e 200 1533"));
+}
+BENCHMARK(str__std_find_common);
+
+static void str__zen_find_common(benchmark::State& state) {
+    const std::string_view t = str_text();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(zen::str::find(t, "e 200 1533"));
+}
+BENCHMARK(str__zen_find_common);
+
+static void str__std_rfind(benchmark::State& state) {
+    const std::string_view t = str_text();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(t.rfind("/api/v2"));
+}
+BENCHMARK(str__std_rfind);
+
+static void str__zen_rfind(benchmark::State& state) {
+    const std::string_view t = str_text();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(zen::str::rfind(t, "/api/v2"));
+}
+BENCHMARK(str__zen_rfind);
+
+static void str__std_find_first_of(benchmark::State& state) {
+    const std::string_view t = str_text();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(t.find_first_of(":;\"\\"));
+}
+BENCHMARK(str__std_find_first_of);
+
+static void str__zen_find_any(benchmark::State& state) {
+    const std::string_view t = str_text();
+    const zen::str::byteset set{":;\"\\"};
+    for (auto _ : state)
+        benchmark::DoNotOptimize(zen::str::find_any(t, set));
+}
+BENCHMARK(str__zen_find_any);
+
+static void str__std_count(benchmark::State& state) {
+    const std::string_view t = str_text();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(std::count(t.begin(), t.end(), ' '));
+}
+BENCHMARK(str__std_count);
+
+static void str__zen_count(benchmark::State& state) {
+    const std::string_view t = str_text();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(zen::str::count(t, ' '));
+}
+BENCHMARK(str__zen_count);
+
+// Short identifiers, where the cost of calling memcmp shows
+static void str__std_equal_short(benchmark::State& state) {
+    std::string a = "service.requests.latency", b = a;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a.data());
+        benchmark::DoNotOptimize(b.data());
+        benchmark::DoNotOptimize(std::string_view{a} == std::string_view{b});
+    }
+}
+BENCHMARK(str__std_equal_short);
+
+static void str__zen_equal_short(benchmark::State& state) {
+    std::string a = "service.requests.latency", b = a;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a.data());
+        benchmark::DoNotOptimize(b.data());
+        benchmark::DoNotOptimize(zen::str::equal(a, b));
+    }
+}
+BENCHMARK(str__zen_equal_short);
+
+// A record with short and long fields, split on one and on several delimiters
+static const std::string& str_record() {
+    static const std::string record = [] {
+        std::string r;
+        for (int i = 0; i < 16; ++i) {
+            r += "2024-05-01T12:00:00Z,host-" + std::to_string(i) + ",";
+            r += std::string(size_t(20 + i * 13), 'x') + ";200\t";
+        }
+        return r;
+    }();
+    return record;
+}
+
+static void str__std_split(benchmark::State& state) {
+    const std::string_view r = str_record();
+    for (auto _ : state) {
+        usize total = 0;
+        for (usize start = 0; ; ) {
+            const usize end = r.find_first_of(",;\t", start);
+            total += (end == std::string_view::npos ? r.size() : end) - start;
+            if (end == std::string_view::npos) break;
+            start = end + 1;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+}
+BENCHMARK(str__std_split);
+
+static void str__zen_split(benchmark::State& state) {
+    const std::string_view r = str_record();
+    for (auto _ : state) {
+        usize total = 0;
+        for (std::string_view f: zen::split(r, ",;\t"))
+            total += f.size();
+        benchmark::DoNotOptimize(total);
+    }
+}
+BENCHMARK(str__zen_split);
+
+static void str__std_split_char(benchmark::State& state) {
+    const std::string_view r = str_record();
+    for (auto _ : state) {
+        usize total = 0;
+        for (usize start = 0; ; ) {
+            const usize end = r.find(',', start);
+            total += (end == std::string_view::npos ? r.size() : end) - start;
+            if (end == std::string_view::npos) break;
+            start = end + 1;
+        }
+        benchmark::DoNotOptimize(total);
+    }
+}
+BENCHMARK(str__std_split_char);
+
+static void str__zen_split_char(benchmark::State& state) {
+    const std::string_view r = str_record();
+    for (auto _ : state) {
+        usize total = 0;
+        for (std::string_view f: zen::split(r, ','))
+            total += f.size();
+        benchmark::DoNotOptimize(total);
+    }
+}
+BENCHMARK(str__zen_split_char);
@@ -0,0 +1,39 @@
+#include <benchmark/benchmark.h>
+#include "zen_string_pool.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Metric names looked up by an ingest path
+static std::vector<std::string> metric_names() {
+    std::vector<std::string> names;
+    for (int i = 0; i < 1024; ++i)
+        names.push_back("service.requests." + std::to_string(i) + ".latency");
+    return names;
+}
+
+static void string_pool__unordered_map_find(benchmark::State& state) {
+    const auto names = metric_names();
+    std::unordered_map<std::string, u32> ids;
+    for (const auto& n: names)
+        ids.emplace(n, u32(ids.size()));
+    usize i = 0;
+    for (auto _ : state) {
+        const std::string_view name = names[i++ & 1023];
+        benchmark::DoNotOptimize(ids.find(std::string{name}));
+    }
+}
+BENCHMARK(string_pool__unordered_map_find);
+
+static void string_pool__pool_find(benchmark::State& state) {
+    const auto names = metric_names();
+    zen::string_pool pool;
+    for (const auto& n: names)
+        pool.intern(n);
+    usize i = 0;
+    for (auto _ : state) {
+        const zen::string_view name = names[i++ & 1023];
+        benchmark::DoNotOptimize(pool.find(name));
+    }
+}
+BENCHMARK(string_pool__pool_find);
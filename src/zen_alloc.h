@@ -2,6 +2,7 @@
 #define ZEN_ALLOC_H
 
 #include "zen_config.h"
+#include <cstring>
 #include <memory_resource>
 
 namespace zen {
@@ -18,6 +19,11 @@ using mem_pool_sync = std::pmr::synchronized_pool_resource;
 
 namespace mem {
 
+// Types that can be moved to new memory with memcpy, leaving the old bytes to be dropped without a destructor call
+// Specialize for types with no pointers into themselves, like zen::small_string
+template<typename T>
+static constexpr bool is_trivially_relocatable = std::is_trivially_copyable_v<T>;
+
 // Aligned buffer for container storage
 template<typename T, usize NBytes = sizeof(T), usize Align = alignof(T)>
 struct aligned_buffer {
@@ -84,6 +90,18 @@ ZEN_FORCEINLINE constexpr void destroy_at(T* p) {
         p->~T(); 
 }
 
+// Moves [first, last) to dst for containers that drop the old storage afterwards
+// Trivially relocatable types are copied with memcpy, others are moved one at a time
+template<typename T>
+ZEN_FORCEINLINE void relocate(T* first, T* last, T* dst) {
+    if constexpr(is_trivially_relocatable<T>) {
+        if (first != last)
+            memcpy(VOIDIFY(dst), VOIDIFY(first), usize(last - first) * sizeof(T));
+    } else {
+        move(first, last, dst);
+    }
+}
+
 template<typename T> 
 ZEN_FORCEINLINE constexpr void destroy_n(T* p, usize n) { 
     if constexpr(!std::is_trivially_destructible_v<T>) {
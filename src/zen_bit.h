@@ -94,11 +94,10 @@ template<typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
 ZEN_FORCEINLINE constexpr usize leading_zeros(T value) noexcept {
     #ifdef ZEN_COMPILER_MSVC
         unsigned long n{};
-        if constexpr(sizeof(T) == sizeof(u64)) { if (ZEN_UNLIKELY(!_BitScanForward(&n, value))) { n = 64; } }
-        else                                   { if (ZEN_UNLIKELY(!_BitScanForward64(&n, value))) { n = 32; } }
-        return usize(n);
+        if constexpr(sizeof(T) == sizeof(u64)) { if (ZEN_UNLIKELY(!_BitScanReverse64(&n, value))) { return 64; } return usize(63 - n); }
+        else                                   { if (ZEN_UNLIKELY(!_BitScanReverse(&n, value))) { return 32; } return usize(31 - n); }
     #else
-        if constexpr(sizeof(T) == sizeof(u64)) { return __builtin_clzl(value); }
+        if constexpr(sizeof(T) == sizeof(u64)) { return __builtin_clzll(value); }
         else                                   { return __builtin_clz(value); }
     #endif
 }
@@ -108,12 +107,12 @@ template<typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
 ZEN_FORCEINLINE constexpr usize trailing_zeros(T value) noexcept {
     #ifdef ZEN_COMPILER_MSVC
         unsigned long n{};
-        if constexpr(sizeof(T) == sizeof(u64)) { if (ZEN_UNLIKELY(!_BitScanReverse(&n, value))) { n = 0; } n = 64 - n; }
-        else                                   { if (ZEN_UNLIKELY(!_BitScanReverse64(&n, value))) { n = 0; } n = 32 - n; }
+        if constexpr(sizeof(T) == sizeof(u64)) { if (ZEN_UNLIKELY(!_BitScanForward64(&n, value))) { return 64; } }
+        else                                   { if (ZEN_UNLIKELY(!_BitScanForward(&n, value))) { return 32; } }
         return usize(n);
     #else
-        if constexpr(sizeof(T) == sizeof(u64)) { return __builtin_ctzl(x); }
-        else                                   { return __builtin_ctz(x); }
+        if constexpr(sizeof(T) == sizeof(u64)) { return __builtin_ctzll(value); }
+        else                                   { return __builtin_ctz(value); }
     #endif
 }
 
@@ -121,10 +120,10 @@ ZEN_FORCEINLINE constexpr usize trailing_zeros(T value) noexcept {
 template<typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
 ZEN_FORCEINLINE constexpr usize bit_count(T value) noexcept {
     #ifdef ZEN_COMPILER_MSVC
-        if constexpr(sizeof(T) == sizeof(u64)) { return __popcnt(value); }
-        else                                   { return __popcnt64(value); }
+        if constexpr(sizeof(T) == sizeof(u64)) { return __popcnt64(value); }
+        else                                   { return __popcnt(value); }
     #else
-        if constexpr(sizeof(T) == sizeof(u64)) { return __builtin_popcountl(value); }
+        if constexpr(sizeof(T) == sizeof(u64)) { return __builtin_popcountll(value); }
         else                                   { return __builtin_popcount(value); }
     #endif
 }
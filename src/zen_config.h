@@ -2,6 +2,7 @@
 #define ZEN_CONFIG_H
 
 // Only lightweight standard library includes
+#include <cstddef>
 #include <cstdint>
 #include <type_traits>
 
@@ -19,6 +20,13 @@ using f32       = float;
 using f64       = double;
 using usize     = size_t;
 
+// 128-bit integers where the compiler provides them
+#if defined(__SIZEOF_INT128__)
+    #define ZEN_INT128
+    __extension__ typedef __int128          i128;
+    __extension__ typedef unsigned __int128 u128;
+#endif
+
 
 // World's smallest pair
 template<typename T1, typename T2 = T1> struct pair { T1 first; T2 second; };
@@ -60,27 +68,47 @@ template<typename T1, typename T2 = T1> pair(const T1&, const T2&) -> pair<T1, T
 #endif
 
 
-// Likely/unlikely/inline/noreturn
+// Likely/unlikely/inline/noreturn/cold
 #if defined(ZEN_COMPILER_CLANG) || defined(ZEN_COMPILER_GCC)
     #define ZEN_LIKELY(x)           __builtin_expect(!!(x), 1)
     #define ZEN_UNLIKELY(x)         __builtin_expect(!!(x), 0)
     #define ZEN_FORCEINLINE         inline __attribute__((always_inline))
-    #define ZEN_NEVERINLINE         inline __attribute__((never_inline))
+    #define ZEN_NEVERINLINE         inline __attribute__((noinline))
     #define ZEN_NORETURN            [[noreturn]]
+    #define ZEN_COLD                __attribute__((cold))
 
 #elif defined(ZEN_COMPILER_MSVC)
     #define ZEN_LIKELY(x)           x
     #define ZEN_UNLIKELY(x)         x
     #define ZEN_FORCEINLINE         __forceinline
-    #define ZEN_NEVERINLINE         __declspec(noinline)
+    #define ZEN_NEVERINLINE         inline __declspec(noinline)
     #define ZEN_NORETURN            __declspec(noreturn)
+    #define ZEN_COLD
 
 #else
     #define LIKELY(x)               x
     #define UNLIKELY(x)             x
     #define ZEN_FORCEINLINE         inline
-    #define ZEN_NEVERINLINE
+    #define ZEN_NEVERINLINE         inline
     #define ZEN_NORETURN            [[noreturn]]
+    #define ZEN_COLD
+#endif
+
+
+// SIMD instruction sets enabled for the target
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define ZEN_SSE2
+#endif
+#if defined(__AVX2__)
+    #define ZEN_AVX2
+#endif
+
+
+// Lets constexpr functions take faster non-constexpr paths at runtime
+#if defined(ZEN_COMPILER_CLANG) || defined(ZEN_COMPILER_GCC) || defined(ZEN_COMPILER_MSVC)
+    #define ZEN_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+    #define ZEN_CONSTANT_EVALUATED() false
 #endif
 
 
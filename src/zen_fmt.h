@@ -2,7 +2,34 @@
 #define ZEN_FMT_H
 
 #include "zen_string.h"
+#include "zen_alloc.h"
+#include "zen_bit.h"
+#include "zen_span.h"
+#include "zen_unicode.h"
+#include "zen_fmt_float.h"
 #include <cstdio>
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
+#include <mutex>
+#include <thread>
+
+#ifdef ZEN_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef ZEN_AVX2
+#include <immintrin.h>
+#endif
+
+// Raw file descriptor output for zen::fmt::fd_writer
+#ifdef ZEN_PLATFORM_WINDOWS
+    #include <io.h>
+    extern "C" unsigned long long GetTickCount64();
+#else
+    #include <cerrno>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
 
 // Debugger trigger for zen::fmt::impl::assert_fail
 #ifdef ZEN_COMPILER_MSVC
@@ -21,10 +48,16 @@
 #define todo(name)          assertf(false, "TODO: implement " name)
 
 // Formatted assert with fmt library
-#ifdef ZEN_DEBUG
-#define assertf(expr, ...)  (static_cast <bool>(expr) \
+// A failing check only passes its site and arguments to a cold handler, the message is never formatted inline
+// ZEN_CHECKS keeps the checks in release builds, a failure reports the site and expression but not the message
+#if defined(ZEN_DEBUG)
+#define assertf(expr, ...)  (ZEN_LIKELY(static_cast <bool>(expr)) \
+    ? void (0) \
+    : zen::fmt::impl::assert_fail({__FILE__, __FUNCTION__, #expr, __LINE__}, __VA_ARGS__ ))
+#elif defined(ZEN_CHECKS)
+#define assertf(expr, ...)  (ZEN_LIKELY(static_cast <bool>(expr)) \
     ? void (0) \
-    : zen::fmt::impl::assert_fail(__FILE__, __FUNCTION__, __LINE__, #expr, __VA_ARGS__ ))
+    : zen::fmt::impl::check_fail({__FILE__, __FUNCTION__, #expr, __LINE__}))
 #else
 #define assertf(...)
 #endif
@@ -40,25 +73,130 @@ namespace fmt {
 
 static constexpr usize DEFAULT_SIZE = 512;
 
-template<usize N = DEFAULT_SIZE> 
+// Fixed capacity, overflow asserts in debug builds or truncates when Truncate is set
+template<usize N = DEFAULT_SIZE, bool Truncate = false> 
 struct buffer;
+
+template<usize N = DEFAULT_SIZE>
+using truncating_buffer = buffer<N, true>;
+
+// N chars of inline storage, then grows geometrically through an allocator
+template<usize N = DEFAULT_SIZE>
+struct dynamic_buffer;
+
+// Output operators for any type implementing the sink protocol
+template<typename Sink>
+struct sink_ops;
+
+// Sink that only counts the chars written to it, see formatted_size
+struct counting_sink;
+
+// Keeps long strings by reference and copies the rest, the output is a list of chunks for writev
+template<usize N = DEFAULT_SIZE>
+struct gather_sink;
+
+// Type-erased reference to a sink and a formatting argument, what vformat works with
+struct sink_ref;
+struct arg;
+
+namespace impl { struct part; }
+
+// Format string parsed at compile time, mismatched arguments and bad specs fail to compile
+template<typename... Args>
+struct basic_format_string;
+
+template<typename... Args>
+using format_string = basic_format_string<std::type_identity_t<Args>...>;
+
+// Format string parsed at runtime, for formats that are not known at compile time
+struct runtime_format_string { string_view str{}; };
+
+constexpr runtime_format_string runtime(string_view fmt) noexcept { return {fmt}; }
+
+// String literal as a template argument
+template<usize N>
+struct fixed_string {
+    char chars[N]{};
+
+    consteval fixed_string(const char (&s)[N]) noexcept { for (usize i = 0; i < N; ++i) chars[i] = s[i]; }
+    ZEN_ND constexpr string_view view() const noexcept { return {chars, N - 1}; }
+};
+
+// Argument a format string can refer to as {name}, see fmt::named
+template<fixed_string Name, typename T>
+struct named_arg {
+    static constexpr auto name = Name;
+    T value;
+};
+
+// zen::format(out, "{id}: {value:>{width}}", fmt::named<"id">(1), fmt::named<"value">(v), fmt::named<"width">(8))
+template<fixed_string Name, typename T>
+constexpr named_arg<Name, const T&> named(const T& value) noexcept;
+
+// Argument of fmt::static_format, an integer, char, bool or string literal
+template<typename T>
+struct static_arg {
+    T value;
+
+    template<typename U>
+    consteval static_arg(const U& v) noexcept : value(v) {}
+};
+
+template<typename T> static_arg(T) -> static_arg<T>;
+template<usize N> static_arg(const char (&)[N]) -> static_arg<fixed_string<N>>;
+
+// Formats at compile time into an sstring of exactly the formatted length
+// constexpr auto key = fmt::static_format<"metric.{}.{:>4}", "cpu", 3>();   // sstring<15>
+template<fixed_string Fmt, static_arg... Args>
+consteval auto static_format() noexcept;
+
+// Exact number of chars zen::format writes for these arguments, without writing any integer digits
+template<typename... Args>
+usize formatted_size(format_string<Args...> fmt, Args&&... args) noexcept;
+
+// The formatting engine behind zen::format, compiled once for every sink and argument list
+// parts are the parsed fields of fmt, see basic_format_string, and args come from make_args
+void vformat(sink_ref out, string_view fmt, const impl::part* parts, span<const arg> args) noexcept;
+
+// Parses fmt at runtime, at most MAX_RUNTIME_ARGS arguments
+void vformat(sink_ref out, runtime_format_string fmt, span<const arg> args) noexcept;
+
 }
 
 template<typename Out, typename... Args>
-Out& format(Out& out, string_view fmt, Args&&... args) noexcept;
+Out& format(Out& out, fmt::format_string<Args...> fmt, Args&&... args) noexcept;
+
+
+template<typename Out, typename... Args>
+Out& format(Out& out, fmt::runtime_format_string fmt, Args&&... args) noexcept;
 
 
+// Output goes through this thread's fmt::fd_writer, see there for when it is flushed
+// BufferSize no longer does anything, the writer formats straight into its own buffer
 template<usize BufferSize=fmt::DEFAULT_SIZE, typename... Args>
-void print(string_view fmt, Args&&... args) noexcept;
+void print(fmt::format_string<Args...> fmt, Args&&... args) noexcept;
 
 
 template<usize BufferSize=fmt::DEFAULT_SIZE, typename... Args>
-void println(string_view fmt, Args&&... args) noexcept;
+void println(fmt::format_string<Args...> fmt, Args&&... args) noexcept;
 
 
+// Never inlined, callers only pass the arguments, BufferSize no longer does anything
 template<usize BufferSize=fmt::DEFAULT_SIZE, typename... Args>
-ZEN_NORETURN
-void panic(string_view fmt, Args&&... args) noexcept;
+ZEN_NORETURN ZEN_COLD
+void panic(fmt::format_string<Args...> fmt, Args&&... args) noexcept;
+
+
+// Writes out the messages every fmt::fd_writer buffered, print/println included
+void flush() noexcept;
+
+
+// Generic output operators for containers, declared up front so the formatters find them for any sink
+template<typename Out, typename T0, typename T1>
+Out& operator<<(Out& o, const pair<T0, T1>& v) noexcept;
+
+template<typename Out, typename T, typename = std::void_t<decltype(std::declval<T>().begin() == std::declval<T>().end())>>
+Out& operator<<(Out& o, const T& v) noexcept;
 
 
 // Buffer / fmt fwd
@@ -70,156 +208,905 @@ template<typename T> struct hexu      { T value{}; };
 template<typename T> struct octal     { T value{}; };
 template<typename T> struct precisev  { T value{}; u8 precision{}; };
 
+// hexdump -C style lines, offset is printed for the first byte
+struct hexdump { span<const u8> bytes{}; u64 offset{}; };
+
+// Quoted string with quotes, backslashes, control chars and invalid UTF-8 escaped, what the {?:} style writes
+struct escaped { string_view str{}; };
+
+// Digits after the seconds of a timestamp
+enum class time_precision : u8 { seconds, milliseconds, microseconds, nanoseconds };
+
+// UTC wall clock time as RFC 3339, 2026-10-16T20:40:43.123Z
+// The date and time up to the seconds are cached per thread, within the same second only the fraction is written
+struct timestamp {
+    i64            ns{};    // Since the Unix epoch
+    time_precision precision{time_precision::milliseconds};
+
+    static timestamp now(time_precision precision = time_precision::milliseconds) noexcept;
+};
+
 
 template<typename Type>
 ZEN_ND constexpr string_view type_name() noexcept;
 
 
+// Result of parsing a number, like std::from_chars_result
+enum class parse_error : u8 { none, invalid, overflow };
+
+struct parse_result {
+    const char* ptr{};
+    parse_error error{};
+
+    constexpr explicit operator bool() const noexcept { return error == parse_error::none; }
+};
+
+
 template<usize Base = 10, typename T>
-constexpr bool chars_to_int(const char* begin, const char* end, T& value, num::index_t<Base> = {}) noexcept;
+constexpr parse_result chars_to_int(const char* begin, const char* end, T& value, num::index_t<Base> = {}) noexcept;
+
+
+// Correctly rounded [-+](digits[.digits]|.digits)[(e|E)[-+]digits], inf, infinity or nan
+template<typename T>
+parse_result chars_to_float(const char* begin, const char* end, T& value) noexcept;
 
 
 template<usize Base = 10, typename T>
-char* int_to_chars(char* begin, char* end, const T& value, num::index_t<Base> = {}) noexcept;
+constexpr char* int_to_chars(char* begin, char* end, const T& value, num::index_t<Base> = {}) noexcept;
 
 
 template<typename T>
 char* float_to_chars(char* begin, char* end, const T& value, usize precision = 0) noexcept;
 
+
+// Two hex chars per byte, out must have room for 2 * bytes.size() chars
+char* hex_encode(char* out, span<const u8> bytes, bool upper = false) noexcept;
+
+
+// Eight '0'/'1' chars per byte, most significant bit first, out must have room for 8 * bytes.size() chars
+char* binary_encode(char* out, span<const u8> bytes) noexcept;
+
 namespace impl {
     
 static constexpr char STYLE_NONE = 'i';
+static constexpr char STYLE_DEBUG = '?';
 static constexpr usize HEX_UPPER = 0b100000000;
 
 }
 
+namespace impl {
+
+// Most chars a single conversion can write, a signed binary integer or a float with the largest precision
+template<typename T, usize Base = 10>
+constexpr usize int_max_len() noexcept {
+    constexpr usize bits = sizeof(T) * 8, base = Base & 0xff;
+    return std::is_signed_v<T> + (base == 10 ? (bits * 1233 >> 12) + 1 : base == 16 ? bits / 4 : base == 8 ? (bits + 2) / 3 : bits);
+}
+
+static constexpr usize MAX_CONVERSION_LEN = fixed_max_len(255);
+
+// Scratch space for conversions that might not fit in a fixed buffer
+inline char* conversion_scratch() noexcept {
+    static thread_local char scratch[MAX_CONVERSION_LEN];
+    return scratch;
+}
+
+// Number of digits of the magnitude v in Base, with digit count math instead of a conversion
+static constexpr u64 POW10_U64[20]{
+    UINT64_C(1), UINT64_C(10), UINT64_C(100), UINT64_C(1000), UINT64_C(10000), UINT64_C(100000), UINT64_C(1000000), 
+    UINT64_C(10000000), UINT64_C(100000000), UINT64_C(1000000000), UINT64_C(10000000000), UINT64_C(100000000000), 
+    UINT64_C(1000000000000), UINT64_C(10000000000000), UINT64_C(100000000000000), UINT64_C(1000000000000000), 
+    UINT64_C(10000000000000000), UINT64_C(100000000000000000), UINT64_C(1000000000000000000), UINT64_C(10000000000000000000)};
+
+template<usize Base, typename U>
+constexpr usize count_digits(U v) noexcept {
+    constexpr usize base = Base & 0xff;
+    if constexpr(base != 10 && !po2::check(base)) {
+        usize d = 1;
+        for (; v >= base; v /= base) ++d;
+        return d;
+    }
+    usize n{};
+    if constexpr(sizeof(U) > sizeof(u64)) {
+        // Peel 19 digits or 60 bits at a time until the rest fits u64
+        constexpr U chunk = base == 10 ? U(POW10_U64[19]) : U(1) << 60;
+        constexpr usize chunk_digits = base == 10 ? 19 : 60 / ilog2(base);
+        for (; v >= chunk; v /= chunk) n += chunk_digits;
+    }
+    const u64 x = u64(v);
+    if constexpr(base == 10) {
+        // bit width * log10(2) is the digit count or one more than it
+        const usize t = ((64 - leading_zeros(x | 1)) * 1233) >> 12;
+        return n + t + 1 - ((x | 1) < POW10_U64[t]);
+    } 
+    else {
+        constexpr usize shift = ilog2(base);
+        return n + (64 - leading_zeros(x | 1) + shift - 1) / shift;
+    }
+}
+
+// Length of int_to_chars<Base>(v)
+template<usize Base, typename T>
+constexpr usize int_len(T v) noexcept {
+    using U = std::make_unsigned_t<T>;
+    if constexpr(std::is_signed_v<T>) {
+        if (v < 0) return 1 + count_digits<Base>(U(U(0) - U(v)));
+    }
+    return count_digits<Base>(U(v));
+}
+
+// True for types implementing the sink protocol
+template<typename Out, typename = void>
+static constexpr bool is_sink = false;
+
+template<typename Out>
+static constexpr bool is_sink<Out, std::void_t<
+    decltype(std::declval<Out&>().append_n(' ', usize{})),
+    decltype(std::declval<Out&>().commit(usize{})),
+    decltype(std::declval<char*&>() = std::declval<Out&>().reserve(usize{})),
+    decltype(std::declval<char*&>() = std::declval<Out&>().data()),
+    decltype(usize(std::declval<Out&>().size()))>> = true;
+
+template<typename Out>
+static constexpr bool is_gather_sink = false;
+
 template<usize N>
-struct buffer : sstring<N> {
-    using sstring<N>::append;
-    using sstring<N>::set_size;
-    using sstring<N>::begin;
-    using sstring<N>::end;
-    using sstring<N>::max_size;
-    using size_type = typename sstring<N>::size_type;
+static constexpr bool is_gather_sink<gather_sink<N>> = true;
 
-    buffer() = default;
+}
 
-    buffer& operator<<(char c)                 noexcept { append(c); return *this; }
-    buffer& operator<<(const char* data)       noexcept { append(data, strlen(data)); return *this; }
-    buffer& operator<<(string_view s)          noexcept { append(s.data(), s.size()); return *this; }
+// Sink protocol, what the formatters need from an output to write straight into it
+//  * append(char), append(const char*, usize) and append_n(char c, usize n) for n copies of c
+//  * reserve(n) -> char* to n writable chars, commit(n) keeps the first n of them
+//  * data() and size() of what was written, so padding can be inserted in front of a value
+// Deriving from sink_ops<Sink> adds the operator<< set that zen::format uses
+template<typename Derived>
+struct sink_ops {
+    Derived& operator<<(char c)                 noexcept { self().append(c); return self(); }
+    Derived& operator<<(const char* data)       noexcept { self().append(data, strlen(data)); return self(); }
+    Derived& operator<<(string_view s)          noexcept { self().append(s.data(), s.size()); return self(); }
 
     template<usize M>
-    buffer& operator<<(const char (&data)[M])  noexcept { append(data, M - 1); return *this; }
+    Derived& operator<<(const char (&data)[M])  noexcept { self().append(data, M - 1); return self(); }
     
     template<typename U, typename = std::enable_if_t<std::is_same_v<const char*, decltype( std::declval<const U&>().data() + std::declval<U>().size() )>>>
-    buffer& operator<<(U&& str_like)           noexcept { append(str_like.data(), str_like.size()); return *this; }
+    Derived& operator<<(U&& str_like)           noexcept { self().append(str_like.data(), str_like.size()); return self(); }
     
-    buffer& operator<<(bool v)                 noexcept { append(v ? "true" : "false", 5 - v); return *this; }
-    buffer& operator<<(u8 v)                   noexcept { set_size(size_type(int_to_chars(end(), begin() + max_size(), u16(v)) - begin())); return *this; }
-    buffer& operator<<(u16 v)                  noexcept { set_size(size_type(int_to_chars(end(), begin() + max_size(), v) - begin())); return *this; }
-    buffer& operator<<(u32 v)                  noexcept { set_size(size_type(int_to_chars(end(), begin() + max_size(), v) - begin())); return *this; }
-    buffer& operator<<(u64 v)                  noexcept { set_size(size_type(int_to_chars(end(), begin() + max_size(), v) - begin())); return *this; }
-    buffer& operator<<(i8 v)                   noexcept { set_size(size_type(int_to_chars(end(), begin() + max_size(), i16(v)) - begin())); return *this; }
-    buffer& operator<<(i16 v)                  noexcept { set_size(size_type(int_to_chars(end(), begin() + max_size(), v) - begin())); return *this; }
-    buffer& operator<<(i32 v)                  noexcept { set_size(size_type(int_to_chars(end(), begin() + max_size(), v) - begin())); return *this; }
-    buffer& operator<<(i64 v)                  noexcept { set_size(size_type(int_to_chars(end(), begin() + max_size(), v) - begin())); return *this; }
-    buffer& operator<<(f32 v)                  noexcept { set_size(size_type(float_to_chars(end(), begin() + max_size(), v) - begin())); return *this; }
-    buffer& operator<<(f64 v)                  noexcept { set_size(size_type(float_to_chars(end(), begin() + max_size(), v) - begin())); return *this; }
-    buffer& operator<<(const void* v)          noexcept { append("0x", 2); set_size(size_type(int_to_chars<16>(end(), begin() + max_size(), u64(reinterpret_cast<uintptr_t>(v))) - begin())); return *this; }
+    Derived& operator<<(bool v)                 noexcept { self().append(v ? "true" : "false", 5 - v); return self(); }
+    Derived& operator<<(u8 v)                   noexcept { return integer<10>(u16(v)); }
+    Derived& operator<<(u16 v)                  noexcept { return integer<10>(v); }
+    Derived& operator<<(u32 v)                  noexcept { return integer<10>(v); }
+    Derived& operator<<(u64 v)                  noexcept { return integer<10>(v); }
+    Derived& operator<<(i8 v)                   noexcept { return integer<10>(i16(v)); }
+    Derived& operator<<(i16 v)                  noexcept { return integer<10>(v); }
+    Derived& operator<<(i32 v)                  noexcept { return integer<10>(v); }
+    Derived& operator<<(i64 v)                  noexcept { return integer<10>(v); }
+#ifdef ZEN_INT128
+    Derived& operator<<(u128 v)                 noexcept { return integer<10>(v); }
+    Derived& operator<<(i128 v)                 noexcept { return integer<10>(v); }
+#endif
+    Derived& operator<<(f32 v)                  noexcept { return floating(v, 0); }
+    Derived& operator<<(f64 v)                  noexcept { return floating(v, 0); }
+    Derived& operator<<(const void* v)          noexcept { self().append("0x", 2); return integer<16>(u64(reinterpret_cast<uintptr_t>(v))); }
 
     template<typename T>
-    buffer& operator<<(const binary<T>& v)     noexcept { set_size(size_type(int_to_chars<2>(end(), begin() + max_size(), v.value) - begin())); return *this; }
+    Derived& operator<<(const binary<T>& v)     noexcept { return integer<2>(v.value); }
 
     template<typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
-    buffer& operator<<(const hex<T>& v)        noexcept { set_size(size_type(int_to_chars<16>(end(), begin() + max_size(), v.value) - begin())); return *this; }
+    Derived& operator<<(const hex<T>& v)        noexcept { return integer<16>(v.value); }
 
     template<typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
-    buffer& operator<<(const hexu<T>& v)       noexcept { set_size(size_type(int_to_chars<16 | impl::HEX_UPPER>(end(), begin() + max_size(), v.value) - begin())); return *this; }
+    Derived& operator<<(const hexu<T>& v)       noexcept { return integer<16 | impl::HEX_UPPER>(v.value); }
     
     template<typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
-    buffer& operator<<(const octal<T>& v)      noexcept { set_size(size_type(int_to_chars<8>(end(), begin() + max_size(), v.value) - begin())); return *this; }
+    Derived& operator<<(const octal<T>& v)      noexcept { return integer<8>(v.value); }
 
     template<typename T, typename = std::enable_if_t<std::is_floating_point_v<T>>>
-    buffer& operator<<(const precisev<T>& v)   noexcept { set_size(size_type(float_to_chars(end(), begin() + max_size(), v.value, usize(v.precision)) - begin())); return *this; }
+    Derived& operator<<(const precisev<T>& v)   noexcept { return floating(v.value, usize(v.precision)); }
+
+    template<typename B, typename = std::enable_if_t<std::is_same_v<std::remove_const_t<B>, u8>>>
+    Derived& operator<<(const hex<span<B>>& v)  noexcept { return encoded<2>(v.value, [](char* o, span<const u8> b) { return hex_encode(o, b); }); }
+
+    template<typename B, typename = std::enable_if_t<std::is_same_v<std::remove_const_t<B>, u8>>>
+    Derived& operator<<(const hexu<span<B>>& v) noexcept { return encoded<2>(v.value, [](char* o, span<const u8> b) { return hex_encode(o, b, true); }); }
+
+    template<typename B, typename = std::enable_if_t<std::is_same_v<std::remove_const_t<B>, u8>>>
+    Derived& operator<<(const binary<span<B>>& v) noexcept { return encoded<8>(v.value, [](char* o, span<const u8> b) { return binary_encode(o, b); }); }
+
+    Derived& operator<<(const hexdump& v)       noexcept;
+    Derived& operator<<(const escaped& v)       noexcept;
+    Derived& operator<<(const timestamp& v)     noexcept;
+
+private:
+    ZEN_FORCEINLINE Derived& self() noexcept { return static_cast<Derived&>(*this); }
+
+    template<usize Base, typename T>
+    ZEN_FORCEINLINE Derived& integer(T v) noexcept {
+        if constexpr(std::is_same_v<Derived, counting_sink>) {
+            self().commit(impl::int_len<Base>(v));
+            return self();
+        } else if constexpr(std::is_same_v<Derived, sink_ref>) {
+            if (self().counting()) {
+                self().commit(impl::int_len<Base>(v));
+                return self();
+            }
+        }
+        constexpr usize n = impl::int_max_len<T, Base>();
+        char* p = self().reserve(n);
+        self().commit(usize(int_to_chars<Base>(p, p + n, v) - p));
+        return self();
+    }
+
+    // Encodes in chunks so each reservation stays within the conversion scratch size
+    template<usize CharsPerByte, typename F>
+    Derived& encoded(span<const u8> bytes, F&& encode) noexcept {
+        constexpr usize CHUNK = 256 / CharsPerByte;
+        for (usize i = 0; i < bytes.size(); i += CHUNK) {
+            const usize n = bytes.size() - i < CHUNK ? bytes.size() - i : CHUNK;
+            char* p = self().reserve(n * CharsPerByte);
+            self().commit(usize(encode(p, span<const u8>{bytes.data() + i, n}) - p));
+        }
+        return self();
+    }
+
+    template<typename T>
+    ZEN_FORCEINLINE Derived& floating(T v, usize precision) noexcept {
+        const usize n = precision == 0 ? impl::float_traits<T>::MAX_LEN : impl::fixed_len_bound(v, precision);
+        char* p = self().reserve(n);
+        self().commit(usize(float_to_chars(p, p + n, v, precision) - p));
+        return self();
+    }
+};
+
+template<usize N, bool Truncate>
+struct buffer : sink_ops<buffer<N, Truncate>> {
+    using sink_ops<buffer>::operator<<;
+    using size_type = num::with::max_value<N>;
+    using value_type = char;
+
+    buffer() = default;
+
+    operator string_view() const noexcept { return string_view{m_data, m_size}; }
+    string_view     view() const noexcept { return string_view{m_data, m_size}; }
+
+    static constexpr size_type      max_size()            noexcept { return N; }
+    static constexpr size_type      capacity()            noexcept { return N; }
+    ZEN_ND bool                     empty()         const noexcept { return m_size == 0; }
+    ZEN_ND bool                     truncated()     const noexcept { return m_truncated; }
+    ZEN_ND size_type                size()          const noexcept { return m_size; }
+    ZEN_ND char*                    data()                noexcept { return m_data; }
+    ZEN_ND const char*              data()          const noexcept { return m_data; }
+    ZEN_ND char*                    begin()               noexcept { return m_data; }
+    ZEN_ND const char*              begin()         const noexcept { return m_data; }
+    ZEN_ND char*                    end()                 noexcept { return m_data + m_size; }
+    ZEN_ND const char*              end()           const noexcept { return m_data + m_size; }
+
+    void clear() noexcept { m_size = 0; m_truncated = false; }
+
+    void append(char c) noexcept { 
+        if (ZEN_LIKELY(m_size < N)) m_data[m_size++] = c; 
+        else overflow(1);
+    }
+
+    void append(const char* s, usize n) noexcept { 
+        const usize room = N - m_size;
+        if (ZEN_UNLIKELY(n > room)) { overflow(n - room); n = room; }
+        memcpy(end(), s, n); 
+        m_size += size_type(n); 
+    }
+
+    void append_n(char c, usize n) noexcept { 
+        const usize room = N - m_size;
+        if (ZEN_UNLIKELY(n > room)) { overflow(n - room); n = room; }
+        memset(end(), c, n); 
+        m_size += size_type(n); 
+    }
+
+    // Conversions that might not fit are written to scratch space and cut down on commit
+    char* reserve(usize n) noexcept {
+        if (ZEN_LIKELY(n <= N - m_size)) return end();
+        return reserve_scratch(n);
+    }
+
+    void commit(usize n) noexcept {
+        if (ZEN_LIKELY(!m_scratch)) { m_size += size_type(n); return; }
+        m_scratch = false;
+        append(impl::conversion_scratch(), n);
+    }
+
+private:
+    char* reserve_scratch(usize n) noexcept;
+    void overflow(usize dropped) noexcept;
+
+    char      m_data[N];
+    size_type m_size{};
+    bool      m_truncated{};
+    bool      m_scratch{};
+};
+
+template<usize N>
+struct dynamic_buffer : sink_ops<dynamic_buffer<N>> {
+    static_assert(N > 0, "dynamic_buffer needs some inline storage");
+    using sink_ops<dynamic_buffer>::operator<<;
+    using size_type = usize;
+    using value_type = char;
+
+    explicit dynamic_buffer(alloc_t<> alloc = std::pmr::get_default_resource()) noexcept : alloc{alloc} {}
+
+    dynamic_buffer(const dynamic_buffer&) = delete;
+    dynamic_buffer& operator=(const dynamic_buffer&) = delete;
+
+    dynamic_buffer(dynamic_buffer&& other) noexcept : alloc{other.alloc} { take(other); }
+
+    dynamic_buffer& operator=(dynamic_buffer&& other) noexcept {
+        if (this == &other) return *this;
+        if (alloc == other.alloc) {
+            reset();
+            take(other);
+        } else {
+            clear();
+            append(other.data(), other.size());
+            other.clear();
+        }
+        return *this;
+    }
+
+    ~dynamic_buffer() noexcept { reset(); }
+
+    operator string_view() const noexcept { return string_view{m_data, m_size}; }
+    string_view     view() const noexcept { return string_view{m_data, m_size}; }
+
+    ZEN_ND bool                     small()         const noexcept { return m_data == m_buf; }
+    ZEN_ND usize                    capacity()      const noexcept { return m_cap; }
+    ZEN_ND bool                     empty()         const noexcept { return m_size == 0; }
+    ZEN_ND usize                    size()          const noexcept { return m_size; }
+    ZEN_ND char*                    data()                noexcept { return m_data; }
+    ZEN_ND const char*              data()          const noexcept { return m_data; }
+    ZEN_ND char*                    begin()               noexcept { return m_data; }
+    ZEN_ND const char*              begin()         const noexcept { return m_data; }
+    ZEN_ND char*                    end()                 noexcept { return m_data + m_size; }
+    ZEN_ND const char*              end()           const noexcept { return m_data + m_size; }
+
+    void clear() noexcept { m_size = 0; }
+
+    void append(char c) noexcept { 
+        if (ZEN_UNLIKELY(m_size == m_cap)) grow(1);
+        m_data[m_size++] = c; 
+    }
+
+    void append(const char* s, usize n) noexcept { 
+        if (ZEN_UNLIKELY(n > m_cap - m_size)) grow(n);
+        memcpy(end(), s, n); 
+        m_size += n; 
+    }
+
+    void append_n(char c, usize n) noexcept { 
+        if (ZEN_UNLIKELY(n > m_cap - m_size)) grow(n);
+        memset(end(), c, n); 
+        m_size += n; 
+    }
+
+    char* reserve(usize n) noexcept {
+        if (ZEN_UNLIKELY(n > m_cap - m_size)) grow(n);
+        return end();
+    }
+
+    void commit(usize n) noexcept { m_size += n; }
+
+private:
+    void grow(usize n) noexcept {
+        usize new_cap = m_cap << 1;
+        while (new_cap < m_size + n) 
+            new_cap <<= 1;
+        char* mem = static_cast<char*>(static_cast<void*>(alloc.allocate(new_cap)));
+        memcpy(mem, m_data, m_size);
+        if (!small()) 
+            alloc.deallocate(reinterpret_cast<u8*>(m_data), m_cap);
+        m_data = mem;
+        m_cap = new_cap;
+    }
+
+    void reset() noexcept {
+        if (!small()) 
+            alloc.deallocate(reinterpret_cast<u8*>(m_data), m_cap);
+        m_data = m_buf;
+        m_size = 0;
+        m_cap = N;
+    }
+
+    void take(dynamic_buffer& other) noexcept {
+        if (other.small()) {
+            memcpy(m_buf, other.m_buf, other.m_size);
+        } else {
+            m_data = other.m_data;
+            m_cap = other.m_cap;
+            other.m_data = other.m_buf;
+            other.m_cap = N;
+        }
+        m_size = other.m_size;
+        other.m_size = 0;
+    }
+
+    char*     m_data{m_buf};
+    usize     m_size{};
+    usize     m_cap{N};
+    alloc_t<> alloc{};
+    char      m_buf[N];
 };
 
 }
 
-// Format impl
+// Counting sink
+namespace fmt {
+
+// Counts what would be written, integers only count their digits and floats format into scratch space
+// data() is null, nothing that was written can be read back
+struct counting_sink : sink_ops<counting_sink> {
+    using sink_ops<counting_sink>::operator<<;
+    using size_type = usize;
+    using value_type = char;
+
+    ZEN_ND usize size()     const noexcept { return m_size; }
+    ZEN_ND char* data()           noexcept { return nullptr; }
+    
+    void  clear()                         noexcept { m_size = 0; }
+    void  append(char)                    noexcept { ++m_size; }
+    void  append(const char*, usize n)    noexcept { m_size += n; }
+    void  append_n(char, usize n)         noexcept { m_size += n; }
+    char* reserve(usize)                  noexcept { return impl::conversion_scratch(); }
+    void  commit(usize n)                 noexcept { m_size += n; }
+
+private:
+    usize m_size{};
+};
+
+}
+
+// Type-erased sink
+namespace fmt {
+
+// Reference to any sink, so the formatting engine is compiled once instead of once per sink type
+// Every call goes through a static table of functions for the referenced type
+struct sink_ref : sink_ops<sink_ref> {
+    using sink_ops<sink_ref>::operator<<;
+    using size_type = usize;
+    using value_type = char;
+
+    template<typename Sink, typename = std::enable_if_t<impl::is_sink<Sink> && !std::is_same_v<Sink, sink_ref>>>
+    sink_ref(Sink& sink) noexcept : m_sink{&sink}, m_ops{&OPS<Sink>} {}
+
+    ZEN_ND usize size()     const noexcept { return m_ops->size(m_sink); }
+    ZEN_ND char* data()           noexcept { return m_ops->data(m_sink); }
+    ZEN_ND bool  counting() const noexcept { return m_ops->counting; }
+    ZEN_ND bool  references() const noexcept { return m_ops->references; }
+
+    void  append(char c)                  noexcept { m_ops->append_n(m_sink, c, 1); }
+    void  append(const char* s, usize n)  noexcept { m_ops->append(m_sink, s, n); }
+    void  append_n(char c, usize n)       noexcept { m_ops->append_n(m_sink, c, n); }
+    char* reserve(usize n)                noexcept { return m_ops->reserve(m_sink, n); }
+    void  commit(usize n)                 noexcept { m_ops->commit(m_sink, n); }
+
+private:
+    struct ops {
+        void  (*append)(void*, const char*, usize) noexcept;
+        void  (*append_n)(void*, char, usize) noexcept;
+        char* (*reserve)(void*, usize) noexcept;
+        void  (*commit)(void*, usize) noexcept;
+        char* (*data)(void*) noexcept;
+        usize (*size)(void*) noexcept;
+        bool  counting;     // Integers only need their length, see counting_sink
+        bool  references;   // Long strings are kept by reference and not in data(), see gather_sink
+    };
+
+    template<typename Sink>
+    static constexpr ops OPS{
+        [](void* s, const char* p, usize n) noexcept { static_cast<Sink*>(s)->append(p, n); },
+        [](void* s, char c, usize n)        noexcept { static_cast<Sink*>(s)->append_n(c, n); },
+        [](void* s, usize n)                noexcept -> char* { return static_cast<Sink*>(s)->reserve(n); },
+        [](void* s, usize n)                noexcept { static_cast<Sink*>(s)->commit(n); },
+        [](void* s)                         noexcept -> char* { return static_cast<Sink*>(s)->data(); },
+        [](void* s)                         noexcept { return usize(static_cast<Sink*>(s)->size()); },
+        std::is_same_v<Sink, counting_sink>,
+        impl::is_gather_sink<Sink>
+    };
+
+    void*       m_sink{};
+    const ops*  m_ops{};
+};
+
+}
+
+// Format string parsing
 namespace fmt::impl {
 
-constexpr bool format_parse_spec(string_view spec, char& style, char& fill, char& align, usize& n, usize& precision) {
-    // Binary
-    // {b:}
-    // Hex
-    // {x:}
-    // Hex upper
-    // {X:}
-    // Octal
-    // {o:}
-    // General
-    // {:}
-    // {:5}
-    // {:<}   ERROR
-    // {:<5}
-    // {:X<}  ERROR
-    // {:X<5}
-    // Float
-    // {:.}   ERROR
-    // {:.2}
-    // {:<.}  ERROR
-    // {:<.2}
-    // {:X<.} ERROR
-    // {:X<.2}
-    const auto sep = spec.find_first_of(':');
+// Argument categories checked against format specs at compile time
+enum class arg_kind : u8 { other, integral, floating, string };
+
+template<typename T>
+static constexpr bool is_named = false;
+
+template<fixed_string Name, typename T>
+static constexpr bool is_named<named_arg<Name, T>> = true;
+
+// Name of a named_arg type, empty for every other type
+template<typename T>
+constexpr string_view arg_name() noexcept {
+    using U = std::remove_cvref_t<T>;
+    if constexpr(is_named<U>) return U::name.view();
+    else                      return {};
+}
+
+template<typename T>
+constexpr arg_kind arg_kind_of() noexcept {
+    using U = std::remove_cvref_t<T>;
+    if constexpr(is_named<U>)                                             return arg_kind_of<decltype(U::value)>();
+    else if constexpr(std::is_integral_v<U> && !std::is_same_v<U, bool>) return arg_kind::integral;
+    else if constexpr(std::is_floating_point_v<U>)                        return arg_kind::floating;
+    else if constexpr(std::is_convertible_v<const U&, string_view>)       return arg_kind::string;
+    else                                                                   return arg_kind::other;
+}
+
+// Set in spec::dynamic when width or precision hold the index of the argument to read them from
+static constexpr u8 DYNAMIC_WIDTH     = 0b01;
+static constexpr u8 DYNAMIC_PRECISION = 0b10;
+
+// Parsed replacement field
+struct spec {
+    u16  width{};
+    u8   precision{};
+    char style{STYLE_NONE};
+    char fill{' '};
+    char align{'<'};
+    u8   dynamic{};
+
+    ZEN_ND constexpr bool plain() const noexcept { return width == 0 && style == STYLE_NONE; }
+};
+
+// part::arg of the trailing literal, and of the first part when the fields did not fit and vformat parses again
+static constexpr u8    ARG_END     = 0xff;
+static constexpr u8    ARG_REPARSE = 0xfe;
+static constexpr usize MAX_ARGS    = ARG_REPARSE;
+
+// Fields of a format parsed at runtime, formats with more fields than arguments are parsed again at runtime
+static constexpr usize MAX_RUNTIME_PARTS = 64;
+
+// Literal run of the format string followed by a replacement field for argument arg
+struct part {
+    u32  offset{};
+    u16  size{};
+    bool escaped{};
+    u8   arg{ARG_END};
+    spec field{};
+};
+
+constexpr bool is_digit(char c)      noexcept { return c >= '0' && c <= '9'; }
+constexpr bool is_align(char c)      noexcept { return c == '<' || c == '>' || c == '^'; }
+constexpr bool is_style(char c)      noexcept { return c == 'b' || c == 'x' || c == 'X' || c == 'o' || c == STYLE_DEBUG; }
+constexpr bool is_name_start(char c) noexcept { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+constexpr bool is_name_char(char c)  noexcept { return is_name_start(c) || is_digit(c); }
+
+// Parses digits into value, returns the number of digits consumed
+constexpr usize parse_digits(string_view s, usize i, usize& value) noexcept {
+    usize begin = i;
+    value = 0;
+    for (; i < s.size() && is_digit(s[i]) && value <= num::limits<u16>::max(); ++i)
+        value = value * 10 + usize(s[i] - '0');
+    return i - begin;
+}
+
+// Arguments a format string refers to, and which of them it used so far
+// Automatic {} and manual {0} indices can not be mixed, names work with either
+struct arg_refs {
+    usize              count{};
+    const arg_kind*    kinds{};
+    const string_view* names{};     // Empty for unnamed arguments, nullptr when none are named
+    usize              next{};
+    bool               automatic{};
+    bool               manual{};
+    u64                used[(MAX_ARGS + 63) / 64]{};
+
+    constexpr const char* next_index(usize& index) noexcept {
+        if (manual)
+            return "cannot switch from manual to automatic argument indexing";
+        automatic = true;
+        if (next >= count)
+            return "more replacement fields than arguments";
+        index = next++;
+        return nullptr;
+    }
+
+    constexpr const char* manual_index(usize i, usize& index) noexcept {
+        if (automatic)
+            return "cannot switch from automatic to manual argument indexing";
+        manual = true;
+        if (i >= count)
+            return "argument index out of range";
+        index = i;
+        return nullptr;
+    }
+
+    ZEN_ND constexpr usize find(string_view name) const noexcept {
+        for (usize i = 0; names != nullptr && i < count; ++i)
+            if (!names[i].empty() && names[i] == name) return i;
+        return string_view::npos;
+    }
+
+    constexpr void use(usize i)            noexcept { used[i / 64] |= u64(1) << (i % 64); }
+    ZEN_ND constexpr bool is_used(usize i) const noexcept { return (used[i / 64] >> (i % 64)) & 1; }
+};
+
+// Nested width or precision argument {}, {1} or {name} at s[i], which must be an integer
+constexpr const char* parse_dynamic(string_view s, usize& i, arg_refs& refs, usize& index) noexcept {
+    const auto close = s.find('}', i);
+    if (close == string_view::npos)
+        return "unterminated nested replacement field";
+    const string_view id = s.substr(i + 1, close - i - 1);
+    if (id.empty()) {
+        if (const auto* error = refs.next_index(index)) return error;
+    } else if (is_digit(id[0])) {
+        usize n{};
+        if (parse_digits(id, 0, n) != id.size())
+            return "nested replacement field must be {}, an argument index or an argument name";
+        if (const auto* error = refs.manual_index(n, index)) return error;
+    } else if ((index = refs.find(id)) == string_view::npos) {
+        return "unknown argument name";
+    }
+    if (refs.kinds[index] != arg_kind::integral)
+        return "dynamic width and precision require an integer argument";
+    refs.use(index);
+    i = close + 1;
+    return nullptr;
+}
+
+// Binary        {b:}
+// Hex           {x:}
+// Hex upper     {X:}
+// Octal         {o:}
+// Escaped       {?:}  {?:>20}    quoted string, see fmt::escaped
+// General       {:}  {:5}  {:<5}  {:X<5}  {:X5}
+// Float         {:.2}  {:<.2}  {:X<.2}  {:X<8.2}
+// Dynamic       {:>{}}  {:.{}}  {:>{1}.{2}}  {:>{width}}    width and precision from integer arguments
+// The fill can be any char except '{' and '}'
+// Returns an error message, or nullptr if the spec is valid for an argument of the given kind
+constexpr const char* parse_spec(string_view s, arg_kind kind, arg_refs& refs, spec& out) noexcept {
+    if (s.empty())
+        return nullptr;
+
+    const auto sep = s.find(':');
     if (sep == string_view::npos)
-        return false;
-    
-    if (sep > 0) {
-        if (sep > 1) 
-            return false;
-        style = spec[sep - 1];
+        return "format spec must contain ':'";
+    if (sep > 1)
+        return "format style must be a single character";
+    if (sep == 1) {
+        out.style = s[0];
+        if (!is_style(out.style))
+            return "unknown format style, expected one of 'b', 'x', 'X', 'o' or '?'";
+        if (out.style == STYLE_DEBUG && kind != arg_kind::string)
+            return "format style '?' requires a string argument";
+        if (out.style != STYLE_DEBUG && kind != arg_kind::integral)
+            return "format style requires an integer argument";
     }
-    
-    string_view n_str{};
-    if (const auto alg = spec.find_first_of("<>^", sep); alg != string_view::npos) {
-        align = spec[alg];
-        n_str = {spec.data() + alg + 1, spec.size() - alg - 1};
-        if (spec[alg - 1] != ':')
-            fill = spec[alg - 1];
-    } 
-    else if (sep < spec.size() - 1) {
-        const auto c = spec[sep + 1];
-        if ((c >= '0' && c <= '9') || c == '.') {
-            n_str = {spec.data() + sep + 1, spec.size() - sep - 1};
+
+    usize i = sep + 1;
+    bool has_fill_align = false;
+    if (i + 1 < s.size() && is_align(s[i + 1])) {
+        out.fill = s[i];
+        out.align = s[i + 1];
+        i += 2;
+        has_fill_align = true;
+    } else if (i < s.size() && is_align(s[i])) {
+        out.align = s[i];
+        i += 1;
+        has_fill_align = true;
+    } else if (i < s.size() && !is_digit(s[i]) && s[i] != '.' && s[i] != '{') {
+        out.fill = s[i];
+        i += 1;
+        has_fill_align = true;
+    }
+    if (has_fill_align && (out.fill == '{' || out.fill == '}'))
+        return "format fill cannot be '{' or '}'";
+
+    usize width{};
+    usize n_width{};
+    if (i < s.size() && s[i] == '{') {
+        const usize begin = i;
+        if (const auto* error = parse_dynamic(s, i, refs, width))
+            return error;
+        out.dynamic |= DYNAMIC_WIDTH;
+        n_width = i - begin;
+    } else {
+        n_width = parse_digits(s, i, width);
+        if (width > num::limits<u16>::max())
+            return "format width is too large";
+        i += n_width;
+    }
+    out.width = u16(width);
+
+    bool has_precision = false;
+    if (i < s.size() && s[i] == '.') {
+        usize precision{};
+        if (i + 1 < s.size() && s[i + 1] == '{') {
+            i += 1;
+            if (const auto* error = parse_dynamic(s, i, refs, precision))
+                return error;
+            out.dynamic |= DYNAMIC_PRECISION;
         } else {
-            fill = c;
-            n_str = {spec.data() + sep + 2, spec.size() - sep - 2};
+            const usize n_precision = parse_digits(s, i + 1, precision);
+            if (n_precision == 0)
+                return "format precision requires digits after '.'";
+            if (precision > num::limits<u8>::max())
+                return "format precision is too large";
+            i += 1 + n_precision;
+        }
+        if (kind != arg_kind::floating)
+            return "format precision requires a floating point argument";
+        if (out.style != STYLE_NONE)
+            return "format precision cannot be combined with a style";
+        out.precision = u8(precision);
+        out.style = 'f';
+        has_precision = true;
+    }
+
+    if (i != s.size())
+        return "unexpected character in format spec";
+    if (has_fill_align && n_width == 0 && !has_precision)
+        return "format fill/alignment requires a width";
+    return nullptr;
+}
+
+// Replacement field without its braces, [arg_id][style]:[spec] or arg_id
+// arg_id is an argument index or the name of a named argument, names can be followed directly by a style
+// Without an arg_id the field takes the next argument
+constexpr const char* parse_field(string_view s, arg_refs& refs, part& p) noexcept {
+    usize i{};
+    usize index = string_view::npos;
+    if (!s.empty() && is_digit(s[0])) {
+        usize n{};
+        i = parse_digits(s, 0, n);
+        if (const auto* error = refs.manual_index(n, index))
+            return error;
+    } else if (!s.empty() && is_name_start(s[0])) {
+        usize end = 1;
+        while (end < s.size() && is_name_char(s[end])) 
+            ++end;
+        const string_view id = s.substr(0, end);
+        if ((index = refs.find(id)) != string_view::npos)
+            i = end;
+        else if (id.size() > 1 && is_style(id.back()) && (index = refs.find(id.substr(0, id.size() - 1))) != string_view::npos)
+            i = end - 1;
+        else if (!(id.size() == 1 && is_style(id[0]) && end < s.size() && s[end] == ':'))
+            return "unknown argument name";
+    }
+    if (index == string_view::npos) {
+        if (const auto* error = refs.next_index(index))
+            return error;
+    }
+    refs.use(index);
+    p.arg = u8(index);
+    return parse_spec(s.substr(i), refs.kinds[index], refs, p.field);
+}
+
+// Splits the format string into literal runs and replacement fields.
+// parts holds capacity entries, the last used entry only holds the trailing literal
+// When there are more fields than fit, the first entry is set to ARG_REPARSE after checking the whole format
+// Returns an error message, or nullptr if the format is valid for the given arguments
+constexpr const char* parse_format(string_view s, part* parts, usize capacity, arg_refs refs) noexcept {
+    usize n_fields{}, literal{};
+    bool escaped = false;
+    part overflow{};
+    for (usize i = 0; i < s.size(); ++i) {
+        const char c = s[i];
+        if (c == '{') {
+            if (i + 1 < s.size() && s[i + 1] == '{') { 
+                escaped = true; 
+                ++i; 
+                continue; 
+            }
+            // Nested fields of dynamic specs are part of the field
+            usize close = i + 1;
+            for (usize depth = 1; close < s.size(); ++close) {
+                if (s[close] == '{') ++depth;
+                else if (s[close] == '}' && --depth == 0) break;
+            }
+            if (close >= s.size())
+                return "unterminated replacement field";
+            if (i - literal > num::limits<u16>::max())
+                return "literal text between replacement fields is too long";
+            part& p = n_fields + 1 < capacity ? parts[n_fields] : overflow;
+            p = part{u32(literal), u16(i - literal), escaped, ARG_END, spec{}};
+            if (const auto* error = parse_field(s.substr(i + 1, close - i - 1), refs, p))
+                return error;
+            ++n_fields;
+            i = close;
+            literal = close + 1;
+            escaped = false;
+        }
+        else if (c == '}') {
+            if (i + 1 < s.size() && s[i + 1] == '}') { 
+                escaped = true; 
+                ++i; 
+                continue; 
+            }
+            return "unmatched '}' in format string, use '}}' to print '}'";
         }
     }
-    const bool is_precision = !n_str.empty() && n_str[0] == '.';
-    if (is_precision) {
-        n_str = {n_str.data() + 1, n_str.size() - 1};
-        style = 'f';
+    for (usize i = 0; i < refs.count; ++i) {
+        if (!refs.is_used(i))
+            return refs.manual || refs.names != nullptr ? "argument is never used" : "fewer replacement fields than arguments";
     }
-    if (!chars_to_int(n_str.data(), n_str.data() + n_str.size(), n)) {
-        return false;
+    if (s.size() - literal > num::limits<u16>::max())
+        return "literal text between replacement fields is too long";
+    if (n_fields + 1 > capacity) {
+        if (n_fields + 1 > MAX_RUNTIME_PARTS)
+            return "too many replacement fields";
+        parts[0].arg = ARG_REPARSE;
+        return nullptr;
+    }
+    parts[n_fields] = part{u32(literal), u16(s.size() - literal), escaped, ARG_END, spec{}};
+    return nullptr;
+}
+
+// Not constexpr, so reaching it during constant evaluation is a compile error at the bad format string
+inline void format_error(const char*) noexcept {}
+
+}
+
+namespace fmt {
+
+template<typename... Args>
+struct basic_format_string {
+    static constexpr usize n_args = sizeof...(Args);
+
+    string_view str{};
+    impl::part  parts[n_args + 1]{};
+
+    static_assert(n_args <= impl::MAX_ARGS, "too many format arguments");
+
+    template<typename S, typename = std::enable_if_t<std::is_convertible_v<const S&, string_view>>>
+    consteval basic_format_string(const S& s) : str{s} {
+        constexpr impl::arg_kind kinds[n_args + 1]{impl::arg_kind_of<Args>()...};
+        constexpr string_view    names[n_args + 1]{impl::arg_name<Args>()...};
+        constexpr bool           named = (impl::is_named<std::remove_cvref_t<Args>> || ...);
+        if (const auto* error = impl::parse_format(str, parts, n_args + 1, {n_args, kinds, named ? names : nullptr}))
+            impl::format_error(error);
     }
-    if (is_precision) {
-        precision = n;
-        n = 0;
+};
+
+}
+
+// Format impl
+namespace fmt::impl {
+
+template<typename Out>
+constexpr void format_literal(Out& out, string_view fmt, const part& p) noexcept {
+    if (ZEN_LIKELY(!p.escaped)) {
+        if (p.size > 0)
+            out << string_view{fmt.data() + p.offset, p.size};
+    } else {
+        // Literal contains '{{' or '}}', write the runs up to and including the first brace of each pair
+        const char* it = fmt.data() + p.offset;
+        const char* end = it + p.size;
+        const char* run = it;
+        while (it != end) {
+            if (*it == '{' || *it == '}') {
+                out << string_view{run, usize(it + 1 - run)};
+                run = it += 2;
+            } else {
+                ++it;
+            }
+        }
+        if (run != end) 
+            out << string_view{run, usize(end - run)};
     }
-    return true;
 }
 
 template<typename Out, typename T>
 void format_with_style(Out& out, char style, usize precision, T&& value) noexcept {
-    using U = std::remove_reference_t<T>;
+    using U = std::remove_cvref_t<T>;
     if (ZEN_LIKELY(style == STYLE_NONE)) {
         out << value;
     } else {
         if constexpr(std::is_integral_v<U> && !std::is_same_v<U, bool>) {
-            // panic if precision specified
             switch (style) {
                 case 'b': out << binary<U>{ZEN_FWD(value)}; return;
                 case 'x': out << hex<U>{ZEN_FWD(value)}; return;
@@ -229,118 +1116,379 @@ void format_with_style(Out& out, char style, usize precision, T&& value) noexcep
             }
         } 
         else if constexpr(std::is_floating_point_v<U>) {
-            // paanic if style != f
-            // panic if type specified
             out << precisev<U>{ZEN_FWD(value), u8(precision)};
         }
+        else if constexpr(std::is_convertible_v<const U&, string_view>) {
+            if (style == STYLE_DEBUG) out << escaped{string_view(value)};
+            else                      out << value;
+        }
         else {
-            // panic invalid format specifier for type
+            out << value;
         }
     }
 }
 
+// Digits of an integer in the base of a style, without the prefix
+template<typename T>
+ZEN_FORCEINLINE usize styled_int_len(char style, T v) noexcept {
+    switch (style) {
+        case 'b':           return int_len<2>(v);
+        case 'x': case 'X': return int_len<16>(v);
+        case 'o':           return int_len<8>(v);
+        default:            return int_len<10>(v);
+    }
+}
+
 template<typename Out, typename T>
-void format_part(Out& out, string_view spec, T&& value) noexcept {
-    if (ZEN_LIKELY(spec.empty())) {
+void format_part(Out& out, const spec& s, T&& value) noexcept {
+    if (ZEN_LIKELY(s.plain())) {
         out << value;
-    } else {
-        usize n{}, precision{};
-        char style{STYLE_NONE}, fill{' '}, align{'<'};
-        if (!format_parse_spec(spec, style, fill, align, n, precision)) {
-            // panic fail
+        return;
+    }
+    if constexpr(std::is_integral_v<std::remove_reference_t<T>>) {
+        switch (s.style) {
+            case 'b': out << "0b"; break;
+            case 'x': out << "0x"; break;
+            case 'X': out << "0x"; break;
+            case 'o': out << "0o"; break;
+            default: break;
         }
-        if constexpr(std::is_integral_v<std::remove_reference_t<T>>) {
-            switch (style) {
-                case 'b': out << "0b"; break;
-                case 'x': out << "0x"; break;
-                case 'X': out << "0x"; break;
-                case 'o': out << "0o"; break;
-                default: break;
-            }
-        } 
-        if (ZEN_LIKELY(align == '<')) {
-            const usize o = out.size();
-            format_with_style(out, style, precision, ZEN_FWD(value));
-            const usize used = out.size() - o;
-            const usize remaining = n >= used ? n - used : 0;
-            for (usize i = 0; i < remaining; ++i) out << fill;
-        } else {
-            buffer<512> tmp{};
-            format_with_style(tmp, style, precision, ZEN_FWD(value));
-            const usize remaining = n >= tmp.size() ? n - tmp.size() : 0;
-            const usize after = align == '^' ? (remaining / 2) : 0;
-            for (usize i = 0; i < remaining - after; ++i) out << fill;
-            out << string_view(tmp);
-            for (usize i = 0; i < after; ++i) out << fill;
+    } 
+    using U = std::remove_cvref_t<T>;
+    // Length is known up front, write the padding around the value, escaped strings are padded in place below
+    if constexpr(std::is_same_v<U, string_view> || (std::is_integral_v<U> && !std::is_same_v<U, bool>)) {
+        if (s.style != STYLE_DEBUG) {
+            usize used{};
+            if constexpr(std::is_same_v<U, string_view>)  used = value.size();
+            else if constexpr(std::is_same_v<U, char>)    used = s.style == STYLE_NONE ? 1 : styled_int_len(s.style, value);
+            else                                          used = styled_int_len(s.style, value);
+            const usize remaining = used < s.width ? s.width - used : 0;
+            const usize before = s.align == '>' ? remaining : s.align == '^' ? remaining - remaining / 2 : 0;
+            if (before > 0) 
+                out.append_n(s.fill, before);
+            format_with_style(out, s.style, s.precision, ZEN_FWD(value));
+            if (remaining > before) 
+                out.append_n(s.fill, remaining - before);
+            return;
+        }
+    }
+    if constexpr(std::is_same_v<Out, sink_ref>) {
+        // size() does not count the strings a gather_sink keeps by reference, pad a copy of the value instead
+        if (out.references()) {
+            dynamic_buffer<> tmp{};
+            sink_ref tmp_out{tmp};
+            format_with_style(tmp_out, s.style, s.precision, ZEN_FWD(value));
+            const usize used = tmp.size();
+            const usize remaining = used < s.width ? s.width - used : 0;
+            const usize before = s.align == '>' ? remaining : s.align == '^' ? remaining - remaining / 2 : 0;
+            out.append_n(s.fill, before);
+            memcpy(out.reserve(used), tmp.data(), used);
+            out.commit(used);
+            out.append_n(s.fill, remaining - before);
+            return;
         }
     }
+    // Format in place and pad the end, then rotate the value right if the padding goes in front
+    const usize start = usize(out.size());
+    format_with_style(out, s.style, s.precision, ZEN_FWD(value));
+    const usize used = usize(out.size()) - start;
+    if (used >= s.width) 
+        return;
+    const usize remaining = s.width - used;
+    const usize before = s.align == '>' ? remaining : s.align == '^' ? remaining - remaining / 2 : 0;
+    out.append_n(s.fill, remaining);
+    if (before == 0 || out.data() == nullptr) 
+        return;
+    // A fixed buffer may have truncated the padding, keep whatever prefix fits
+    char* value_begin = out.data() + start;
+    const usize total = usize(out.size()) - start;
+    if (before < total)
+        memmove(value_begin + before, value_begin, used < total - before ? used : total - before);
+    memset(value_begin, s.fill, before < total ? before : total);
 }
 
-template<typename Out, typename T, typename... Rest>
-void format(Out& out, const string_view& fmt, T&& value, Rest&&... rest) noexcept {    
-    usize offset{};
-    bool inside_format = false;
-    usize begin_spec{};
-    for (; offset < fmt.size(); ++offset) {
-        const auto c = fmt[offset];
-        if (c == '{') {
-            if (offset + 1 < fmt.size() && fmt[offset + 1] == '{') {
-                out << '{';
-                offset++;
-                continue;
-            } else {
-                inside_format = true;
-                begin_spec = offset + 1;
-                continue;
-            }
-        }
-        else if (c == '}') {
-            if (offset + 1 < fmt.size() && fmt[offset + 1] == '}') {
-                out << '}';
-                offset++;
-                continue;
-            } else {
-                format_part(out, string_view{fmt.data() + begin_spec, offset - begin_spec}, ZEN_FWD(value));
-                offset++;
-                inside_format = false;
-                break;
-            }
-        }
-        if (!inside_format) {
-            out << c;
-        }
+}
+
+// Type-erased arguments
+namespace fmt {
+
+// names is an extra last entry of make_args with the names of the arguments, when any of them is named
+enum class arg_type : u8 { none, boolean, character, int32, uint32, int64, uint64, float32, float64, string, pointer, custom, names };
+
+// Formatting argument as a tag and a value, other types keep a pointer to the value and a function to format it
+// Only valid while the value it was made from is alive, make_args is meant for arguments of one call
+struct arg {
+    struct string_t { const char* data; usize size; };
+    struct custom_t { const void* value; void (*format)(sink_ref& out, const impl::spec& s, const void* value) noexcept; };
+
+    union {
+        bool        boolean;
+        char        character;
+        i32         int32;
+        u32         uint32;
+        i64         int64;
+        u64         uint64;
+        f32         float32;
+        f64         float64;
+        const void* pointer;
+        string_t    string;
+        custom_t    custom;
+        const string_view* names;
+    };
+    arg_type        type{arg_type::none};
+    impl::arg_kind  kind{impl::arg_kind::other};
+};
+
+template<usize N>
+struct arg_store {
+    arg args[N > 0 ? N : 1]{};
+
+    ZEN_ND const arg* data() const noexcept { return args; }
+    ZEN_ND usize      size() const noexcept { return N; }
+};
+
+}
+
+namespace fmt::impl {
+
+template<typename T>
+void format_custom(sink_ref& out, const spec& s, const void* value) noexcept {
+    format_part(out, s, *static_cast<const T*>(value));
+}
+
+// Integers are widened to 32 or 64 bits, which formats them the same in every style
+// Strings and char arrays are stored as views, everything else formats through its own operator<<
+template<typename T>
+ZEN_FORCEINLINE arg make_arg(const T& v) noexcept {
+    using U = std::remove_cv_t<T>;
+    arg a{};
+    a.kind = arg_kind_of<U>();
+    if constexpr(std::is_same_v<U, bool>) {
+        a.type = arg_type::boolean; a.boolean = v;
+    } else if constexpr(std::is_same_v<U, char>) {
+        a.type = arg_type::character; a.character = v;
+    } else if constexpr(std::is_integral_v<U> && sizeof(U) <= sizeof(u32)) {
+        if constexpr(std::is_signed_v<U>) { a.type = arg_type::int32;  a.int32 = i32(v); }
+        else                              { a.type = arg_type::uint32; a.uint32 = u32(v); }
+    } else if constexpr(std::is_integral_v<U> && sizeof(U) <= sizeof(u64)) {
+        if constexpr(std::is_signed_v<U>) { a.type = arg_type::int64;  a.int64 = i64(v); }
+        else                              { a.type = arg_type::uint64; a.uint64 = u64(v); }
+    } else if constexpr(std::is_same_v<U, f32>) {
+        a.type = arg_type::float32; a.float32 = v;
+    } else if constexpr(std::is_same_v<U, f64>) {
+        a.type = arg_type::float64; a.float64 = v;
+    } else if constexpr(std::is_array_v<U> && std::is_same_v<std::remove_cv_t<std::remove_extent_t<U>>, char>) {
+        a.type = arg_type::string; a.string = {v, std::extent_v<U> - 1};
+    } else if constexpr(std::is_convertible_v<const U&, string_view>) {
+        string_view sv{};
+        if constexpr(std::is_pointer_v<U>) { if (v != nullptr) sv = v; }
+        else                               { sv = v; }
+        a.type = arg_type::string; a.string = {sv.data(), sv.size()};
+    } else if constexpr(std::is_null_pointer_v<U> || (std::is_pointer_v<U> && !std::is_function_v<std::remove_pointer_t<U>>)) {
+        a.type = arg_type::pointer; a.pointer = v;
+    } else {
+        a.type = arg_type::custom; a.custom = {&v, &format_custom<U>};
+    }
+    return a;
+}
+
+template<fixed_string Name, typename T>
+ZEN_FORCEINLINE arg make_arg(const named_arg<Name, T>& v) noexcept {
+    return make_arg(v.value);
+}
+
+inline void format_arg(sink_ref& out, const spec& s, const arg& a) noexcept {
+    switch (a.type) {
+        case arg_type::none:        
+        case arg_type::names:       return;
+        case arg_type::boolean:     format_part(out, s, a.boolean); return;
+        case arg_type::character:   format_part(out, s, a.character); return;
+        case arg_type::int32:       format_part(out, s, a.int32); return;
+        case arg_type::uint32:      format_part(out, s, a.uint32); return;
+        case arg_type::int64:       format_part(out, s, a.int64); return;
+        case arg_type::uint64:      format_part(out, s, a.uint64); return;
+        case arg_type::float32:     format_part(out, s, a.float32); return;
+        case arg_type::float64:     format_part(out, s, a.float64); return;
+        case arg_type::string:      format_part(out, s, string_view{a.string.data, a.string.size}); return;
+        case arg_type::pointer:     format_part(out, s, a.pointer); return;
+        case arg_type::custom:      a.custom.format(out, s, a.custom.value); return;
     }
-    if constexpr (sizeof...(Rest) > 0) {
-        format(out, string_view{fmt.data() + offset, fmt.size() - offset}, ZEN_FWD(rest)...);
+}
+
+}
+
+namespace fmt {
+
+// Type-erased arguments for vformat, valid until the end of the full expression
+template<typename... Args>
+ZEN_FORCEINLINE auto make_args(const Args&... args) noexcept {
+    if constexpr((impl::is_named<Args> || ...)) {
+        static constexpr string_view NAMES[]{impl::arg_name<Args>()...};
+        arg names{};
+        names.type = arg_type::names;
+        names.names = NAMES;
+        return arg_store<sizeof...(Args) + 1>{{impl::make_arg(args)..., names}};
     } else {
-        for (; offset < fmt.size(); ++offset) {
-            const char c = fmt[offset];
-            if (c == '{') {
-                offset += 1 + (offset + 1 < fmt.size() && fmt[offset + 1] == '{');
-                out << '{';
-            }
-            else if (c == '}') {
-                offset += 1 + (offset + 1 < fmt.size() && fmt[offset + 1] == '{');
-                out << '}';
-            } 
-            else {
-                out << c;
+        return arg_store<sizeof...(Args)>{{impl::make_arg(args)...}};
+    }
+}
+
+template<fixed_string Name, typename T>
+constexpr named_arg<Name, const T&> named(const T& value) noexcept 
+{ 
+    static_assert(Name.view().size() > 0, "argument names can not be empty");
+    return {value}; 
+}
+
+static constexpr usize MAX_RUNTIME_ARGS = 32;
+
+}
+
+namespace fmt::impl {
+
+// Value of an integer argument for a dynamic width or precision, clamped to [0, max]
+inline usize dynamic_value(const arg& a, usize max) noexcept {
+    i64 v{};
+    switch (a.type) {
+        case arg_type::character:   v = i64(a.character); break;
+        case arg_type::int32:       v = a.int32; break;
+        case arg_type::uint32:      v = i64(a.uint32); break;
+        case arg_type::int64:       v = a.int64; break;
+        case arg_type::uint64:      return a.uint64 > max ? max : usize(a.uint64);
+        default:                    return 0;
+    }
+    return v < 0 ? 0 : u64(v) > max ? max : usize(v);
+}
+
+// Spec with the width and precision read from their arguments
+inline spec resolve(spec s, span<const arg> args) noexcept {
+    if (s.dynamic & DYNAMIC_WIDTH)     s.width = u16(dynamic_value(args[s.width], num::limits<u16>::max()));
+    if (s.dynamic & DYNAMIC_PRECISION) s.precision = u8(dynamic_value(args[s.precision], num::limits<u8>::max()));
+    s.dynamic = 0;
+    return s;
+}
+
+}
+
+namespace fmt {
+
+ZEN_NEVERINLINE void vformat(sink_ref out, string_view fmt, const impl::part* parts, span<const arg> args) noexcept
+{
+    if (ZEN_UNLIKELY(parts[0].arg == impl::ARG_REPARSE)) {
+        vformat(out, runtime_format_string{fmt}, args);
+        return;
+    }
+    const impl::part* p = parts;
+    for (; p->arg != impl::ARG_END; ++p) {
+        impl::format_literal(out, fmt, *p);
+        if (ZEN_LIKELY(p->field.dynamic == 0))
+            impl::format_arg(out, p->field, args[p->arg]);
+        else
+            impl::format_arg(out, impl::resolve(p->field, args), args[p->arg]);
+    }
+    impl::format_literal(out, fmt, *p);
+}
+
+ZEN_NEVERINLINE void vformat(sink_ref out, runtime_format_string fmt, span<const arg> args) noexcept
+{
+    const string_view* names = !args.empty() && args[args.size() - 1].type == arg_type::names ? args[args.size() - 1].names : nullptr;
+    const usize n_args = args.size() - (names != nullptr);
+    impl::arg_kind kinds[MAX_RUNTIME_ARGS + 1]{};
+    impl::part parts[impl::MAX_RUNTIME_PARTS]{};
+    if (ZEN_UNLIKELY(n_args > MAX_RUNTIME_ARGS)) {
+        out << "InvalidFormat(" << fmt.str << ")";
+        return;
+    }
+    for (usize i = 0; i < n_args; ++i) 
+        kinds[i] = args[i].kind;
+    if (ZEN_UNLIKELY(impl::parse_format(fmt.str, parts, impl::MAX_RUNTIME_PARTS, {n_args, kinds, names}) != nullptr)) {
+        out << "InvalidFormat(" << fmt.str << ")";
+        return;
+    }
+    vformat(out, fmt.str, parts, args);
+}
+
+}
+
+namespace fmt::impl {
+
+// Chars of a literal run, each escaped brace pair writes one char
+inline usize literal_len(string_view fmt, const part& p) noexcept {
+    if (ZEN_LIKELY(!p.escaped))
+        return p.size;
+    usize n = p.size;
+    for (usize i = p.offset; i < usize(p.offset) + p.size; ++i) {
+        if (fmt[i] == '{' || fmt[i] == '}') { --n; ++i; }
+    }
+    return n;
+}
+
+// What vformat would write for one argument, only floats, escaped strings and other types are formatted into a counting sink
+inline usize arg_len(const spec& s, const arg& a) noexcept {
+    usize prefix{}, n{};
+    const auto styled = [&](auto v) {
+        n = styled_int_len(s.style, v);
+        prefix = s.style != STYLE_NONE ? 2 : 0;
+    };
+    switch (a.type) {
+        case arg_type::none:
+        case arg_type::names:       return 0;
+        case arg_type::boolean:     n = a.boolean ? 4 : 5; break;
+        case arg_type::character:   if (s.style == STYLE_NONE) n = 1; else styled(a.character); break;
+        case arg_type::int32:       styled(a.int32); break;
+        case arg_type::uint32:      styled(a.uint32); break;
+        case arg_type::int64:       styled(a.int64); break;
+        case arg_type::uint64:      styled(a.uint64); break;
+        case arg_type::pointer:     n = 2 + int_len<16>(u64(reinterpret_cast<uintptr_t>(a.pointer))); break;
+        case arg_type::string:
+            if (s.style != STYLE_DEBUG) { 
+                n = a.string.size; 
+                break; 
             }
+            [[fallthrough]];
+        case arg_type::float32:
+        case arg_type::float64:
+        case arg_type::custom: {
+            counting_sink out{};
+            sink_ref ref{out};
+            format_arg(ref, s, a);
+            return out.size();
         }
-        // out << string_view{fmt.data() + offset, fmt.size() - offset};
     }
+    return prefix + (n < s.width ? s.width : n);
 }
 
-template<typename... Args>
-ZEN_NORETURN static void assert_fail(const char* file, const char* function, int line, const char* expr, Args&&... args) 
+// Same as formatting into a counting_sink, without the calls through sink_ref for every piece
+ZEN_NEVERINLINE usize formatted_size(string_view fmt, const part* parts, span<const arg> args) noexcept
 {
-    if constexpr(sizeof...(Args) > 0) {
-        buffer<4096> buf{};
-        format(buf, ZEN_FWD(args)...);
-        fprintf(stderr, "%s:%d: %s: Assertion `%s` failed. %s\n", file, line, function, expr, buf.data());
-    } else {
-        fprintf(stderr, "%s:%d: %s: Assertion `%s` failed.\n", file, line, function, expr);
+    if (ZEN_UNLIKELY(parts[0].arg == ARG_REPARSE)) {
+        counting_sink out{};
+        vformat(out, runtime_format_string{fmt}, args);
+        return out.size();
     }
+    usize n{};
+    const part* p = parts;
+    for (; p->arg != ARG_END; ++p) {
+        const spec s = ZEN_LIKELY(p->field.dynamic == 0) ? p->field : resolve(p->field, args);
+        n += literal_len(fmt, *p) + arg_len(s, args[p->arg]);
+    }
+    return n + literal_len(fmt, *p);
+}
+
+// Where an assertf failed, built from constants at the call site
+struct assert_site {
+    const char* file;
+    const char* function;
+    const char* expr;
+    int         line;
+};
+
+ZEN_NORETURN ZEN_COLD ZEN_NEVERINLINE void vassert_fail(const assert_site& site, string_view fmt, const part* parts, span<const arg> args) noexcept 
+{
+    zen::flush();
+    dynamic_buffer<> buf{};
+    vformat(buf, fmt, parts, args);
+    fprintf(stderr, "%s:%d: %s: Assertion `%s` failed. %.*s\n", site.file, site.line, site.function, site.expr, int(buf.size()), buf.data());
     #if defined(ZEN_COMPILER_MSVC)
         DebugBreak();
     #elif defined(SIGTRAP)
@@ -351,142 +1499,1520 @@ ZEN_NORETURN static void assert_fail(const char* file, const char* function, int
     exit(1);
 }
 
+// Outlined so the caller only passes references to the arguments, make_args and the format string stay out of it
+template<typename... Args>
+ZEN_NORETURN ZEN_COLD ZEN_NEVERINLINE void assert_fail(const assert_site& site, format_string<Args...> fmt, Args&&... args) noexcept
+{
+    vassert_fail(site, fmt.str, fmt.parts, make_args(args...));
+}
+
+// Failure of an assertf kept by ZEN_CHECKS, the message arguments were never evaluated
+ZEN_NORETURN ZEN_COLD ZEN_NEVERINLINE void check_fail(const assert_site& site) noexcept
+{
+    zen::flush();
+    fprintf(stderr, "%s:%d: %s: Check `%s` failed.\n", site.file, site.line, site.function, site.expr);
+    abort();
+}
+
+}
+
+// Buffer overflow
+namespace fmt {
+
+template<usize N, bool Truncate>
+char* buffer<N, Truncate>::reserve_scratch([[maybe_unused]] usize n) noexcept {
+    assertf(n <= impl::MAX_CONVERSION_LEN, "fmt::buffer can not reserve {} chars", n);
+    m_scratch = true;
+    return impl::conversion_scratch();
+}
+
+template<usize N, bool Truncate>
+void buffer<N, Truncate>::overflow([[maybe_unused]] usize dropped) noexcept {
+    if constexpr(!Truncate) {
+        assertf(false, "fmt::buffer<{}> overflowed by {} chars, use fmt::dynamic_buffer or fmt::truncating_buffer", N, dropped);
+    }
+    m_truncated = true;
+}
+
 }
 
 // Number string conversion
 namespace fmt {
 
+namespace impl {
+
+// Digit value of every char, 36 for chars that are not digits in any base
+static constexpr auto DIGIT_VALUES = []{
+    struct { u8 data[256]; } t{};
+    for (u32 c = 0; c < 256; ++c) {
+        if      (c >= '0' && c <= '9') t.data[c] = u8(c - '0');
+        else if (c >= 'a' && c <= 'z') t.data[c] = u8(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'Z') t.data[c] = u8(c - 'A' + 10);
+        else                           t.data[c] = 36;
+    }
+    return t;
+}();
+
+ZEN_FORCEINLINE u64 load_u64(const char* p) noexcept {
+    u64 v{};
+    memcpy(&v, p, sizeof(v));
+    #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        v = __builtin_bswap64(v);
+    #endif
+    return v;
+}
+
+// SWAR check that all 8 chars are in '0'..'9'
+ZEN_FORCEINLINE bool is_eight_digits(u64 v) noexcept {
+    return ((v & 0xf0f0f0f0f0f0f0f0) | (((v + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) >> 4)) == 0x3333333333333333;
+}
+
+// Number of leading chars of v that are '0'..'9', 8 when all of them are
+// A carry out of a byte that is not a digit can only reach the chars after it
+ZEN_FORCEINLINE usize count_leading_digits(u64 v) noexcept {
+    const u64 x = ((v & 0xf0f0f0f0f0f0f0f0) | (((v + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) >> 4)) ^ 0x3333333333333333;
+    return x == 0 ? 8 : trailing_zeros(x) / 8;
+}
+
+// SWAR conversion of 8 digits, 3 multiplies instead of 8
+ZEN_FORCEINLINE u32 parse_eight_digits(u64 v) noexcept {
+    v -= 0x3030303030303030;
+    v = (v * 10) + (v >> 8);
+    v = (((v & 0x000000ff000000ff) * 0x000f424000000064) + (((v >> 16) & 0x000000ff000000ff) * 0x0000271000000001)) >> 32;
+    return u32(v);
+}
+
+// Number of leading digits in [begin, end)
+ZEN_FORCEINLINE const char* skip_digits(const char* it, const char* end) noexcept {
+    #ifdef ZEN_SSE2
+    while (end - it >= 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+        const __m128i bad = _mm_or_si128(_mm_cmplt_epi8(chunk, _mm_set1_epi8('0')), _mm_cmpgt_epi8(chunk, _mm_set1_epi8('9')));
+        const u32 mask = u32(_mm_movemask_epi8(bad));
+        if (mask != 0) 
+            return it + trailing_zeros(mask);
+        it += 16;
+    }
+    #endif
+    while (end - it >= 8 && is_eight_digits(load_u64(it))) it += 8;
+    while (it != end && *it >= '0' && *it <= '9') ++it;
+    return it;
+}
+
+#ifdef ZEN_SSE2
+// SSE2 conversion of 16 digits, pairs of digits are combined with multiply-add until two 8 digit halves remain
+ZEN_FORCEINLINE u64 parse_sixteen_digits(const char* p) noexcept {
+    // Callers check for 16 digits, but after inlining GCC sees the load against short literals it cannot prove skip it
+    #ifdef ZEN_COMPILER_GCC
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Warray-bounds"
+    #endif
+    const __m128i chars  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    #ifdef ZEN_COMPILER_GCC
+    #pragma GCC diagnostic pop
+    #endif
+    const __m128i zero   = _mm_setzero_si128();
+    const __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    const __m128i p10    = _mm_set_epi16(1, 10, 1, 10, 1, 10, 1, 10);
+    const __m128i p100   = _mm_set_epi16(1, 100, 1, 100, 1, 100, 1, 100);
+    const __m128i p10000 = _mm_set_epi16(1, 10000, 1, 10000, 1, 10000, 1, 10000);
+    const __m128i d2 = _mm_packs_epi32(
+        _mm_madd_epi16(_mm_unpacklo_epi8(digits, zero), p10), 
+        _mm_madd_epi16(_mm_unpackhi_epi8(digits, zero), p10));
+    const __m128i d4 = _mm_madd_epi16(d2, p100);
+    const __m128i d8 = _mm_madd_epi16(_mm_packs_epi32(d4, d4), p10000);
+    const u64 hi = u32(_mm_cvtsi128_si32(d8));
+    const u64 lo = u32(_mm_cvtsi128_si32(_mm_srli_si128(d8, 4)));
+    return hi * 100000000 + lo;
+}
+#endif
+
+// Base 10 digits [begin, end) with at most 19 digits, which always fits in u64
+ZEN_FORCEINLINE u64 parse_decimal_digits(const char* it, const char* end) noexcept {
+    u64 acc{};
+    #ifdef ZEN_SSE2
+    if (end - it >= 16) {
+        acc = parse_sixteen_digits(it);
+        it += 16;
+    }
+    #endif
+    while (end - it >= 8) {
+        acc = acc * 100000000 + parse_eight_digits(load_u64(it));
+        it += 8;
+    }
+    for (; it != end; ++it)
+        acc = acc * 10 + u64(*it - '0');
+    return acc;
+}
+
+}
+
 template<usize Base, typename T>
-constexpr bool chars_to_int(const char* begin, const char* end, T& value, num::index_t<Base>) noexcept
+constexpr parse_result chars_to_int(const char* begin, const char* end, T& value, num::index_t<Base>) noexcept
 {
-    if ((end - begin) == 1) {
-        value = T(*begin - '0');
+    constexpr u32 BASE = Base & 0xff;
+    static_assert(BASE >= 2 && BASE <= 36, "chars_to_int supports bases 2 to 36");
+    static_assert(std::is_integral_v<T> && !std::is_same_v<T, bool>, "chars_to_int requires an integer type");
+    using U = std::make_unsigned_t<T>;
+    using A = std::conditional_t<(sizeof(U) > sizeof(u64)), U, u64>;
+
+    const char* it = begin;
+    bool negative = false;
+    if (it != end && (*it == '-' || *it == '+')) {
+        negative = *it == '-';
+        if constexpr(std::is_unsigned_v<T>) {
+            if (negative) return {begin, parse_error::invalid};
+        }
+        ++it;
+    }
+
+    // Largest magnitude that fits, one more for negative signed values
+    const A max_magnitude = A(std::is_signed_v<T> ? A(U(~U(0)) >> 1) + A(negative) : A(U(~U(0))));
+
+    // Fast path for base 10, SWAR/SSE conversion of the digit run
+    if constexpr(BASE == 10 && sizeof(A) == sizeof(u64)) {
+        if (!ZEN_CONSTANT_EVALUATED()) {
+            // Fewer than 8 digits, the common case, are counted and converted from one load
+            // The digits are shifted to the end of the word and the chars before them filled with '0'
+            if (end - it >= 8) {
+                const u64 v = impl::load_u64(it);
+                const usize n = impl::count_leading_digits(v);
+                if (n == 0)
+                    return {begin, parse_error::invalid};
+                if (n < 8) {
+                    const u64 acc = impl::parse_eight_digits((v << (64 - n * 8)) | (UINT64_C(0x3030303030303030) >> (n * 8)));
+                    if (acc > max_magnitude)
+                        return {it + n, parse_error::overflow};
+                    value = negative ? T(U(0) - U(acc)) : T(acc);
+                    return {it + n, parse_error::none};
+                }
+            }
+            const char* digits = it;
+            while (it != end && *it == '0') ++it;
+            const char* significant = it;
+            it = impl::skip_digits(it, end);
+            if (it == digits) 
+                return {begin, parse_error::invalid};
+            const usize n = usize(it - significant);
+            if (n > 20)
+                return {it, parse_error::overflow};
+            u64 acc{};
+            if (n == 20) {
+                // Only the last digit can overflow u64
+                acc = impl::parse_decimal_digits(significant, it - 1);
+                const u64 d = u64(it[-1] - '0');
+                if (acc > (UINT64_MAX - d) / 10)
+                    return {it, parse_error::overflow};
+                acc = acc * 10 + d;
+            } else {
+                acc = impl::parse_decimal_digits(significant, it);
+            }
+            if (acc > max_magnitude)
+                return {it, parse_error::overflow};
+            value = negative ? T(U(0) - U(acc)) : T(acc);
+            return {it, parse_error::none};
+        }
+    }
+
+    const char* digits = it;
+    const A cutoff = max_magnitude / BASE;
+    const u32 cutlim = u32(max_magnitude % BASE);
+    A acc{};
+    bool overflow = false;
+    for (; it != end; ++it) {
+        const u32 d = impl::DIGIT_VALUES.data[u8(*it)];
+        if (d >= BASE) 
+            break;
+        overflow |= acc > cutoff || (acc == cutoff && d > cutlim);
+        acc = acc * BASE + d;
+    }
+    if (it == digits) 
+        return {begin, parse_error::invalid};
+    if (overflow) 
+        return {it, parse_error::overflow};
+    value = negative ? T(U(0) - U(acc)) : T(acc);
+    return {it, parse_error::none};
+}
+
+namespace impl {
+
+// Accumulates the digits at it into w (wrapping), 8 at a time where possible
+ZEN_FORCEINLINE const char* parse_digit_run(const char* it, const char* end, u64& w) noexcept {
+    while (end - it >= 8) {
+        const u64 v = load_u64(it);
+        if (!is_eight_digits(v)) 
+            break;
+        w = w * 100000000 + parse_eight_digits(v);
+        it += 8;
+    }
+    for (; it != end && is_digit(*it); ++it)
+        w = w * 10 + u64(*it - '0');
+    return it;
+}
+
+// Parses digits[.digits]|.digits[(e|E)[-+]digits], returns nullptr if there are no digits
+inline const char* parse_decimal(const char* it, const char* end, decimal_string& d) noexcept {
+    static constexpr i64 MAX_EXPONENT = 0x10000000;
+    d.digits = it;
+    it = parse_digit_run(it, end, d.w);
+    i64 digit_count = it - d.digits;
+    i64 fraction_count = 0;
+    if (it != end && *it == '.') {
+        const char* fraction = ++it;
+        it = parse_digit_run(it, end, d.w);
+        fraction_count = it - fraction;
+        digit_count += fraction_count;
+    }
+    if (digit_count == 0)
+        return nullptr;
+    d.digits_end = it;
+
+    // An exponent without digits is not part of the number
+    i64 exponent{};
+    if (it != end && (*it | 0x20) == 'e') {
+        const char* e = it + 1;
+        const bool negative = e != end && *e == '-';
+        if (e != end && (*e == '-' || *e == '+')) ++e;
+        if (e != end && is_digit(*e)) {
+            for (; e != end && is_digit(*e); ++e)
+                if (exponent < MAX_EXPONENT) exponent = exponent * 10 + (*e - '0');
+            it = e;
+            if (negative) exponent = -exponent;
+        }
+    }
+    d.exponent = exponent - fraction_count;
+    d.q = d.exponent;
+
+    // Only the first 19 significant digits fit in w
+    if (digit_count > 19) {
+        const char* p = d.digits;
+        for (; p != d.digits_end && (*p == '0' || *p == '.'); ++p)
+            digit_count -= *p == '0';
+        if (digit_count > 19) {
+            d.many_digits = true;
+            d.w = 0;
+            i64 n{};
+            for (; n < 19; ++p) {
+                if (*p == '.') continue;
+                d.w = d.w * 10 + u64(*p - '0');
+                ++n;
+            }
+            d.q += digit_count - 19;
+        }
+    }
+    return it;
+}
+
+}
+
+template<typename T>
+parse_result chars_to_float(const char* begin, const char* end, T& value) noexcept
+{
+    static_assert(std::is_same_v<T, f32> || std::is_same_v<T, f64>, "chars_to_float supports f32 and f64");
+    using traits = impl::float_traits<T>;
+    const char* it = begin;
+    const bool negative = it != end && *it == '-';
+    if (it != end && (*it == '-' || *it == '+')) ++it;
+
+    impl::decimal_string d{};
+    const char* last = impl::parse_decimal(it, end, d);
+    if (!last) {
+        last = impl::parse_inf_nan(it, end, negative, value);
+        return last ? parse_result{last} : parse_result{begin, parse_error::invalid};
+    }
+
+    T result{};
+    if (!impl::exact_decimal_to_float(d, result)) {
+        impl::adjusted_mantissa am = impl::eisel_lemire<T>(d.q, d.w);
+        // The digits after the first 19 only matter when they could round differently
+        if (d.many_digits && am != impl::eisel_lemire<T>(d.q, d.w + 1))
+            am = impl::decimal_to_float_slow<T>(d, am);
+        if (am.power2 == traits::BQ_MASK || (am.power2 == 0 && am.mantissa == 0 && d.w != 0))
+            return {last, parse_error::overflow};
+        result = impl::to_float<T>(false, am);
+    }
+    value = negative ? -result : result;
+    return {last};
+}
+
+namespace impl {
+
+// "00" to "99"
+static constexpr char DIGIT_PAIRS[] = 
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Digits of every base, then upper case hex
+static constexpr char DIGIT_CHARS[] = "0123456789abcdefghijklmnopqrstuvwxyz0123456789ABCDEF";
+
+// Two digits of a pair table, lowest value last
+static constexpr auto HEX_PAIRS = []{
+    struct { char data[1024]; } t{};
+    for (u32 i = 0; i < 256; ++i) {
+        t.data[i * 2]           = DIGIT_CHARS[i >> 4];
+        t.data[i * 2 + 1]       = DIGIT_CHARS[i & 15];
+        t.data[512 + i * 2]     = DIGIT_CHARS[36 + (i >> 4)];
+        t.data[512 + i * 2 + 1] = DIGIT_CHARS[36 + (i & 15)];
+    }
+    return t;
+}();
+
+static constexpr auto OCTAL_PAIRS = []{
+    struct { char data[128]; } t{};
+    for (u32 i = 0; i < 64; ++i) {
+        t.data[i * 2]     = char('0' + (i >> 3));
+        t.data[i * 2 + 1] = char('0' + (i & 7));
+    }
+    return t;
+}();
+
+ZEN_FORCEINLINE constexpr void copy_pair(char* p, const char* pair) noexcept {
+    if (ZEN_CONSTANT_EVALUATED()) {
+        p[0] = pair[0];
+        p[1] = pair[1];
     } else {
-        value = 0;
-        constexpr T mult = Base;
-        for (auto it = begin; it != end; ++it) {
-            const auto c = *it;
-            value += T(c - '0');
-            value *= mult;
+        memcpy(p, pair, 2);
+    }
+}
+
+ZEN_FORCEINLINE constexpr void write_pair(char* p, u64 v) noexcept {
+    copy_pair(p, DIGIT_PAIRS + v * 2);
+}
+
+ZEN_FORCEINLINE u64 bswap64(u64 v) noexcept {
+    #ifdef ZEN_COMPILER_MSVC
+        return _byteswap_uint64(v);
+    #else
+        return __builtin_bswap64(v);
+    #endif
+}
+
+// The 8 bits of b as '0'/'1' chars, most significant first, the multiply moves bit i into byte 7 - i
+ZEN_FORCEINLINE void write_binary_byte(char* p, u64 b) noexcept {
+    u64 v = (((b * UINT64_C(0x8040201008040201)) >> 7) & UINT64_C(0x0101010101010101)) | UINT64_C(0x3030303030303030);
+    #if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        v = bswap64(v);
+    #endif
+    memcpy(p, &v, sizeof(v));
+}
+
+// The 8 nibbles of v as hex chars, most significant first
+// Nibbles are spread one per byte, then bytes above 9 get the offset to the letters added
+ZEN_FORCEINLINE void write_hex_word(char* p, u32 v, bool upper) noexcept {
+    u64 x = v;
+    x = (x | (x << 16)) & UINT64_C(0x0000ffff0000ffff);
+    x = (x | (x << 8))  & UINT64_C(0x00ff00ff00ff00ff);
+    x = (x | (x << 4))  & UINT64_C(0x0f0f0f0f0f0f0f0f);
+    const u64 letters = ((x + UINT64_C(0x0606060606060606)) >> 4) & UINT64_C(0x0101010101010101);
+    x += UINT64_C(0x3030303030303030) + letters * (upper ? 7 : 39);
+    #if !defined(__BYTE_ORDER__) || __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        x = bswap64(x);
+    #endif
+    memcpy(p, &x, sizeof(x));
+}
+
+// Writes the decimal digits of v backwards from end, two per division
+template<typename T>
+ZEN_FORCEINLINE constexpr char* write_decimal_backwards(char* end, T v) noexcept {
+    // 32-bit divisions are cheaper, only use 64-bit ones while they are needed
+    if constexpr(sizeof(T) > sizeof(u32)) {
+        while (v >= T(UINT32_MAX)) {
+            const T q = v / 100;
+            write_pair(end -= 2, u64(v - q * 100));
+            v = q;
         }
-        value /= mult;
     }
-    return true;
+    u32 x = u32(v);
+    while (x >= 100) {
+        const u32 q = x / 100;
+        write_pair(end -= 2, x - q * 100);
+        x = q;
+    }
+    if (x >= 10) write_pair(end -= 2, x);
+    else         *--end = char('0' + x);
+    return end;
+}
+
 }
 
 template<usize Base, typename T>
-char* int_to_chars(char* begin, [[maybe_unused]] char* end, const T& value, num::index_t<Base>) noexcept
+constexpr char* int_to_chars(char* begin, [[maybe_unused]] char* end, const T& value, num::index_t<Base>) noexcept
 {
-    auto val = value;
+    constexpr usize BASE = Base & 0xff;
+    static_assert(BASE >= 2 && BASE <= 36, "int_to_chars supports bases 2 to 36");
+    using U = std::make_unsigned_t<T>;
+
+    // Magnitude as unsigned, so the most negative value does not overflow
+    U v = U(value);
     if constexpr(std::is_signed_v<T>) {
-        if (val < 0) { *begin++ = '-'; val = -val; }
+        if (value < 0) { 
+            *begin++ = '-'; 
+            v = U(U(0) - v); 
+        }
+    }
+
+    // The digit count is known up front, so digits go straight to their final place
+    const usize n = impl::count_digits<Base>(v);
+    char* const last = begin + n;
+    if constexpr(BASE == 10) {
+        if constexpr(sizeof(U) > sizeof(u64)) {
+            // 19 digits at a time until the rest fits u64
+            constexpr U CHUNK = U(impl::POW10_U64[19]);
+            char* p = last;
+            while (v > U(UINT64_MAX)) {
+                u64 low = u64(v % CHUNK);
+                v /= CHUNK;
+                for (usize i = 0; i < 9; ++i) {
+                    const u64 q = low / 100;
+                    impl::write_pair(p -= 2, low - q * 100);
+                    low = q;
+                }
+                *--p = char('0' + low);
+            }
+            impl::write_decimal_backwards(p, u64(v));
+        } else {
+            impl::write_decimal_backwards(last, v);
+        }
     }
-    
-    // Super-fast int formatter for base 10 (most common case)
-    if constexpr(Base == 10) {
-        static u16 const str100p[100] = {
-            0x3030, 0x3130, 0x3230, 0x3330, 0x3430, 0x3530, 0x3630, 0x3730, 0x3830, 0x3930,
-            0x3031, 0x3131, 0x3231, 0x3331, 0x3431, 0x3531, 0x3631, 0x3731, 0x3831, 0x3931,
-            0x3032, 0x3132, 0x3232, 0x3332, 0x3432, 0x3532, 0x3632, 0x3732, 0x3832, 0x3932,
-            0x3033, 0x3133, 0x3233, 0x3333, 0x3433, 0x3533, 0x3633, 0x3733, 0x3833, 0x3933,
-            0x3034, 0x3134, 0x3234, 0x3334, 0x3434, 0x3534, 0x3634, 0x3734, 0x3834, 0x3934,
-            0x3035, 0x3135, 0x3235, 0x3335, 0x3435, 0x3535, 0x3635, 0x3735, 0x3835, 0x3935,
-            0x3036, 0x3136, 0x3236, 0x3336, 0x3436, 0x3536, 0x3636, 0x3736, 0x3836, 0x3936,
-            0x3037, 0x3137, 0x3237, 0x3337, 0x3437, 0x3537, 0x3637, 0x3737, 0x3837, 0x3937,
-            0x3038, 0x3138, 0x3238, 0x3338, 0x3438, 0x3538, 0x3638, 0x3738, 0x3838, 0x3938,
-            0x3039, 0x3139, 0x3239, 0x3339, 0x3439, 0x3539, 0x3639, 0x3739, 0x3839, 0x3939, };
-
-        u16 buffer[11];
-        u16 *p = &buffer[10];        
-        while(val >= 100) {
-            const auto old = val;
-            --p;
-            val /= 100;
-            *p = str100p[old - (val * 100)];
-        }
-        *(--p) = str100p[val];
-        const auto* b = reinterpret_cast<const char*>(p) + (val < 10);
-        const auto n = reinterpret_cast<const char*>(buffer + 10) - b;        
-        // assert((end - begin) >= n && "Not enough space to format integer");
-        memcpy(begin, b, n);
-        return begin + n;
-    }
-    // Regular int formatter for other cases
     else {
-        static constexpr T DIVISOR           = Base & 0xff;
-        static constexpr bool USE_UPPER      = DIVISOR == 16 && ((Base & ~UINT64_C(0xff)) == impl::HEX_UPPER);
-        static constexpr char OUTPUT_CHARS[] = "0123456789abcdef0123456789ABCDEF";
-        static constexpr const char* OUTPUT  = &OUTPUT_CHARS[USE_UPPER ? 16 : 0];
-        char buffer[65];
-        char* p = &buffer[64];
-        while (val > 0) {
-            const auto old = val;
-            --p;
-            val /= DIVISOR;
-            *p = OUTPUT[old - (val * DIVISOR)];
+        constexpr bool USE_UPPER = BASE == 16 && ((Base & ~UINT64_C(0xff)) == impl::HEX_UPPER);
+        const char* OUTPUT = impl::DIGIT_CHARS + (USE_UPPER ? 36 : 0);
+        // Whole words of digits, the chars past the last digit are scratch so the output needs room for them
+        if constexpr((BASE == 16 || BASE == 2) && sizeof(U) <= sizeof(u64)) {
+            constexpr usize BITS = BASE == 16 ? 4 : 1;
+            const usize padded = (n + 7) / 8 * 8;
+            if (!ZEN_CONSTANT_EVALUATED() && usize(end - begin) >= padded) {
+                // Significant digits are moved to the top, then written most significant first
+                const u64 x = u64(v) << (64 - n * BITS);
+                if constexpr(BASE == 16) {
+                    impl::write_hex_word(begin, u32(x >> 32), USE_UPPER);
+                    if (n > 8) impl::write_hex_word(begin + 8, u32(x), USE_UPPER);
+                } else {
+                    for (usize i = 0; i < padded; i += 8) impl::write_binary_byte(begin + i, (x >> (56 - i)) & 0xff);
+                }
+                return last;
+            }
+        }
+        char* p = last;
+        if constexpr(po2::check(BASE)) {
+            // Several digits per shift where a table or bit trick covers them, then one at a time
+            constexpr usize SHIFT = ilog2(BASE);
+            usize digits = n;
+            if constexpr(BASE == 16) {
+                const char* pairs = impl::HEX_PAIRS.data + (USE_UPPER ? 512 : 0);
+                for (; digits >= 2; digits -= 2, v >>= 8) impl::copy_pair(p -= 2, pairs + (usize(v) & 0xff) * 2);
+            } else if constexpr(BASE == 8) {
+                for (; digits >= 2; digits -= 2, v >>= 6) impl::copy_pair(p -= 2, impl::OCTAL_PAIRS.data + (usize(v) & 63) * 2);
+            } else if constexpr(BASE == 2) {
+                if (!ZEN_CONSTANT_EVALUATED())
+                    for (; digits >= 8; digits -= 8, v >>= 8) impl::write_binary_byte(p -= 8, u64(v) & 0xff);
+            }
+            for (; digits > 0; --digits, v >>= SHIFT) *--p = OUTPUT[usize(v) & (BASE - 1)];
+        } else {
+            do { const U q = v / BASE; *--p = OUTPUT[usize(v - q * BASE)]; v = q; } while (v != 0);
         }
-        const auto n = buffer + 64 - p;
-        // assert((end - begin) >= n && "Not enough space to format integer");
-        memcpy(begin, p, n);
-        return begin + n;
     }
+    return last;
 }
 
 template<typename T>
 char* float_to_chars(char* begin, char* end, const T& value, usize precision) noexcept
 {
-    char fmt[16]{'%'};
-    char* pfmt = fmt + 1;
-    if (ZEN_UNLIKELY(precision != 0)) {
-        *pfmt++ = '.';
-        pfmt = int_to_chars(pfmt, fmt + sizeof(fmt), precision);
+    static_assert(std::is_same_v<T, f32> || std::is_same_v<T, f64>, "float_to_chars only supports f32 and f64");
+    const usize space = usize(end - begin);
+    if (ZEN_LIKELY(precision == 0)) {
+        if (ZEN_LIKELY(space >= impl::float_traits<T>::MAX_LEN))
+            return impl::shortest_to_chars(begin, value);
+        char tmp[impl::float_traits<T>::MAX_LEN];
+        const usize n = usize(impl::shortest_to_chars(tmp, value) - tmp);
+        memcpy(begin, tmp, n < space ? n : space);
+        return begin + (n < space ? n : space);
+    }
+    if (ZEN_LIKELY(space >= impl::fixed_len_bound(value, precision)))
+        return impl::fixed_to_chars(begin, f64(value), precision);
+    // Not enough space for the worst case, format to the stack and truncate
+    char tmp[impl::fixed_max_len(impl::FIXED_MAX_PRECISION)];
+    const usize clamped = precision < impl::FIXED_MAX_PRECISION ? precision : impl::FIXED_MAX_PRECISION;
+    const usize n = usize(impl::fixed_to_chars(tmp, f64(value), clamped) - tmp);
+    memcpy(begin, tmp, n < space ? n : space);
+    return begin + (n < space ? n : space);
+}
+
+}
+
+// Byte encoding
+namespace fmt {
+
+namespace impl {
+
+#ifdef ZEN_SSE2
+// Nibbles 0-15 to '0'-'9' and 'a'-'f' or 'A'-'F' in each byte
+ZEN_FORCEINLINE __m128i nibbles_to_hex(__m128i v, __m128i letters) noexcept {
+    const __m128i digits = _mm_add_epi8(v, _mm_set1_epi8('0'));
+    return _mm_add_epi8(digits, _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(9)), letters));
+}
+#endif
+
+#ifdef ZEN_AVX2
+ZEN_FORCEINLINE __m256i nibbles_to_hex(__m256i v, __m256i letters) noexcept {
+    const __m256i digits = _mm256_add_epi8(v, _mm256_set1_epi8('0'));
+    return _mm256_add_epi8(digits, _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(9)), letters));
+}
+#endif
+
+// Printable ASCII as is, everything else as '.'
+ZEN_FORCEINLINE char printable(u8 c) noexcept { return c >= 0x20 && c < 0x7f ? char(c) : '.'; }
+
+// One hexdump -C line for up to 16 bytes, at most HEXDUMP_LINE_LEN chars
+static constexpr usize HEXDUMP_LINE_LEN = 16 + 2 + 16 * 3 + 1 + 1 + 16 + 2 + 1;
+
+// Offset, hex bytes in two groups of 8 and the printable chars, padded so the columns line up
+inline char* hexdump_line(char* p, const u8* bytes, usize n, u64 offset, usize offset_digits) noexcept {
+    if (offset_digits == 16) {
+        write_hex_word(p, u32(offset >> 32), false);
+        p += 8;
+    }
+    write_hex_word(p, u32(offset), false);
+    p += 8;
+    *p++ = ' ';
+
+    char hex[32];
+    hex_encode(hex, span<const u8>{bytes, n});
+    for (usize i = 0; i < 16; ++i) {
+        if (i == 0 || i == 8) *p++ = ' ';
+        if (i < n) copy_pair(p, hex + i * 2);
+        else       memset(p, ' ', 2);
+        p[2] = ' ';
+        p += 3;
+    }
+
+    *p++ = ' ';
+    *p++ = '|';
+    #ifdef ZEN_SSE2
+    if (n == 16) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+        // Bytes above 0x7f are negative, so the signed compares also reject them
+        const __m128i ok = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(0x1f)), _mm_cmplt_epi8(x, _mm_set1_epi8(0x7f)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_or_si128(_mm_and_si128(ok, x), _mm_andnot_si128(ok, _mm_set1_epi8('.'))));
+        p += 16;
+    } else
+    #endif
+    {
+        for (usize i = 0; i < n; ++i) *p++ = printable(bytes[i]);
+    }
+    *p++ = '|';
+    *p++ = '\n';
+    return p;
+}
+
+}
+
+inline char* hex_encode(char* out, span<const u8> bytes, bool upper) noexcept
+{
+    const u8* it = bytes.begin();
+    const u8* end = bytes.end();
+    #ifdef ZEN_AVX2
+    {
+        const __m256i letters = _mm256_set1_epi8(upper ? 7 : 39);
+        const __m256i mask = _mm256_set1_epi8(0x0f);
+        for (; end - it >= 32; it += 32, out += 64) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+            const __m256i hi = impl::nibbles_to_hex(_mm256_and_si256(_mm256_srli_epi16(x, 4), mask), letters);
+            const __m256i lo = impl::nibbles_to_hex(_mm256_and_si256(x, mask), letters);
+            // Unpacks interleave within 128-bit lanes, the permutes put the lanes back in order
+            const __m256i a = _mm256_unpacklo_epi8(hi, lo), b = _mm256_unpackhi_epi8(hi, lo);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),      _mm256_permute2x128_si256(a, b, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), _mm256_permute2x128_si256(a, b, 0x31));
+        }
+    }
+    #endif
+    #ifdef ZEN_SSE2
+    {
+        const __m128i letters = _mm_set1_epi8(upper ? 7 : 39);
+        const __m128i mask = _mm_set1_epi8(0x0f);
+        for (; end - it >= 16; it += 16, out += 32) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            const __m128i hi = impl::nibbles_to_hex(_mm_and_si128(_mm_srli_epi16(x, 4), mask), letters);
+            const __m128i lo = impl::nibbles_to_hex(_mm_and_si128(x, mask), letters);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out),      _mm_unpacklo_epi8(hi, lo));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi8(hi, lo));
+        }
+    }
+    #endif
+    for (; end - it >= 4; it += 4, out += 8) 
+        impl::write_hex_word(out, u32(it[0]) << 24 | u32(it[1]) << 16 | u32(it[2]) << 8 | u32(it[3]), upper);
+    const char* pairs = impl::HEX_PAIRS.data + (upper ? 512 : 0);
+    for (; it != end; ++it, out += 2) 
+        impl::copy_pair(out, pairs + usize(*it) * 2);
+    return out;
+}
+
+inline char* binary_encode(char* out, span<const u8> bytes) noexcept
+{
+    const u8* it = bytes.begin();
+    const u8* end = bytes.end();
+    #ifdef ZEN_SSE2
+    {
+        // Each byte is repeated 8 times, then tested against its bit for that position
+        const __m128i bits = _mm_set_epi8(1, 2, 4, 8, 16, 32, 64, char(0x80), 1, 2, 4, 8, 16, 32, 64, char(0x80));
+        const __m128i zero = _mm_set1_epi8('0');
+        const auto store = [&](char* o, __m128i v) {
+            const __m128i set = _mm_cmpeq_epi8(_mm_and_si128(v, bits), bits);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(o), _mm_sub_epi8(zero, set));
+        };
+        for (; end - it >= 16; it += 16, out += 128) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            const __m128i x2[2]{_mm_unpacklo_epi8(x, x), _mm_unpackhi_epi8(x, x)};
+            for (usize i = 0; i < 2; ++i) {
+                const __m128i x4[2]{_mm_unpacklo_epi16(x2[i], x2[i]), _mm_unpackhi_epi16(x2[i], x2[i])};
+                for (usize j = 0; j < 2; ++j) {
+                    store(out + i * 64 + j * 32,      _mm_unpacklo_epi32(x4[j], x4[j]));
+                    store(out + i * 64 + j * 32 + 16, _mm_unpackhi_epi32(x4[j], x4[j]));
+                }
+            }
+        }
+    }
+    #endif
+    for (; it != end; ++it, out += 8) 
+        impl::write_binary_byte(out, *it);
+    return out;
+}
+
+template<typename Derived>
+Derived& sink_ops<Derived>::operator<<(const hexdump& v) noexcept
+{
+    const u64 last = v.offset + (v.bytes.empty() ? 0 : v.bytes.size() - 1);
+    const usize offset_digits = last > UINT32_MAX ? 16 : 8;
+    for (usize i = 0; i < v.bytes.size(); i += 16) {
+        const usize n = v.bytes.size() - i < 16 ? v.bytes.size() - i : 16;
+        char* p = self().reserve(impl::HEXDUMP_LINE_LEN);
+        self().commit(usize(impl::hexdump_line(p, v.bytes.data() + i, n, v.offset + i, offset_digits) - p));
+    }
+    return self();
+}
+
+}
+
+// String escaping
+namespace fmt {
+
+namespace impl {
+
+// Char written after the backslash for ASCII chars the {?:} style escapes, 'x' for \xNN, 0 for chars written as is
+static constexpr auto DEBUG_ESCAPES = []{
+    struct { char data[128]; } t{};
+    for (u32 i = 0; i < 0x20; ++i)
+        t.data[i] = 'x';
+    t.data[0x7f]     = 'x';
+    t.data[u8('\n')] = 'n';
+    t.data[u8('\r')] = 'r';
+    t.data[u8('\t')] = 't';
+    t.data[u8('"')]  = '"';
+    t.data[u8('\\')] = '\\';
+    return t;
+}();
+
+// Chars of a string escaped per reserve, at most 4 chars each, and a valid sequence can end 3 chars past the chunk
+static constexpr usize ESCAPE_CHUNK = 64;
+static constexpr usize ESCAPE_CHUNK_LEN = ESCAPE_CHUNK * 4 + 3 + 2;
+static_assert(ESCAPE_CHUNK_LEN <= MAX_CONVERSION_LEN);
+
+// A char the classifier flagged, well formed UTF-8 is copied as is and anything else is escaped one byte at a time
+ZEN_FORCEINLINE char* escape_one(char* p, const char*& it, const char* end) noexcept {
+    const u8 c = u8(*it);
+    if (c >= 0x80) {
+        if (const usize n = unicode::valid_length(it, usize(end - it)); n > 0) {
+            memcpy(p, it, n);
+            it += n;
+            return p + n;
+        }
+    }
+    ++it;
+    const char e = c < 0x80 ? DEBUG_ESCAPES.data[c] : 'x';
+    p[0] = '\\';
+    p[1] = e;
+    if (e != 'x')
+        return p + 2;
+    copy_pair(p + 2, HEX_PAIRS.data + usize(c) * 2);
+    return p + 4;
+}
+
+// Escapes from it until it reaches limit, p has room for ESCAPE_CHUNK_LEN chars
+// Whole vectors are stored before they are checked, so clean ASCII costs one classification per 16 or 32 chars
+inline char* escape_debug(char* p, const char*& it, const char* limit, const char* end) noexcept {
+    #ifdef ZEN_AVX2
+    {
+        const __m256i control = _mm256_set1_epi8(0x20);
+        const __m256i del = _mm256_set1_epi8(0x7f);
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        while (limit - it >= 32) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+            // Bytes above 0x7f are negative, so the signed compare also flags them for UTF-8 validation
+            const __m256i special = _mm256_or_si256(_mm256_cmpgt_epi8(control, x), _mm256_cmpeq_epi8(x, del));
+            const __m256i bad = _mm256_or_si256(special, _mm256_or_si256(_mm256_cmpeq_epi8(x, quote), _mm256_cmpeq_epi8(x, backslash)));
+            const u32 mask = u32(_mm256_movemask_epi8(bad));
+            if (mask == 0) {
+                it += 32;
+                p += 32;
+                continue;
+            }
+            const usize n = trailing_zeros(mask);
+            it += n;
+            p = escape_one(p + n, it, end);
+        }
+    }
+    #endif
+    #ifdef ZEN_SSE2
+    {
+        const __m128i control = _mm_set1_epi8(0x20);
+        const __m128i del = _mm_set1_epi8(0x7f);
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        while (limit - it >= 16) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p), x);
+            const __m128i special = _mm_or_si128(_mm_cmplt_epi8(x, control), _mm_cmpeq_epi8(x, del));
+            const __m128i bad = _mm_or_si128(special, _mm_or_si128(_mm_cmpeq_epi8(x, quote), _mm_cmpeq_epi8(x, backslash)));
+            const u32 mask = u32(_mm_movemask_epi8(bad));
+            if (mask == 0) {
+                it += 16;
+                p += 16;
+                continue;
+            }
+            const usize n = trailing_zeros(mask);
+            it += n;
+            p = escape_one(p + n, it, end);
+        }
+    }
+    #endif
+    while (it < limit) {
+        const u8 c = u8(*it);
+        if (ZEN_LIKELY(c < 0x80 && DEBUG_ESCAPES.data[c] == 0)) *p++ = *it++;
+        else                                                     p = escape_one(p, it, end);
+    }
+    return p;
+}
+
+}
+
+template<typename Derived>
+Derived& sink_ops<Derived>::operator<<(const escaped& v) noexcept
+{
+    const char* it = v.str.data();
+    const char* end = it + v.str.size();
+    do {
+        const char* limit = usize(end - it) < impl::ESCAPE_CHUNK ? end : it + impl::ESCAPE_CHUNK;
+        char* p = self().reserve(impl::ESCAPE_CHUNK_LEN);
+        char* const start = p;
+        if (it == v.str.data()) *p++ = '"';
+        p = impl::escape_debug(p, it, limit, end);
+        if (it == end) *p++ = '"';
+        self().commit(usize(p - start));
+    } while (it != end);
+    return self();
+}
+
+}
+
+// Timestamps
+namespace fmt {
+
+namespace impl {
+
+// "YYYY-MM-DDTHH:MM:SS.", then up to 9 fraction digits and 'Z'
+static constexpr usize TIMESTAMP_PREFIX_LEN = 20;
+static constexpr usize TIMESTAMP_MAX_LEN = TIMESTAMP_PREFIX_LEN + 9 + 1;
+
+// Prefix of the last second this thread formatted
+struct timestamp_cache {
+    i64  second{num::limits<i64>::min()};
+    char prefix[TIMESTAMP_PREFIX_LEN]{};
+};
+
+inline timestamp_cache& this_timestamp_cache() noexcept {
+    static thread_local timestamp_cache cache{};
+    return cache;
+}
+
+// Writes the n low decimal digits of v with leading zeros
+ZEN_FORCEINLINE void write_fixed_digits(char* p, u32 v, usize n) noexcept {
+    char* it = p + n;
+    for (; it - p >= 2; v /= 100)
+        write_pair(it -= 2, v % 100);
+    if (it != p) 
+        *p = char('0' + v % 10);
+}
+
+// Civil date and time of a second since the Unix epoch, the days to date conversion is from Howard Hinnant's date algorithms
+inline void write_timestamp_prefix(char* p, i64 second) noexcept {
+    const i64 days = second >= 0 ? second / 86400 : (second - 86399) / 86400;
+    const u32 in_day = u32(second - days * 86400);
+    const i64 z = days + 719468;
+    const i64 era = (z >= 0 ? z : z - 146096) / 146097;
+    const u32 doe = u32(z - era * 146097);
+    const u32 yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const u32 doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const u32 mp = (5 * doy + 2) / 153;
+    const u32 day = doy - (153 * mp + 2) / 5 + 1;
+    const u32 month = mp < 10 ? mp + 3 : mp - 9;
+    // Nanoseconds in an i64 only reach years 1677 to 2262, so the year always has 4 digits
+    write_fixed_digits(p, u32(i64(yoe) + era * 400 + (month <= 2)), 4);
+    p[4] = '-';
+    write_pair(p + 5, month);
+    p[7] = '-';
+    write_pair(p + 8, day);
+    p[10] = 'T';
+    write_pair(p + 11, in_day / 3600);
+    p[13] = ':';
+    write_pair(p + 14, in_day / 60 % 60);
+    p[16] = ':';
+    write_pair(p + 17, in_day % 60);
+    p[19] = '.';
+}
+
+// Writes v to p, which has room for TIMESTAMP_MAX_LEN chars
+inline char* write_timestamp(char* p, const timestamp& v) noexcept {
+    const i64 second = v.ns >= 0 ? v.ns / 1000000000 : (v.ns - 999999999) / 1000000000;
+    const u32 fraction = u32(v.ns - second * 1000000000);
+    timestamp_cache& cache = this_timestamp_cache();
+    if (ZEN_UNLIKELY(cache.second != second)) {
+        write_timestamp_prefix(cache.prefix, second);
+        cache.second = second;
+    }
+    memcpy(p, cache.prefix, TIMESTAMP_PREFIX_LEN);
+    p += TIMESTAMP_PREFIX_LEN;
+    switch (v.precision) {
+        case time_precision::seconds:       --p; break;
+        case time_precision::milliseconds:  write_fixed_digits(p, fraction / 1000000, 3); p += 3; break;
+        case time_precision::microseconds:  write_fixed_digits(p, fraction / 1000, 6); p += 6; break;
+        case time_precision::nanoseconds:   write_fixed_digits(p, fraction, 9); p += 9; break;
+    }
+    *p++ = 'Z';
+    return p;
+}
+
+}
+
+inline timestamp timestamp::now(time_precision precision) noexcept
+{
+    timespec ts{};
+    timespec_get(&ts, TIME_UTC);
+    return {i64(ts.tv_sec) * 1000000000 + i64(ts.tv_nsec), precision};
+}
+
+template<typename Derived>
+Derived& sink_ops<Derived>::operator<<(const timestamp& v) noexcept
+{
+    char* p = self().reserve(impl::TIMESTAMP_MAX_LEN);
+    self().commit(usize(impl::write_timestamp(p, v) - p));
+    return self();
+}
+
+}
+
+// Compile-time formatting
+namespace fmt::impl {
+
+// Writes to data, or only counts the chars when data is null
+struct static_writer {
+    char* data{};
+    usize size{};
+
+    constexpr void append(const char* s, usize n) noexcept {
+        if (data != nullptr) for (usize i = 0; i < n; ++i) data[size + i] = s[i];
+        size += n;
+    }
+
+    constexpr void append_n(char c, usize n) noexcept {
+        if (data != nullptr) for (usize i = 0; i < n; ++i) data[size + i] = c;
+        size += n;
+    }
+
+    constexpr static_writer& operator<<(string_view s) noexcept { append(s.data(), s.size()); return *this; }
+};
+
+template<typename T>
+static constexpr bool is_fixed_string = false;
+
+template<usize N>
+static constexpr bool is_fixed_string<fixed_string<N>> = true;
+
+// Same output as format_part for the types static_arg supports
+template<typename T>
+constexpr void static_value(static_writer& out, const spec& s, const T& v) noexcept {
+    char buf[std::is_integral_v<T> ? int_max_len<T, 2>() + 1 : 1]{};
+    string_view prefix{}, value{};
+    if constexpr(std::is_same_v<T, bool>) {
+        value = v ? "true" : "false";
+    } else if constexpr(is_fixed_string<T>) {
+        value = v.view();
+    } else if constexpr(std::is_integral_v<T>) {
+        char* end = buf;
+        switch (s.style) {
+            case 'b': prefix = "0b"; end = int_to_chars<2>(buf, buf + sizeof(buf), v); break;
+            case 'x': prefix = "0x"; end = int_to_chars<16>(buf, buf + sizeof(buf), v); break;
+            case 'X': prefix = "0x"; end = int_to_chars<16 | HEX_UPPER>(buf, buf + sizeof(buf), v); break;
+            case 'o': prefix = "0o"; end = int_to_chars<8>(buf, buf + sizeof(buf), v); break;
+            default:
+                if constexpr(std::is_same_v<T, char>) *end++ = v;
+                else end = int_to_chars<10>(buf, buf + sizeof(buf), v);
+                break;
+        }
+        value = {buf, usize(end - buf)};
+    } else {
+        static_assert(std::is_integral_v<T>, "static_format supports integers, chars, bools and string literals");
     }
-    *pfmt++ = precision ? 'f' : 'g';
-    return begin + snprintf(begin, end - begin, fmt, value);
+    // The prefix goes before the padding, like format_part
+    out << prefix;
+    const usize remaining = value.size() < s.width ? s.width - value.size() : 0;
+    const usize before = s.align == '>' ? remaining : s.align == '^' ? remaining - remaining / 2 : 0;
+    out.append_n(s.fill, before);
+    out << value;
+    out.append_n(s.fill, remaining - before);
 }
 
+// Writes argument index of Args
+template<static_arg... Args>
+constexpr void static_field(static_writer& out, const spec& s, usize index) noexcept {
+    [[maybe_unused]] usize i = 0;
+    ((i++ == index ? static_value(out, s, Args.value) : void()), ...);
+}
+
+// Value of integer argument index of Args for a dynamic width or precision, clamped to [0, max]
+template<static_arg... Args>
+constexpr usize static_dynamic_value(usize index, usize max) noexcept {
+    [[maybe_unused]] usize i = 0;
+    usize out = 0;
+    [[maybe_unused]] auto read = [&](const auto& v) {
+        if constexpr(std::is_integral_v<std::remove_cvref_t<decltype(v)>>) {
+            if constexpr(std::is_signed_v<std::remove_cvref_t<decltype(v)>>) { if (v < 0) return; }
+            out = u64(v) > max ? max : usize(v);
+        }
+    };
+    ((i++ == index ? read(Args.value) : void()), ...);
+    return out;
+}
+
+template<usize N>
+struct static_parts { part data[N]{}; };
+
+// Fields of Fmt, every '{' can start at most one
+template<fixed_string Fmt, static_arg... Args>
+consteval auto parse_static() noexcept {
+    constexpr usize n_args = sizeof...(Args);
+    constexpr arg_kind kinds[n_args + 1]{arg_kind_of<decltype(Args.value)>()...};
+    constexpr usize capacity = [] { usize n = 1; for (char c : Fmt.view()) n += c == '{'; return n; }();
+    static_parts<capacity> parts{};
+    if (const auto* error = parse_format(Fmt.view(), parts.data, capacity, {n_args, kinds, nullptr}))
+        format_error(error);
+    return parts;
+}
+
+// Returns the formatted length, writes the chars to data unless it is null
+template<fixed_string Fmt, static_arg... Args>
+constexpr usize static_format_to(char* data) noexcept {
+    constexpr auto parts = parse_static<Fmt, Args...>();
+    static_writer out{data};
+    const part* p = parts.data;
+    for (; p->arg != ARG_END; ++p) {
+        spec s = p->field;
+        if (s.dynamic & DYNAMIC_WIDTH)     s.width = u16(static_dynamic_value<Args...>(s.width, num::limits<u16>::max()));
+        if (s.dynamic & DYNAMIC_PRECISION) s.precision = u8(static_dynamic_value<Args...>(s.precision, num::limits<u8>::max()));
+        format_literal(out, Fmt.view(), *p);
+        static_field<Args...>(out, s, p->arg);
+    }
+    format_literal(out, Fmt.view(), *p);
+    return out.size;
+}
+
+}
+
+template<fmt::fixed_string Fmt, fmt::static_arg... Args>
+consteval auto fmt::static_format() noexcept
+{
+    constexpr usize n = impl::static_format_to<Fmt, Args...>(nullptr);
+    sstring<n + (n == 0)> out{};
+    out.set_size(impl::static_format_to<Fmt, Args...>(out.data()));
+    return out;
 }
 
 // API impl
 template<typename Out, typename... Args>
-Out& format(Out& out, string_view fmt, Args&&... args) noexcept
+Out& format(Out& out, fmt::format_string<Args...> fmt, Args&&... args) noexcept
 {
-    if constexpr(sizeof...(Args) > 0) {
-        fmt::impl::format(out, fmt, ZEN_FWD(args)...);
+    if constexpr(fmt::impl::is_sink<Out>) {
+        fmt::vformat(out, fmt.str, fmt.parts, fmt::make_args(args...));
     } else {
-        out << fmt;
+        fmt::dynamic_buffer<> tmp{};
+        fmt::vformat(tmp, fmt.str, fmt.parts, fmt::make_args(args...));
+        out << string_view(tmp);
     }
     return out;
 }
 
 
-template<usize BufferSize, typename... Args>
-void print(string_view fmt, Args&&... args) noexcept
+template<typename Out, typename... Args>
+Out& format(Out& out, fmt::runtime_format_string fmt, Args&&... args) noexcept
 {
-    fmt::buffer<BufferSize> out{};
-    format(out, fmt, ZEN_FWD(args)...);
-    fprintf(stdout, "%s", string_view(out).data());
+    if constexpr(fmt::impl::is_sink<Out>) {
+        fmt::vformat(out, fmt, fmt::make_args(args...));
+    } else {
+        fmt::dynamic_buffer<> tmp{};
+        fmt::vformat(tmp, fmt, fmt::make_args(args...));
+        out << string_view(tmp);
+    }
+    return out;
+}
+
+
+template<typename... Args>
+usize fmt::formatted_size(fmt::format_string<Args...> fmt, Args&&... args) noexcept
+{
+    return fmt::impl::formatted_size(fmt.str, fmt.parts, fmt::make_args(args...));
+}
+
+
+// Buffered writer
+namespace fmt {
+
+namespace impl {
+
+// Coarse monotonic milliseconds, cheap enough to read once per message
+inline u64 now_ms() noexcept {
+    #ifdef ZEN_PLATFORM_WINDOWS
+        return GetTickCount64();
+    #else
+        timespec ts{};
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+        return u64(ts.tv_sec) * 1000 + u64(ts.tv_nsec) / 1000000;
+    #endif
+}
+
+// Chunks passed to one writev
+static constexpr usize WRITE_BATCH = 16;
+
+// Writes all the chunks, retrying partial writes and interrupts, other errors drop the output like printf
+inline void write_chunks(int fd, string_view* chunks, usize n) noexcept {
+    #ifdef ZEN_PLATFORM_WINDOWS
+        for (usize i = 0; i < n; ++i) {
+            const char* p = chunks[i].data();
+            usize remaining = chunks[i].size();
+            while (remaining > 0) {
+                const int w = _write(fd, p, unsigned(remaining < 0x40000000 ? remaining : 0x40000000));
+                if (w <= 0) return;
+                p += w;
+                remaining -= usize(w);
+            }
+        }
+    #else
+        for (usize i = 0; i < n; ) {
+            iovec iov[WRITE_BATCH]{};
+            usize count{};
+            for (; i < n && count < WRITE_BATCH; ++i)
+                if (!chunks[i].empty()) iov[count++] = {const_cast<char*>(chunks[i].data()), chunks[i].size()};
+            iovec* it = iov;
+            while (count > 0) {
+                const ssize_t w = ::writev(fd, it, int(count));
+                if (w < 0) {
+                    if (errno == EINTR) continue;
+                    return;
+                }
+                usize done = usize(w);
+                for (; count > 0 && done >= it->iov_len; ++it, --count) 
+                    done -= it->iov_len;
+                if (count > 0) {
+                    it->iov_base = static_cast<char*>(it->iov_base) + done;
+                    it->iov_len -= done;
+                }
+            }
+        }
+    #endif
+}
+
+inline bool is_terminal(int fd) noexcept {
+    #ifdef ZEN_PLATFORM_WINDOWS
+        return _isatty(fd) != 0;
+    #else
+        return isatty(fd) != 0;
+    #endif
+}
+
+}
+
+// Output to a file descriptor that formats whole messages straight into its buffer, print/println use one per thread
+// for stdout and panic one for stderr. A message is begin_message(), writes, then end_message().
+// Unbuffered writers, the default, write every message with one system call when it ends. Buffered ones keep
+// messages until
+//  * the buffer holds at least FLUSH_SIZE chars
+//  * a message ends FLUSH_INTERVAL_MS or more after the oldest buffered one, there is no timer thread
+//  * the fd is a terminal, after every message
+//  * flush() or zen::flush() is called, the process exits or panics, or the thread exits
+// Every live writer is flushed by zen::flush(), panic, assertf failures, exit() and quick_exit() from any thread,
+// without splitting a message another thread is writing. One lock orders the system calls of all writers, so
+// messages of different threads never interleave on a pipe. print_buffered(true) buffers print/println.
+// Output is not synchronized with stdio, mixing it with printf on the same fd can reorder lines
+struct fd_writer : sink_ops<fd_writer> {
+    using sink_ops<fd_writer>::operator<<;
+    using size_type = usize;
+    using value_type = char;
+
+    static constexpr usize FLUSH_SIZE        = 64 * 1024;
+    static constexpr u64   FLUSH_INTERVAL_MS = 50;
+
+    explicit fd_writer(int fd, bool buffered = false) noexcept 
+        : m_fd{fd}, m_terminal{impl::is_terminal(fd)}, m_buffered{buffered} { link(); }
+
+    ~fd_writer() noexcept { 
+        unlink();
+        flush_locked();
+    }
+
+    fd_writer(const fd_writer&) = delete;
+    fd_writer& operator=(const fd_writer&) = delete;
+
+    // Writers for this thread, out() is buffered after print_buffered(true)
+    static fd_writer& out() noexcept { static thread_local fd_writer w{1, false, true}; return w; }
+    static fd_writer& err() noexcept { static thread_local fd_writer w{2}; return w; }
+
+    // Buffers print/println on every thread, off by default since a message can then wait for the next one
+    static void print_buffered(bool on) noexcept { print_buffering().store(on, std::memory_order_relaxed); }
+
+    ZEN_ND int          fd()                const noexcept { return m_fd; }
+    ZEN_ND bool         terminal()          const noexcept { return m_terminal; }
+    ZEN_ND bool         buffered()          const noexcept { return m_buffered || (m_print && print_buffering().load(std::memory_order_relaxed)); }
+    ZEN_ND usize        size()              const noexcept { return m_buf.size(); }
+    ZEN_ND char*        data()                    noexcept { return m_buf.data(); }
+    ZEN_ND const char*  data()              const noexcept { return m_buf.data(); }
+
+    void  append(char c)                      noexcept { m_buf.append(c); }
+    void  append(const char* s, usize n)      noexcept { m_buf.append(s, n); }
+    void  append_n(char c, usize n)           noexcept { m_buf.append_n(c, n); }
+    char* reserve(usize n)                    noexcept { return m_buf.reserve(n); }
+    void  commit(usize n)                     noexcept { m_buf.commit(n); }
+
+    void set_buffered(bool on) noexcept { m_buffered = on; }
+
+    // Starts a message, flush_all() waits for it to end before writing this writer
+    void begin_message() noexcept {
+        m_lock.lock();
+        m_holder.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    }
+
+    // Ends a message, the buffer is only written out between messages so formatting can edit it in place
+    void end_message() noexcept {
+        if (!m_buf.empty()) {
+            const u64 now = impl::now_ms();
+            if (m_complete == 0) m_first_ms = now;
+            m_complete = m_buf.size();
+            if (m_terminal || !buffered() || m_buf.size() >= FLUSH_SIZE || now - m_first_ms >= FLUSH_INTERVAL_MS)
+                flush_locked();
+        }
+        m_holder.store(std::thread::id{}, std::memory_order_relaxed);
+        m_lock.unlock();
+    }
+
+    // Writes a complete message
+    void write(string_view s) noexcept {
+        begin_message();
+        m_buf.append(s.data(), s.size());
+        end_message();
+    }
+
+    // Call between messages
+    void flush() noexcept {
+        std::lock_guard lock{m_lock};
+        flush_locked();
+    }
+
+    // Writes the ended messages of every live writer, a message this thread is in the middle of stays buffered
+    static void flush_all() noexcept {
+        registry& r = writers();
+        std::lock_guard lock{r.lock};
+        for (fd_writer* w = r.head; w != nullptr; w = w->m_next) {
+            if (w->m_holder.load(std::memory_order_relaxed) == std::this_thread::get_id()) {
+                w->flush_complete();
+            } else {
+                std::lock_guard writer_lock{w->m_lock};
+                w->flush_locked();
+            }
+        }
+    }
+
+private:
+    // Live writers, locked before any writer's m_lock
+    struct registry {
+        std::mutex  lock{};
+        fd_writer*  head{};
+    };
+
+    fd_writer(int fd, bool buffered, bool print) noexcept : fd_writer{fd, buffered} { m_print = print; }
+
+    static registry& writers() noexcept {
+        static registry r{};
+        static const bool hooked = (std::atexit(flush_all), std::at_quick_exit(flush_all), true);
+        (void)hooked;
+        return r;
+    }
+
+    static std::atomic<bool>& print_buffering() noexcept { static std::atomic<bool> on{false}; return on; }
+
+    // Orders the system calls of every writer, so messages from different threads never interleave
+    static std::mutex& write_lock() noexcept { static std::mutex m{}; return m; }
+
+    void link() noexcept {
+        registry& r = writers();
+        std::lock_guard lock{r.lock};
+        m_next = r.head;
+        if (r.head != nullptr) r.head->m_prev = this;
+        r.head = this;
+    }
+
+    void unlink() noexcept {
+        registry& r = writers();
+        std::lock_guard lock{r.lock};
+        if (m_prev != nullptr) m_prev->m_next = m_next;
+        else                   r.head = m_next;
+        if (m_next != nullptr) m_next->m_prev = m_prev;
+    }
+
+    void write_out(usize n) noexcept {
+        string_view chunk{m_buf.data(), n};
+        std::lock_guard lock{write_lock()};
+        impl::write_chunks(m_fd, &chunk, 1);
+    }
+
+    void flush_locked() noexcept {
+        if (!m_buf.empty()) 
+            write_out(m_buf.size());
+        m_buf.clear();
+        m_complete = 0;
+    }
+
+    // Writes the ended messages and keeps the one being formatted
+    void flush_complete() noexcept {
+        if (m_complete == 0) 
+            return;
+        write_out(m_complete);
+        const usize rest = m_buf.size() - m_complete;
+        memmove(m_buf.data(), m_buf.data() + m_complete, rest);
+        m_buf.clear();
+        m_buf.commit(rest);
+        m_complete = 0;
+    }
+
+    dynamic_buffer<4096>         m_buf{};
+    int                          m_fd{};
+    bool                         m_terminal{};
+    bool                         m_buffered{};
+    bool                         m_print{};         // out(), buffered by print_buffered()
+    usize                        m_complete{};      // Chars of the buffer in ended messages
+    u64                          m_first_ms{};
+    std::mutex                   m_lock{};          // Held from begin_message() to end_message()
+    std::atomic<std::thread::id> m_holder{};
+    fd_writer*                   m_next{};
+    fd_writer*                   m_prev{};
+};
+
+}
+
+
+// Scatter-gather sink
+namespace fmt {
+
+// Strings of at least ref_min chars are kept by reference, everything else is copied into an arena
+// The output is the arena split at each referenced string, see chunks(), and write() sends it with writev
+// Referenced strings must stay alive until the output is written, data() and size() only cover the arena
+//
+//  fmt::gather_sink<> out{};
+//  zen::format(out, "HTTP/1.1 200 OK\r\nContent-Length: {}\r\n\r\n{}", body.size(), body);    // body is not copied
+//  out.write(fd);
+template<usize N>
+struct gather_sink : sink_ops<gather_sink<N>> {
+    using sink_ops<gather_sink>::operator<<;
+    using size_type = usize;
+    using value_type = char;
+
+    static constexpr usize DEFAULT_REF_MIN = 256;
+    static constexpr usize INLINE_REFS     = 8;
+
+    explicit gather_sink(usize ref_min = DEFAULT_REF_MIN, alloc_t<> alloc = std::pmr::get_default_resource()) noexcept
+        : m_arena{alloc}, m_alloc{alloc}, m_ref_min{ref_min} {}
+
+    gather_sink(const gather_sink&) = delete;
+    gather_sink& operator=(const gather_sink&) = delete;
+
+    ~gather_sink() noexcept { reset_refs(); }
+
+    ZEN_ND usize        size()          const noexcept { return m_arena.size(); }
+    ZEN_ND char*        data()                noexcept { return m_arena.data(); }
+    ZEN_ND const char*  data()          const noexcept { return m_arena.data(); }
+    ZEN_ND usize        ref_min()       const noexcept { return m_ref_min; }
+    ZEN_ND usize        ref_count()     const noexcept { return m_n_refs; }
+
+    // Chars of the whole output, the arena and every referenced string
+    ZEN_ND usize        total_size()    const noexcept { return m_arena.size() + m_ref_size; }
+
+    // Most chunks that chunks() and iovecs() can write
+    ZEN_ND usize        max_chunks()    const noexcept { return 2 * m_n_refs + 1; }
+
+    // Starts the next output, keeping the memory of the arena and the references
+    void clear() noexcept { 
+        m_arena.clear();
+        m_n_refs = 0;
+        m_ref_size = 0;
+    }
+
+    void  append(char c)                  noexcept { m_arena.append(c); }
+    void  append_n(char c, usize n)       noexcept { m_arena.append_n(c, n); }
+    char* reserve(usize n)                noexcept { return m_arena.reserve(n); }
+    void  commit(usize n)                 noexcept { m_arena.commit(n); }
+
+    void append(const char* s, usize n) noexcept {
+        if (ZEN_LIKELY(n < m_ref_min)) {
+            m_arena.append(s, n);
+            return;
+        }
+        if (ZEN_UNLIKELY(m_n_refs == m_ref_cap)) 
+            grow_refs();
+        m_refs[m_n_refs++] = {m_arena.size(), s, n};
+        m_ref_size += n;
+    }
+
+    // Writes the output in order to out, which has room for max_chunks(), empty chunks are skipped
+    // Returns the number of chunks written
+    usize chunks(string_view* out) const noexcept {
+        usize n{};
+        for_each_chunk([&](string_view c) { out[n++] = c; });
+        return n;
+    }
+
+#ifndef ZEN_PLATFORM_WINDOWS
+    // Same as chunks() as iovecs for writev
+    usize iovecs(iovec* out) const noexcept {
+        usize n{};
+        for_each_chunk([&](string_view c) { out[n++] = {const_cast<char*>(c.data()), c.size()}; });
+        return n;
+    }
+#endif
+
+    // Writes the output to fd with one writev per impl::WRITE_BATCH chunks, errors drop the output like fd_writer
+    void write(int fd) const noexcept {
+        string_view batch[impl::WRITE_BATCH];
+        usize n{};
+        for_each_chunk([&](string_view c) {
+            batch[n++] = c;
+            if (n == impl::WRITE_BATCH) { 
+                impl::write_chunks(fd, batch, n); 
+                n = 0; 
+            }
+        });
+        if (n > 0) 
+            impl::write_chunks(fd, batch, n);
+    }
+
+private:
+    // A referenced string, written after the arena chars before offset
+    struct ref {
+        usize       offset;
+        const char* data;
+        usize       size;
+    };
+
+    template<typename F>
+    void for_each_chunk(F&& f) const noexcept {
+        usize offset{};
+        for (usize i = 0; i < m_n_refs; ++i) {
+            const ref& r = m_refs[i];
+            if (r.offset > offset) 
+                f(string_view{m_arena.data() + offset, r.offset - offset});
+            f(string_view{r.data, r.size});
+            offset = r.offset;
+        }
+        if (m_arena.size() > offset) 
+            f(string_view{m_arena.data() + offset, m_arena.size() - offset});
+    }
+
+    void grow_refs() noexcept {
+        const usize cap = m_ref_cap * 2;
+        ref* mem = alloc_t<ref>{m_alloc}.allocate(cap);
+        memcpy(static_cast<void*>(mem), m_refs, m_n_refs * sizeof(ref));
+        reset_refs();
+        m_refs = mem;
+        m_ref_cap = cap;
+    }
+
+    void reset_refs() noexcept {
+        if (m_refs != m_inline_refs) 
+            alloc_t<ref>{m_alloc}.deallocate(m_refs, m_ref_cap);
+        m_refs = m_inline_refs;
+        m_ref_cap = INLINE_REFS;
+    }
+
+    dynamic_buffer<N> m_arena;
+    alloc_t<>         m_alloc{};
+    usize             m_ref_min{};
+    ref*              m_refs{m_inline_refs};
+    usize             m_n_refs{};
+    usize             m_ref_cap{INLINE_REFS};
+    usize             m_ref_size{};
+    ref               m_inline_refs[INLINE_REFS];
+};
+
 }
 
 
 template<usize BufferSize, typename... Args>
-void println(string_view fmt, Args&&... args) noexcept
+void print(fmt::format_string<Args...> fmt, Args&&... args) noexcept
 {
-    fmt::buffer<BufferSize> out{};
+    auto& out = fmt::fd_writer::out();
+    out.begin_message();
     format(out, fmt, ZEN_FWD(args)...);
-    fprintf(stdout, "%s\n", string_view(out).data());
+    out.end_message();
 }
 
 
 template<usize BufferSize, typename... Args>
-void panic(string_view fmt, Args&&... args) noexcept
+void println(fmt::format_string<Args...> fmt, Args&&... args) noexcept
 {
-    fmt::buffer<BufferSize> out{};
+    auto& out = fmt::fd_writer::out();
+    out.begin_message();
     format(out, fmt, ZEN_FWD(args)...);
-    fprintf(stderr, "%s\n", string_view(out).data());
+    out.append('\n');
+    out.end_message();
+}
+
+
+namespace fmt::impl {
+
+// The one panic handler, every panic instantiation only packs its arguments
+ZEN_NORETURN ZEN_COLD ZEN_NEVERINLINE void vpanic(string_view fmt, const part* parts, span<const arg> args) noexcept
+{
+    fd_writer::flush_all();
+    auto& err = fd_writer::err();
+    err.begin_message();
+    vformat(err, fmt, parts, args);
+    err.append('\n');
+    err.end_message();
     exit(1);
 }
 
+}
+
+template<usize BufferSize, typename... Args>
+ZEN_NORETURN ZEN_COLD ZEN_NEVERINLINE void panic(fmt::format_string<Args...> fmt, Args&&... args) noexcept
+{
+    fmt::impl::vpanic(fmt.str, fmt.parts, fmt::make_args(args...));
+}
+
+
+inline void flush() noexcept
+{
+    fmt::fd_writer::flush_all();
+}
+
 
 // Generic output operators for containers
 template<typename Out, typename T0, typename T1>
@@ -494,7 +3020,7 @@ Out& operator<<(Out& o, const pair<T0, T1>& v) noexcept {
     return o << '{' << v.first << ", " << v.second << '}';
 }
 
-template<typename Out, typename T, typename = std::void_t<decltype(std::declval<T>().begin() == std::declval<T>().end())>>
+template<typename Out, typename T, typename>
 Out& operator<<(Out& o, const T& v) noexcept {    
     if constexpr(std::is_constructible_v<T, const char*>) {
         return o << string_view{v.data(), v.size()};        
@@ -0,0 +1,676 @@
+#ifndef ZEN_FMT_FLOAT_H
+#define ZEN_FMT_FLOAT_H
+
+#include "zen_fmt_tables.h"
+#include "zen_bit.h"
+#include <cfloat>
+#include <cstring>
+
+#if defined(ZEN_COMPILER_MSVC) && !defined(ZEN_INT128)
+#include <intrin.h>
+#endif
+
+// Float <-> chars algorithms used by zen_fmt.h
+//  * Shortest round-trip formatting (Schubfach, R. Giulietti "The Schubfach way to render doubles")
+//  * Exact fixed precision formatting (big integer digit generation)
+//  * Correctly rounded parsing (Eisel-Lemire, D. Lemire "Number Parsing at a Gigabyte per Second",
+//    with a big integer comparison against the halfway point when the input has too many digits)
+namespace zen::fmt::impl {
+
+// High 64 bits of a 64x64 bit product
+ZEN_FORCEINLINE u64 umul_hi(u64 a, u64 b) noexcept {
+    #if defined(ZEN_INT128)
+        return u64((u128(a) * b) >> 64);
+    #else
+        return __umulh(a, b);
+    #endif
+}
+
+// Full 64x64 bit product, returns the low 64 bits
+ZEN_FORCEINLINE u64 umul128(u64 a, u64 b, u64& hi) noexcept {
+    #if defined(ZEN_INT128)
+        const u128 r = u128(a) * b;
+        hi = u64(r >> 64);
+        return u64(r);
+    #else
+        return _umul128(a, b, &hi);
+    #endif
+}
+
+constexpr int flog10pow2(int q) noexcept                  { return int((i64(q) * 661971961083) >> 41); }
+constexpr int flog10_three_quarters_pow2(int q) noexcept  { return int((i64(q) * 661971961083 - 274743187321) >> 41); }
+constexpr int flog2pow10(int e) noexcept                  { return int((i64(e) * 913124641741) >> 38); }
+
+
+// IEEE-754 binary32/binary64 layout
+template<typename T>
+struct float_traits;
+
+template<>
+struct float_traits<f64> {
+    using bits_type = u64;
+    static constexpr int       P       = 53;
+    static constexpr int       Q_MIN   = -1074;
+    static constexpr int       BQ_MASK = 0x7ff;
+    static constexpr bits_type C_MIN   = bits_type(1) << (P - 1);
+    static constexpr bits_type T_MASK  = C_MIN - 1;
+    static constexpr usize     DIGITS  = 17;
+    static constexpr usize     MAX_LEN = 24;   // -2.2250738585072014e-308
+    static constexpr int       POW10_MIN       = -342;  // w * 10^q is always 0 below
+    static constexpr int       POW10_MAX       = 308;   // w * 10^q is always inf above
+    static constexpr int       ROUND_EVEN_MIN  = -4;    // w * 10^q can only be a tie in this range
+    static constexpr int       ROUND_EVEN_MAX  = 23;
+    static constexpr int       EXACT_POW10_MAX = 22;    // 10^q and w are exact, so w * 10^q is correctly rounded
+    static constexpr u64       EXACT_W_MAX     = u64(1) << P;
+};
+
+template<>
+struct float_traits<f32> {
+    using bits_type = u32;
+    static constexpr int       P       = 24;
+    static constexpr int       Q_MIN   = -149;
+    static constexpr int       BQ_MASK = 0xff;
+    static constexpr bits_type C_MIN   = bits_type(1) << (P - 1);
+    static constexpr bits_type T_MASK  = C_MIN - 1;
+    static constexpr usize     DIGITS  = 9;
+    static constexpr usize     MAX_LEN = 15;   // -1.17549435e-38
+    static constexpr int       POW10_MIN       = -64;
+    static constexpr int       POW10_MAX       = 38;
+    static constexpr int       ROUND_EVEN_MIN  = -17;
+    static constexpr int       ROUND_EVEN_MAX  = 10;
+    static constexpr int       EXACT_POW10_MAX = 10;
+    static constexpr u64       EXACT_W_MAX     = u64(1) << P;
+};
+
+
+// Decimal floating point value f * 10^e
+struct decimal_fp {
+    u64 f{};
+    int e{};
+};
+
+
+// Shortest decimal in the rounding interval of c * 2^q
+template<typename T>
+inline decimal_fp schubfach(int q, typename float_traits<T>::bits_type c) noexcept {
+    using traits = float_traits<T>;
+    const u64 out = c & 1;
+    const u64 cb  = u64(c) << 2;
+    const u64 cbr = cb + 2;
+    u64 cbl{};
+    int k{};
+    if (c != traits::C_MIN || q == traits::Q_MIN) {
+        cbl = cb - 2;
+        k = flog10pow2(q);
+    } else {
+        cbl = cb - 1;
+        k = flog10_three_quarters_pow2(q);
+    }
+
+    const u64* g = &SCHUBFACH_G[2 * (k - SCHUBFACH_K_MIN)];
+    u64 vb{}, vbl{}, vbr{};
+    if constexpr(std::is_same_v<T, f64>) {
+        static constexpr u64 MASK_63 = (u64(1) << 63) - 1;
+        const auto rop = [g1 = g[0], g0 = g[1]](u64 cp) noexcept {
+            const u64 x1  = umul_hi(g0, cp);
+            const u64 y0  = g1 * cp;
+            const u64 y1  = umul_hi(g1, cp);
+            const u64 z   = (y0 >> 1) + x1;
+            const u64 vbp = y1 + (z >> 63);
+            return vbp | (((z & MASK_63) + MASK_63) >> 63);
+        };
+        const int h = q + flog2pow10(-k) + 2;
+        vb = rop(cb << h); vbl = rop(cbl << h); vbr = rop(cbr << h);
+    } else {
+        static constexpr u64 MASK_32 = (u64(1) << 32) - 1;
+        const auto rop = [g1 = g[0] + 1](u64 cp) noexcept {
+            const u64 x1  = umul_hi(g1, cp);
+            const u64 vbp = x1 >> 31;
+            return vbp | (((x1 & MASK_32) + MASK_32) >> 32);
+        };
+        const int h = q + flog2pow10(-k) + 33;
+        vb = rop(cb << h); vbl = rop(cbl << h); vbr = rop(cbr << h);
+    }
+
+    // Unlike the Java reference, one digit results are allowed, shortest means fewest characters
+    const u64 s = vb >> 2;
+    if (s >= 10) {
+        const u64 sp10 = 10 * umul_hi(s, u64(115292150460684698) << 4);
+        const u64 tp10 = sp10 + 10;
+        const bool upin = vbl + out <= (sp10 << 2);
+        const bool wpin = (tp10 << 2) + out <= vbr;
+        if (upin != wpin)
+            return {upin ? sp10 : tp10, k};
+    }
+    const u64 t = s + 1;
+    const bool uin = vbl + out <= (s << 2);
+    const bool win = (t << 2) + out <= vbr;
+    if (uin != win)
+        return {uin ? s : t, k};
+    const i64 cmp = i64(vb - ((s + t) << 1));
+    return {(cmp < 0 || (cmp == 0 && (s & 1) == 0)) ? s : t, k};
+}
+
+
+// Writes the digits of f backwards ending at p, returns the first digit
+ZEN_FORCEINLINE char* write_digits_backwards(char* p, u64 f) noexcept {
+    do { *--p = char('0' + f % 10); f /= 10; } while (f != 0);
+    return p;
+}
+
+// Little endian 32-bit limbs, just enough arithmetic for exact decimal conversion
+template<usize MaxLimbs = 40>
+struct bigint {
+    static constexpr usize MAX_LIMBS = MaxLimbs;
+    u32   limbs[MAX_LIMBS];     // only [0, size) is initialized
+    usize size{};
+
+    // value = m * 2^shift
+    bigint(u64 m, usize shift) noexcept {
+        const usize w = shift / 32, b = shift % 32;
+        memset(limbs, 0, w * sizeof(u32));
+        size = w;
+        const u64 lo = (m << b);
+        const u64 hi = b ? (m >> (64 - b)) : 0;
+        limbs[size++] = u32(lo);
+        limbs[size++] = u32(lo >> 32);
+        limbs[size++] = u32(hi);
+        trim();
+    }
+
+    bigint(const bigint& other) noexcept : size{other.size} { memcpy(limbs, other.limbs, size * sizeof(u32)); }
+
+    ZEN_FORCEINLINE void trim() noexcept { while (size > 0 && limbs[size - 1] == 0) --size; }
+    ZEN_ND ZEN_FORCEINLINE bool zero() const noexcept { return size == 0; }
+
+    // this = this / d, returns the remainder
+    u32 divmod(u32 d) noexcept {
+        u64 rem{};
+        for (usize i = size; i-- > 0;) {
+            const u64 cur = (rem << 32) | limbs[i];
+            limbs[i] = u32(cur / d);
+            rem = cur % d;
+        }
+        trim();
+        return u32(rem);
+    }
+
+    // this = this * m + a
+    void mul(u32 m, u32 a = 0) noexcept {
+        u64 carry{a};
+        for (usize i = 0; i < size; ++i) {
+            const u64 cur = u64(limbs[i]) * m + carry;
+            limbs[i] = u32(cur);
+            carry = cur >> 32;
+        }
+        if (carry) limbs[size++] = u32(carry);
+    }
+
+    // this = this * 5^n
+    void mul_pow5(usize n) noexcept {
+        static constexpr u32 POW5[14] = { 1, 5, 25, 125, 625, 3125, 15625, 78125, 390625, 1953125, 
+            9765625, 48828125, 244140625, 1220703125 };
+        for (; n >= 13; n -= 13) mul(POW5[13]);
+        if (n > 0) mul(POW5[n]);
+    }
+
+    // this = this * 2^n
+    void shl(usize n) noexcept {
+        if (zero()) return;
+        const usize w = n / 32, b = n % 32;
+        if (b != 0) {
+            u32 carry{};
+            for (usize i = 0; i < size; ++i) {
+                const u32 cur = limbs[i];
+                limbs[i] = (cur << b) | carry;
+                carry = cur >> (32 - b);
+            }
+            if (carry) limbs[size++] = carry;
+        }
+        if (w != 0) {
+            memmove(limbs + w, limbs, size * sizeof(u32));
+            memset(limbs, 0, w * sizeof(u32));
+            size += w;
+        }
+    }
+
+    // Removes and returns the bits at or above bit n
+    u32 split(usize n) noexcept {
+        const usize w = n / 32, b = n % 32;
+        u64 high{};
+        for (usize i = size; i-- > w;)
+            high = (high << 32) | limbs[i];
+        const u32 result = u32(high >> b);
+        if (w < size) {
+            limbs[w] &= b ? (u32(1) << b) - 1 : 0;
+            size = w + 1;
+        }
+        trim();
+        return result;
+    }
+
+    // Compares this with 2^n
+    ZEN_ND int compare_pow2(usize n) const noexcept {
+        const usize w = n / 32, b = n % 32;
+        if (size != w + 1) return size < w + 1 ? -1 : 1;
+        const u32 top = u32(1) << b;
+        if (limbs[w] != top) return limbs[w] < top ? -1 : 1;
+        for (usize i = 0; i < w; ++i)
+            if (limbs[i] != 0) return 1;
+        return 0;
+    }
+
+    ZEN_ND int compare(const bigint& other) const noexcept {
+        if (size != other.size) return size < other.size ? -1 : 1;
+        for (usize i = size; i-- > 0;)
+            if (limbs[i] != other.limbs[i]) return limbs[i] < other.limbs[i] ? -1 : 1;
+        return 0;
+    }
+};
+
+// Adds one to the decimal digits [begin, end) skipping the point, returns true if it carries out
+inline bool round_up_digits(char* begin, char* end) noexcept {
+    for (char* it = end; it-- != begin;) {
+        if (*it == '.') continue;
+        if (*it != '9') { ++*it; return false; }
+        *it = '0';
+    }
+    return true;
+}
+
+// Exact value rounded half-to-even to precision digits after the point, like printf("%.*f")
+// p must have room for fixed_max_len(value, precision) chars
+inline char* fixed_to_chars(char* p, f64 value, usize precision) noexcept {
+    u64 bits{};
+    memcpy(&bits, &value, sizeof(f64));
+    const int bq = int(bits >> 52) & 0x7ff;
+    const u64 t = bits & ((u64(1) << 52) - 1);
+    if (bits >> 63) *p++ = '-';
+    if (ZEN_UNLIKELY(bq == 0x7ff)) {
+        memcpy(p, t != 0 ? "nan" : "inf", 3);
+        return p + 3;
+    }
+
+    // value = m * 2^e
+    const u64 m = bq ? (t | (u64(1) << 52)) : t;
+    const int e = bq ? bq - 1075 : -1074;
+    char* const first = p;
+
+    // Integer part
+    if (e >= 0 && e <= 11) {
+        p = write_digits_backwards(p + 20, m << e);
+        memmove(first, p, usize(first + 20 - p));
+        p = first + (first + 20 - p);
+    } else if (e > 11) {
+        bigint<> whole{m, usize(e)};
+        u32 chunks[40]{};
+        usize n{};
+        while (!whole.zero()) chunks[n++] = whole.divmod(1000000000);
+        char* q = write_digits_backwards(p + 10, chunks[--n]);
+        memmove(p, q, usize(p + 10 - q));
+        p += p + 10 - q;
+        while (n > 0) {
+            memset(p, '0', 9);
+            write_digits_backwards(p + 9, chunks[--n]);
+            p += 9;
+        }
+    } else if (-e < 64 && (m >> -e) != 0) {
+        const u64 whole = m >> -e;
+        char* q = write_digits_backwards(p + 20, whole);
+        memmove(p, q, usize(p + 20 - q));
+        p += p + 20 - q;
+    } else {
+        *p++ = '0';
+    }
+
+    // Fraction part
+    bool round_up{};
+    if (precision > 0) *p++ = '.';
+    if (e >= 0) {
+        memset(p, '0', precision);
+        p += precision;
+    } else if (-e <= 60) {
+        const usize s = usize(-e);
+        const u64 mask = (u64(1) << s) - 1;
+        u64 frac = m & mask;
+        for (usize i = 0; i < precision; ++i) {
+            if (frac == 0) { memset(p, '0', precision - i); p += precision - i; break; }
+            frac *= 10;
+            *p++ = char('0' + (frac >> s));
+            frac &= mask;
+        }
+        const u64 half = u64(1) << (s - 1);
+        round_up = frac > half || (frac == half && ((p[-1] == '.' ? p[-2] : p[-1]) & 1));
+    } else {
+        const usize s = usize(-e);
+        bigint<> frac{m, 0};
+        frac.split(s);
+        for (usize i = 0; i < precision; ++i) {
+            if (frac.zero()) { memset(p, '0', precision - i); p += precision - i; break; }
+            frac.mul(10);
+            *p++ = char('0' + frac.split(s));
+        }
+        const int cmp = frac.compare_pow2(s - 1);
+        round_up = cmp > 0 || (cmp == 0 && ((p[-1] == '.' ? p[-2] : p[-1]) & 1));
+    }
+
+    if (round_up && round_up_digits(first, p)) {
+        memmove(first + 1, first, usize(p - first));
+        *first = '1';
+        ++p;
+    }
+    return p;
+}
+
+// Upper bound of the length of fixed_to_chars, digits after the 1074th are always zero
+static constexpr usize FIXED_MAX_PRECISION = 1074;
+
+constexpr usize fixed_max_len(usize precision) noexcept {
+    return 1 + 309 + 1 + 1 + precision;
+}
+
+// Upper bound of the length of fixed_to_chars for this value, from its binary exponent
+template<typename T>
+inline usize fixed_len_bound(T value, usize precision) noexcept {
+    using traits = float_traits<T>;
+    typename traits::bits_type bits{};
+    memcpy(&bits, &value, sizeof(T));
+    const int e2 = (int(bits >> (traits::P - 1)) & traits::BQ_MASK) - traits::BQ_MASK / 2;
+    // Sign, integer digits plus one for a carry when rounding, point and fraction, or inf/nan
+    // fixed_to_chars writes small integer parts backwards from 20 chars ahead
+    const usize digits = e2 >= 0 ? usize(((e2 + 1) * 1233) >> 12) + 2 : 2;
+    return 1 + (digits > 20 ? digits : 20) + 1 + precision;
+}
+
+// Writes f * 10^e in the shortest of fixed or scientific notation (fixed on ties), like std::to_chars
+// Fixed notation that needs trailing zeros prints the exact integer value instead
+template<usize MaxDigits>
+inline char* write_decimal(char* p, decimal_fp v, f64 exact) noexcept {
+    while (v.f % 10 == 0) { v.f /= 10; ++v.e; }
+
+    // Digits are written one char to the right, so the first digit can be followed by a point
+    char* const first = p + 1;
+    char* const last = first + MaxDigits;
+    const char* digits = write_digits_backwards(last, v.f);
+    const int n = int(last - digits);
+    memmove(first, digits, usize(n));
+
+    const int sci_exp = v.e + n - 1;
+    const int sci_len = n + (n > 1) + 2 + (sci_exp <= -100 || sci_exp >= 100 ? 3 : 2);
+    const int fix_len = v.e >= 0 ? n + v.e : (n > -v.e ? n + 1 : 2 - v.e);
+
+    if (fix_len <= sci_len) {
+        if (v.e > 0) {
+            return fixed_to_chars(p, exact, 0);
+        } else if (v.e == 0) {
+            memmove(p, first, usize(n));
+        } else if (n > -v.e) {
+            const int whole = n + v.e;
+            memmove(p, first, usize(whole));
+            p[whole] = '.';
+        } else {
+            const int zeros = -v.e - n;
+            memmove(p + 2 + zeros, first, usize(n));
+            p[0] = '0';
+            p[1] = '.';
+            memset(p + 2, '0', usize(zeros));
+        }
+        return p + fix_len;
+    }
+
+    p[0] = p[1];
+    p[1] = '.';
+    p += n + (n > 1);
+    *p++ = 'e';
+    *p++ = sci_exp < 0 ? '-' : '+';
+    u32 x = u32(sci_exp < 0 ? -sci_exp : sci_exp);
+    if (x >= 100) { *p++ = char('0' + x / 100); x %= 100; }
+    *p++ = char('0' + x / 10);
+    *p++ = char('0' + x % 10);
+    return p;
+}
+
+// Shortest representation that round-trips, p must have room for float_traits<T>::MAX_LEN chars
+template<typename T>
+inline char* shortest_to_chars(char* p, T value) noexcept {
+    using traits = float_traits<T>;
+    using bits_type = typename traits::bits_type;
+    bits_type bits{};
+    memcpy(&bits, &value, sizeof(T));
+
+    const bits_type t = bits & traits::T_MASK;
+    const int bq = int(bits >> (traits::P - 1)) & traits::BQ_MASK;
+    const bool negative = (bits >> (sizeof(T) * 8 - 1)) != 0;
+
+    if (ZEN_UNLIKELY(bq == traits::BQ_MASK)) {
+        if (negative) *p++ = '-';
+        memcpy(p, t != 0 ? "nan" : "inf", 3);
+        return p + 3;
+    }
+    if (negative) *p++ = '-';
+    if (bq != 0) {
+        const int mq = -traits::Q_MIN + 1 - bq;
+        const bits_type c = traits::C_MIN | t;
+        // Integers are printed as they are
+        if (0 < mq && mq < traits::P) {
+            const bits_type f = c >> mq;
+            if ((f << mq) == c)
+                return write_decimal<traits::DIGITS>(p, {u64(f), 0}, f64(negative ? -value : value));
+        }
+        return write_decimal<traits::DIGITS>(p, schubfach<T>(-mq, c), f64(negative ? -value : value));
+    }
+    if (t != 0)
+        return write_decimal<traits::DIGITS>(p, schubfach<T>(traits::Q_MIN, t), 0.0);
+    *p++ = '0';
+    return p;
+}
+
+
+// Decimal number as parsed from a string, w * 10^q where w holds the first 19 significant digits
+struct decimal_string {
+    u64         w{};
+    i64         q{};
+    bool        many_digits{};  // w was truncated, the digits are needed for exact rounding
+    const char* digits{};       // [digits, digits_end) are the digits, including a '.'
+    const char* digits_end{};
+    i64         exponent{};     // exponent of the last digit in [digits, digits_end)
+};
+
+// Binary float fields, power2 is the biased exponent
+struct adjusted_mantissa {
+    u64 mantissa{};
+    int power2{};
+
+    constexpr bool operator==(const adjusted_mantissa& o) const noexcept { return mantissa == o.mantissa && power2 == o.power2; }
+    constexpr bool operator!=(const adjusted_mantissa& o) const noexcept { return !(*this == o); }
+};
+
+template<typename T>
+ZEN_FORCEINLINE T to_float(bool negative, adjusted_mantissa am) noexcept {
+    using traits = float_traits<T>;
+    const auto bits = typename traits::bits_type(
+        am.mantissa 
+        | (u64(am.power2) << (traits::P - 1)) 
+        | (u64(negative) << (sizeof(T) * 8 - 1)));
+    T value{};
+    memcpy(&value, &bits, sizeof(T));
+    return value;
+}
+
+// w * 10^q is exact when both fit in the mantissa, so a single multiply or divide rounds correctly
+template<typename T>
+ZEN_FORCEINLINE bool exact_decimal_to_float(const decimal_string& d, T& value) noexcept {
+    using traits = float_traits<T>;
+    static constexpr f64 POW10[23] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    #if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD != 0
+        return false;
+    #endif
+    if (d.many_digits || d.w > traits::EXACT_W_MAX || d.q < -traits::EXACT_POW10_MAX || d.q > traits::EXACT_POW10_MAX)
+        return false;
+    value = T(d.w);
+    if (d.q < 0) value = value / T(POW10[-d.q]);
+    else         value = value * T(POW10[d.q]);
+    return true;
+}
+
+// Correctly rounded w * 10^q using a 128-bit approximation of 5^q
+template<typename T>
+inline adjusted_mantissa eisel_lemire(i64 q, u64 w) noexcept {
+    using traits = float_traits<T>;
+    static constexpr int MANTISSA_BITS = traits::P - 1;
+    static constexpr int BIAS = traits::BQ_MASK / 2;
+    if (w == 0 || q < traits::POW10_MIN)
+        return {0, 0};
+    if (q > traits::POW10_MAX)
+        return {0, traits::BQ_MASK};
+
+    const int lz = int(leading_zeros(w));
+    w <<= lz;
+
+    // Only the high bits are needed, the second multiply is skipped unless they might be affected by a carry
+    static constexpr u64 PRECISION_MASK = ~u64(0) >> (MANTISSA_BITS + 3);
+    const u64* pow5 = &EISEL_LEMIRE_POW5[2 * (q - EISEL_LEMIRE_Q_MIN)];
+    u64 hi{};
+    u64 lo = umul128(w, pow5[0], hi);
+    if ((hi & PRECISION_MASK) == PRECISION_MASK) {
+        u64 hi2{};
+        umul128(w, pow5[1], hi2);
+        lo += hi2;
+        hi += lo < hi2;
+    }
+
+    const int upper = int(hi >> 63);
+    const int shift = upper + 64 - MANTISSA_BITS - 3;
+    adjusted_mantissa am{hi >> shift, int(((152170 + 65536) * q) >> 16) + 63 + upper - lz + BIAS};
+
+    // Subnormal
+    if (am.power2 <= 0) {
+        if (-am.power2 + 1 >= 64)
+            return {0, 0};
+        am.mantissa >>= -am.power2 + 1;
+        am.mantissa += am.mantissa & 1;
+        am.mantissa >>= 1;
+        am.power2 = am.mantissa < (u64(1) << MANTISSA_BITS) ? 0 : 1;
+        return am;
+    }
+
+    // Exactly halfway, round to even instead of up
+    if (lo <= 1 && q >= traits::ROUND_EVEN_MIN && q <= traits::ROUND_EVEN_MAX 
+        && (am.mantissa & 3) == 1 && (am.mantissa << shift) == hi)
+        am.mantissa &= ~u64(1);
+
+    am.mantissa += am.mantissa & 1;
+    am.mantissa >>= 1;
+    if (am.mantissa >= (u64(2) << MANTISSA_BITS)) {
+        am.mantissa = u64(1) << MANTISSA_BITS;
+        ++am.power2;
+    }
+    am.mantissa &= ~(u64(1) << MANTISSA_BITS);
+    if (am.power2 >= traits::BQ_MASK)
+        return {0, traits::BQ_MASK};
+    return am;
+}
+
+// No halfway point between two doubles has more significant digits than this
+static constexpr usize DECIMAL_MAX_DIGITS = 768;
+using decimal_bigint = bigint<128>;
+
+// Compares the decimal digits * 10^e with h * 2^e2 exactly
+inline int compare_decimal(const decimal_bigint& digits, i64 e, bool sticky, u64 h, int e2) noexcept {
+    decimal_bigint l{digits};
+    decimal_bigint r{h, 0};
+    if (e >= 0) l.mul_pow5(usize(e));
+    else        r.mul_pow5(usize(-e));
+    if (e >= e2) l.shl(usize(e - e2));
+    else         r.shl(usize(e2 - e));
+    const int cmp = l.compare(r);
+    // Non-zero digits past the ones in l push ties up
+    return cmp == 0 && sticky ? 1 : cmp;
+}
+
+// Correctly rounded value of a decimal string with more than 19 significant digits
+// am is the rounded value of the truncated w * 10^q, the correct result is am or the float after it
+template<typename T>
+inline adjusted_mantissa decimal_to_float_slow(const decimal_string& d, adjusted_mantissa am) noexcept {
+    using traits = float_traits<T>;
+    static constexpr int MANTISSA_BITS = traits::P - 1;
+
+    // Exact value of the first DECIMAL_MAX_DIGITS significant digits
+    decimal_bigint digits{0, 0};
+    const char* it = d.digits;
+    while (it != d.digits_end && (*it == '0' || *it == '.')) ++it;
+    usize n{};
+    u32 chunk{}, chunk_pow10{1};
+    for (; it != d.digits_end && n < DECIMAL_MAX_DIGITS; ++it) {
+        if (*it == '.') continue;
+        chunk = chunk * 10 + u32(*it - '0');
+        chunk_pow10 *= 10;
+        ++n;
+        if (chunk_pow10 == 1000000000) {
+            digits.mul(chunk_pow10, chunk);
+            chunk = 0;
+            chunk_pow10 = 1;
+        }
+    }
+    if (chunk_pow10 != 1) digits.mul(chunk_pow10, chunk);
+    i64 e = d.exponent;
+    bool sticky = false;
+    for (; it != d.digits_end; ++it) {
+        if (*it == '.') continue;
+        sticky |= *it != '0';
+        ++e;
+    }
+
+    // Value of the float with these bits as m * 2^e2
+    const auto decode = [](u64 bits, u64& m, int& e2) noexcept {
+        const int bq = int(bits >> MANTISSA_BITS);
+        m  = bits & ((u64(1) << MANTISSA_BITS) - 1);
+        e2 = (bq ? bq : 1) - traits::BQ_MASK / 2 - MANTISSA_BITS;
+        if (bq) m |= u64(1) << MANTISSA_BITS;
+    };
+
+    // Round up if the value is above the halfway point to the next float, ties to even
+    u64 bits = (u64(am.power2) << MANTISSA_BITS) | am.mantissa;
+    u64 m0{}, m1{};
+    int e0{}, e1{};
+    decode(bits, m0, e0);
+    decode(bits + 1, m1, e1);
+    const int cmp = compare_decimal(digits, e, sticky, m0 + (m1 << (e1 - e0)), e0 - 1);
+    if (cmp > 0 || (cmp == 0 && (bits & 1) != 0))
+        ++bits;
+    return {bits & ((u64(1) << MANTISSA_BITS) - 1), int(bits >> MANTISSA_BITS)};
+}
+
+// Parses inf, infinity or nan (case insensitive) with an optional nan(chars) payload that is ignored
+template<typename T>
+inline const char* parse_inf_nan(const char* it, const char* end, bool negative, T& value) noexcept {
+    using traits = float_traits<T>;
+    const auto match = [&](const char* word, usize n) noexcept {
+        if (usize(end - it) < n) return false;
+        for (usize i = 0; i < n; ++i)
+            if ((it[i] | 0x20) != word[i]) return false;
+        return true;
+    };
+    if (match("nan", 3)) {
+        it += 3;
+        if (it != end && *it == '(') {
+            const char* p = it + 1;
+            while (p != end && (((*p | 0x20) >= 'a' && (*p | 0x20) <= 'z') || (*p >= '0' && *p <= '9') || *p == '_')) ++p;
+            if (p != end && *p == ')') it = p + 1;
+        }
+        value = to_float<T>(negative, {u64(1) << (traits::P - 2), traits::BQ_MASK});
+        return it;
+    }
+    if (match("inf", 3)) {
+        it += 3;
+        if (match("inity", 5)) it += 5;
+        value = to_float<T>(negative, {0, traits::BQ_MASK});
+        return it;
+    }
+    return nullptr;
+}
+
+}
+
+#endif // ZEN_FMT_FLOAT_H
@@ -0,0 +1,1293 @@
+#ifndef ZEN_FMT_TABLES_H
+#define ZEN_FMT_TABLES_H
+
+// Generated by tools/fmt_tables.py, do not edit
+
+#include "zen_config.h"
+
+namespace zen::fmt::impl {
+
+static constexpr int SCHUBFACH_K_MIN = -324;
+static constexpr int SCHUBFACH_K_MAX = 292;
+static constexpr int EISEL_LEMIRE_Q_MIN = -342;
+static constexpr int EISEL_LEMIRE_Q_MAX = 308;
+
+// g1, g0 for k in [-324, 292]
+static constexpr u64 SCHUBFACH_G[1234] = {
+    0x4f0cedc95a718dd4, 0x5b01e8b09aa0d1b5,
+    0x7e7b160ef71c1621, 0x119ca780f767b5ee,
+    0x652f44d8c5b011b4, 0x0e16ec672c52f7f2,
+    0x50f29d7a37c00e29, 0x581256b8f0425ff5,
+    0x40c21794f96671ba, 0x79a84560c0351991,
+    0x679cf287f570b5f7, 0x75da089acd21c281,
+    0x52e3f5399126f7f9, 0x44ae6d48a41b0201,
+    0x424ff76140ebf994, 0x36f1f106e9af34cd,
+    0x6a198bcece465c20, 0x57e981a4a918547b,
+    0x54e13ca571d1e34d, 0x2cbace1d541376c9,
+    0x43e763b78e4182a4, 0x23c8a4e44342c56e,
+    0x6ca56c58e39c043a, 0x060dd4a06b9e08b0,
+    0x56eabd13e9499cfb, 0x1e7176e6bc7e6d59,
+    0x458897432107b0c8, 0x7ec12bebc9febde1,
+    0x6f40f20501a5e7a7, 0x7e01dfdfa9979635,
+    0x5900c19d9aeb1fb9, 0x4b34b319547944f7,
+    0x4733ce17af227fc7, 0x55c3c27aa9fa9d93,
+    0x71ec7cf2b1d0cc72, 0x560603f7765dc8ea,
+    0x5b2397288e40a38e, 0x7804cff92b7e3a55,
+    0x48e945ba0b66e93f, 0x13370cc755fe9511,
+    0x74a86f90123e41fe, 0x51f1ae0bbcca881b,
+    0x5d538c7341cb67fe, 0x74c1580963d539af,
+    0x4aa93d29016f8665, 0x43cde0078310faf3,
+    0x77752ea8024c0a3c, 0x0616333f381b2b1e,
+    0x5f90f22001d66e96, 0x3811c298f9af55b1,
+    0x4c73f4e667debede, 0x600e35472e25de28,
+    0x7a532170a6313164, 0x3349eed849d6303f,
+    0x61dc1ac084f42783, 0x42a18be03b11c033,
+    0x4e49af006a5cec69, 0x1bb46fe695a7ccf5,
+    0x7d42b19a43c7e0a8, 0x2c53e63dbc3fae55,
+    0x64355ae1cfd31a20, 0x237651cafcffbeaa,
+    0x502aaf1b0ca8e1b3, 0x35f8416f30cc9888,
+    0x402225af3d53e7c2, 0x5e603458f3d6e06d,
+    0x669d0918621fd937, 0x4a3386f4b957cd7b,
+    0x52173a79e8197a92, 0x6e8f9f2a2ddfd796,
+    0x41ac2ec7ece12edb, 0x720c7f54f17fdfab,
+    0x69137e0cae3517c6, 0x1ce0cbbb1bffcc45,
+    0x540f980a24f74638, 0x171a3c95afffd69e,
+    0x433facd4ea5f6b60, 0x127b63aaf3331218,
+    0x6b991487dd657899, 0x6a5f05de51eb5026,
+    0x5614106cb11dfa14, 0x5518d17ea7ef7352,
+    0x44dcd9f08db194dd, 0x2a7a41321ff2c2a8,
+    0x6e2e2980e2b5bafb, 0x5d906850331e043f,
+    0x5824ee00b55e2f2f, 0x647386a68f4b3699,
+    0x4683f19a2ab1bf59, 0x36c2d21ed908f87b,
+    0x70d31c29dde93228, 0x579e1cfe280e5a5d,
+    0x5a427cee4b20f4ed, 0x2c7e7d98200b7b7e,
+    0x483530bea280c3f1, 0x09fecae019a2c932,
+    0x73884dfdd0ce064e, 0x43314499c29e0eb6,
+    0x5c6d0b3173d8050b, 0x4f5a9d47cee4d891,
+    0x49f0d5c129799da2, 0x72aee4397250ad41,
+    0x764e22cea8c295d1, 0x377e39f583b44868,
+    0x5ea4e8a553cede41, 0x12cb61913629d387,
+    0x4bb72084430be500, 0x756f8140f8217605,
+    0x792500d39e796e67, 0x6f18cece59cf233c,
+    0x60ea670fb1fabeb9, 0x3f470bd847d8e8fd,
+    0x4d885272f4c89894, 0x329f3cad064720ca,
+    0x7c0d50b7ee0dc0ed, 0x37652de1a3a50143,
+    0x633dda2cbe716724, 0x2c50f1814fb73436,
+    0x4f64ae8a31f45283, 0x3d0d8e010c92902b,
+    0x7f077da9e986ea6b, 0x7b48e334e0ea8045,
+    0x659f97bb2138bb89, 0x49071c2a4d88669d,
+    0x514c796280fa2fa1, 0x20d27ceea46d1ee4,
+    0x4109fab533fb594d, 0x670eca58838a7f1d,
+    0x680ff788532bc216, 0x0b4add5a6c10cb62,
+    0x533ff939dc2301ab, 0x22a24aaebcda3c4e,
+    0x4299942e49b59aef, 0x354ea22563e1c9d8,
+    0x6a8f537d42bc2b18, 0x554a9d089fcfa95a,
+    0x553f75fdcefcef46, 0x776ee406e63fbaae,
+    0x4432c4cb0bfd8c38, 0x5f8be99f1e996225,
+    0x6d1e07ab466279f4, 0x327975cb64289d08,
+    0x574b3955d1e86190, 0x28612b091ced4a6d,
+    0x45d5c777db204e0d, 0x06b4226db0bdd524,
+    0x6fbc72595e9a167b, 0x24536a491ac95506,
+    0x59638eade54811fc, 0x1d0f883a7bd44405,
+    0x4782d88b1dd34196, 0x4a72d361fca9d004,
+    0x726af411c952028a, 0x43eaebcffaa94cd3,
+    0x5b88c3416ddb353b, 0x4fef230cc88770a9,
+    0x493a35cdf17c2a96, 0x0cbf4f3d6d3926ee,
+    0x7529efafe8c6aa89, 0x61321862485b717c,
+    0x5dbb262653d22207, 0x675b46b506af8dfd,
+    0x4afc1e850fdb4e6c, 0x52af6bc405593e64,
+    0x77f9ca6e7fc54a47, 0x377f12d33bc1fd6d,
+    0x5ffb085866376e9f, 0x45ff42429634cabd,
+    0x4cc8d379eb5f8bb2, 0x6b329b68782a3bcb,
+    0x7adaebf64565ac51, 0x2b842bda59dd2c77,
+    0x6248bcc5045156a7, 0x3c69bcaeae4a89f9,
+    0x4ea0970403744552, 0x6387ca25583ba194,
+    0x7dcdbe6cd253a21e, 0x05a6103bc05f68ed,
+    0x64a498570ea94e7e, 0x37b80cfc99e5ed8a,
+    0x5083ad1272210b98, 0x2c933d96e184be08,
+    0x40695741f4e73c79, 0x7075cadf1ad09807,
+    0x670ef2032171fa5c, 0x4d8944982ae759a4,
+    0x52725b35b45b2eb0, 0x3e076a135585e150,
+    0x41f515c49048f226, 0x64d2bb42aad1810d,
+    0x698822d41a0e503e, 0x07b7920444826815,
+    0x546ce8a9ae71d9cb, 0x1fc60e69d0685344,
+    0x438a53baf1f4ae3c, 0x196b3ebb0d20429d,
+    0x6c1085f7e9877d2d, 0x0f11fdf815006a94,
+    0x56739e5fee05fdbd, 0x58db319344005543,
+    0x45294b7ff19e6497, 0x60af5adc3666aa9c,
+    0x6ea878ccb5ca3a8c, 0x344bc4938a3dddc7,
+    0x5886c70a2b082ed6, 0x5d096a0fa1cb17d2,
+    0x46d238d4ef39bf12, 0x173abb3fb4a27975,
+    0x71505aee4b8f981d, 0x0b912b992103f588,
+    0x5aa6af25093face4, 0x0940efadb4032ad3,
+    0x488558ea6dcc8a50, 0x07672624900288a9,
+    0x74088e43e2e0dd4c, 0x723ea36db337410e,
+    0x5cd3a5031be71770, 0x5b654f8af5c5cda5,
+    0x4a42ea68e31f45f3, 0x62b772d5916b0aeb,
+    0x76d1770e38320986, 0x0458b7bc1bde77dd,
+    0x5f0df8d82cf4d46b, 0x1d13c630164b9318,
+    0x4c0b2d79bd90a9ef, 0x30dc9e8cdea2dc13,
+    0x79ab7bf5fc1aa97f, 0x0160fdae31049351,
+    0x6155fcc4c9aeedff, 0x1ab3fe24f403a90e,
+    0x4dde63d0a158be65, 0x6229981d9002eda5,
+    0x7c97061a9bc130a2, 0x69dc2695b337e2a1,
+    0x63ac04e2163426e8, 0x54b01ede28f9821b,
+    0x4fbcd0b4de901f20, 0x43c018b1ba6134e2,
+    0x7f9481216419cb67, 0x1f99c11c5d68549d,
+    0x6610674de9ae3c52, 0x4c7b00e37ded107e,
+    0x51a6b90b21583042, 0x09fc00b5fe574065,
+    0x41522da2811359ce, 0x3b3000919845cd1d,
+    0x68837c3734ebc2e3, 0x784ccdb5c06fae95,
+    0x539c635f5d8968b6, 0x2d0a3e2b00595877,
+    0x42e382b2b13aba2b, 0x3da1cb5599e11393,
+    0x6b059deab52ac378, 0x629c7888f634ec1e,
+    0x559e17eef755692d, 0x3549fa072b5d89b1,
+    0x447e798bf91120f1, 0x1107fb38ef7e07c1,
+    0x6d9728dff4e834b5, 0x01a65ec17f300c68,
+    0x57ac20b32a535d5d, 0x4e1eb23465c009ed,
+    0x46234d5c21dc4ab1, 0x24e55b5d1e333b24,
+    0x70387bc69c93aab5, 0x216ef894fd1ec506,
+    0x59c6c96bb076222a, 0x4df2607730e56a6c,
+    0x47d23abc8d2b4e88, 0x3e5b805f5a5121f0,
+    0x72e9f79415121740, 0x63c59a322a1b697f,
+    0x5bee5fa9aa74df67, 0x03047b5b54e2bacc,
+    0x498b7fbaeec3e5ec, 0x0269fc4910b5623d,
+    0x75abff917e063cac, 0x6a432d41b45569fb,
+    0x5e2332dacb38308a, 0x21cf5767c37787fc,
+    0x4b4f5be23c2cf3a1, 0x67d912b9692c6cca,
+    0x787ef969f9e185cf, 0x595b5128a8471476,
+    0x60659454c7e79e3f, 0x6115da86ed05a9f8,
+    0x4d1e1043d31fb1cc, 0x4dab1538bd9e2193,
+    0x7b634d3951cc4fad, 0x62ab552795c9cf52,
+    0x62b5d7610e3d0c8b, 0x0222aa86116e3f75,
+    0x4ef7df80d830d6d5, 0x4e822204dabe992a,
+    0x7e59659af38157bc, 0x17369cd49130f510,
+    0x65145148c2cddfc9, 0x5f5ee3dd40f3f740,
+    0x50dd0dd3cf0b196e, 0x1918b64a9a5cc5cd,
+    0x40b0d7dca5a27abe, 0x4746f83baeb09e3e,
+    0x678159610903f797, 0x253e59f91780fd2f,
+    0x52cde11a6d9cc612, 0x50feae60df9a6426,
+    0x423e4daebe1704db, 0x5a65584d7faeb685,
+    0x69fd4917968b3af9, 0x10a226e265e4573b,
+    0x54caa0dfaba29594, 0x0d4e8581eb1d1295,
+    0x43d54d7fbc821143, 0x243ed134bc174211,
+    0x6c887bff94034ed2, 0x06cae85460253682,
+    0x56d396661002a574, 0x6bd586a9e6842b9b,
+    0x457611eb40021df7, 0x09779eee52035616,
+    0x6f234fdeccd02ff1, 0x5bf297e3b66bbcef,
+    0x58e90cb23d73598e, 0x165bacb62b8963f3,
+    0x4720d6f4fdf5e13e, 0x451623c4efa11cc2,
+    0x71ce24bb2fefceca, 0x3b569fa17f682e03,
+    0x5b0b5095bff30bd5, 0x15dee61acc535803,
+    0x48d5da11665c0977, 0x2b18b8157042accf,
+    0x74895ce8a3c6758b, 0x5e8df355806aae18,
+    0x5d3ab0ba1c9ec46f, 0x653e5c4466bbbe7a,
+    0x4a955a2e7d4bd059, 0x3765169d1efc9861,
+    0x77555d172edfb3c2, 0x256e8a94fe60f3cf,
+    0x5f777dac257fc301, 0x6abed543feb3f63f,
+    0x4c5f97bceacc9c01, 0x3bcbddcffef65e99,
+    0x7a328c6177adc668, 0x5fac961997f0975b,
+    0x61c209e792f16b86, 0x7fbd44e1465a12af,
+    0x4e34d4b9425abc6b, 0x7fca9d810514dbbf,
+    0x7d21545b9d5dfa46, 0x32ddc8ce6e87c5ff,
+    0x641aa9e2e44b2e9e, 0x5be4a0a525396b32,
+    0x501554b5836f587e, 0x7cb6e6ea842def5c,
+    0x4011109135f2ad32, 0x30925255368b25e3,
+    0x6681b41b89844850, 0x4db6ea21f0dea304,
+    0x52015ce2d469d373, 0x57c5881b2718826a,
+    0x419ab0b576bb0f8f, 0x5fd139af527a01ef,
+    0x68f781225791b27f, 0x4c81f5e550c3364a,
+    0x53f9341b79415b99, 0x239b2b1dda35c508,
+    0x432dc3492dcde2e1, 0x02e288e4ae916a6d,
+    0x6b7c6ba849496b01, 0x516a74a1174f10ae,
+    0x55fd22ed076def34, 0x4121f6e745d8da25,
+    0x44ca82573924bf5d, 0x1a8192529e4714eb,
+    0x6e10d08b8ea1322e, 0x5d9c1d50fd3e87dd,
+    0x580d73a2d880f4f2, 0x17b01773fdcb9fe4,
+    0x4671294f139a5d8e, 0x4626792997d61984,
+    0x70b50ee4ec2a2f4a, 0x3d0a5b75bfbcf59f,
+    0x5a2a7250bcee8c3b, 0x4a6eaf916630c47f,
+    0x4821f50d63f209c9, 0x21f2260deb5a36cc,
+    0x736988156cb6760e, 0x69837016455d247a,
+    0x5c546cddf091f80b, 0x6e02c011d1175062,
+    0x49dd23e4c074c66f, 0x719bccdb0dac404e,
+    0x762e9fd467213d7f, 0x68f947c4e2ad33b0,
+    0x5e8bb3105280fdff, 0x6d94396a4ef0f627,
+    0x4ba2f5a6a8673199, 0x3e102deea58d91b9,
+    0x7904bc3dda3eb5c2, 0x3019e3176f48e927,
+    0x60d09697e1cbc49b, 0x4014b5ac590720ec,
+    0x4d73abacb4a303af, 0x4cdd5e237a6c1a57,
+    0x7bec45e12104d2b2, 0x47c8969f2a46908a,
+    0x63236b1a80d0a88e, 0x6ca0787f5505406f,
+    0x4f4f88e200a6ed3f, 0x0a19f9ff773766bf,
+    0x7ee5a7d0010b1531, 0x5cf65ccbf1f23dfe,
+    0x6584864000d5aa8e, 0x172b7d6ff4c1cb32,
+    0x5136d1cccd77bba4, 0x78ef978cc3ce3c28,
+    0x40f8a7d70ac62fb7, 0x13f2dfa3cfd83020,
+    0x67f43fbe77a37f8b, 0x398499061959e699,
+    0x5329cc985fb5ffa2, 0x6136e0d1ade18548,
+    0x4287d6e04c91994f, 0x00f8b3daf181376d,
+    0x6a72f166e0e8f54b, 0x1b27862b1c01f247,
+    0x5528c11f1a53f76f, 0x2f52d1bc1667f506,
+    0x44209a7f48432c59, 0x0c424163451ff738,
+    0x6d00f7320d3846f4, 0x7a039bd208332526,
+    0x5733f8f4d76038c3, 0x7b361641a028ea85,
+    0x45c32d90ac4cfa36, 0x2f5e78348020bb9e,
+    0x6f9eaf4de07b29f0, 0x4bca59ed99cdf8fc,
+    0x594bbf71806287f3, 0x563b7b247b0b2d96,
+    0x476fcc5acd1b9ff6, 0x11c92f50626f57ac,
+    0x724c7a2ae1c5ccbd, 0x02db7ee703e55912,
+    0x5b7061bbe7d17097, 0x1be2cbec031de0dc,
+    0x4926b496530df3ac, 0x164f09899c17e716,
+    0x750aba8a1e7cb913, 0x3d4b4275c68ca4f0,
+    0x5da22ed4e530940f, 0x4aa29b916ba3b726,
+    0x4ae825771dc07672, 0x6ee87c74561c9285,
+    0x77d9d58b62cd8a51, 0x3173fa53bcfa8408,
+    0x5fe177a2b5713b74, 0x278ffb7630c869a0,
+    0x4cb45fb55df42f90, 0x1fa662c4f3d387b3,
+    0x7aba32bbc986b280, 0x32a3d13b1fb8d91f,
+    0x622e8efca1388ecd, 0x0ee9742f4c93e0e6,
+    0x4e8ba596e760723d, 0x58bac3590a0fe71e,
+    0x7dac3c24a5671d2f, 0x412ad228101971c9,
+    0x6489c9b6eab8e426, 0x00ef0e8673478e3b,
+    0x506e3af8bbc71ceb, 0x1a58d86b8f6c71c9,
+    0x40582f2d6305b0bc, 0x1513e0560c56c16e,
+    0x66f37eaf04d5e793, 0x3b530089ad579be2,
+    0x525c6558d0ab1fa9, 0x15dc006e2446164f,
+    0x41e384470d55b2ed, 0x5e4999f1b69e783f,
+    0x696c06d81555eb15, 0x7d428fe92430c065,
+    0x54566be0111188de, 0x31020cba835a3384,
+    0x4378564cda746d7e, 0x5a680a2ecf7b5c69,
+    0x6bf3bd47c3ed7bfd, 0x770cdd17b25efa42,
+    0x565c976c9cbdfccb, 0x1270b0dfc1e59502,
+    0x4516df8a16fe63d5, 0x5b8d5a4c9b1e10ce,
+    0x6e8aff4357fd6c89, 0x127bc3adc4fce7b0,
+    0x586f329c466456d4, 0x0ec96957d0ca52f3,
+    0x46bf5bb038504576, 0x3f07877973d50f29,
+    0x71322c4d26e6d58a, 0x31a5a58f1fbb4b75,
+    0x5a8e89d75252446e, 0x5aeaead8e62f6f91,
+    0x487207df750e9d25, 0x2f22557a51bf8c74,
+    0x73e9a63254e42ea2, 0x1836ef2a1c65ad86,
+    0x5cbaeb5b771cf21b, 0x2cf8bf54e3848ad2,
+    0x4a2f22af927d8e7c, 0x23fa32aa4f9d3bdb,
+    0x76b1d118ea627d93, 0x5329eaaa18fb92f8,
+    0x5ef4a74721e86476, 0x0f54bbbb472fa8c6,
+    0x4bf6ec38e7ed1d2b, 0x25dd62fc38f2ed6c,
+    0x798b138e3fe1c845, 0x22fbd1938e517bdf,
+    0x613c0fa4ffe7d36a, 0x4f2fdadc71dac97f,
+    0x4dc9a61d998642bb, 0x58f3157d27e23acc,
+    0x7c75d695c2706ac5, 0x74b82261d969f7ad,
+    0x63917877cec0556b, 0x10934eb4adee5fbe,
+    0x4fa793930bcd1122, 0x4075d8908b251965,
+    0x7f7285b812e1b504, 0x00bc8db411d4f56e,
+    0x65f537c675815d9c, 0x66fd3e29a7dd9125,
+    0x5190f96b91344ae3, 0x6bfdcb54864ada84,
+    0x4140c78940f6a24f, 0x6ffe3c439ea2486a,
+    0x6867a5a867f103b2, 0x7ffd2d38fdd073dc,
+    0x53861e2053273628, 0x6664242d97d9f64a,
+    0x42d1b1b375b8f820, 0x51e9b68adfe191d5,
+    0x6ae91c5255f4c034, 0x1ca924116635b621,
+    0x558749db77f70029, 0x63ba83411e915e81,
+    0x446c3b15f9926687, 0x6962029a7edab201,
+    0x6d79f82328ea3da6, 0x0f03375d97c45001,
+    0x5794c6828721caeb, 0x259c2c4adfd04001,
+    0x46109eced2816f22, 0x5149bd08b30d0001,
+    0x701a97b150cf1837, 0x3542c80deb480001,
+    0x59aedfc10d7279c5, 0x7768a00b22a00001,
+    0x47bf19673df52e37, 0x79208008e8800001,
+    0x72cb5bd86321e38c, 0x5b67334174000001,
+    0x5bd5e313828182d6, 0x7c528f6790000001,
+    0x4977e8dc68679bdf, 0x16a872b940000001,
+    0x758ca7c70d7292fe, 0x5773eac200000001,
+    0x5e0a1fd271287598, 0x45f6556800000001,
+    0x4b3b4ca85a86c47a, 0x04c5112000000001,
+    0x785ee10d5da46d90, 0x07a1b50000000001,
+    0x604be73de4838ad9, 0x52e7c40000000001,
+    0x4d0985cb1d3608ae, 0x0f1fd00000000001,
+    0x7b426fab61f00de3, 0x31cc800000000001,
+    0x629b8c891b267182, 0x5b0a000000000001,
+    0x4ee2d6d415b85ace, 0x7c08000000000001,
+    0x7e37be2022c0914b, 0x1340000000000001,
+    0x64f964e68233a76f, 0x2900000000000001,
+    0x50c783eb9b5c85f2, 0x5400000000000001,
+    0x409f9cbc7c4a04c2, 0x1000000000000001,
+    0x6765c793fa10079d, 0x0000000000000001,
+    0x52b7d2dcc80cd2e4, 0x0000000000000001,
+    0x422ca8b0a00a4250, 0x0000000000000001,
+    0x69e10de76676d080, 0x0000000000000001,
+    0x54b40b1f852bda00, 0x0000000000000001,
+    0x43c33c1937564800, 0x0000000000000001,
+    0x6c6b935b8bbd4000, 0x0000000000000001,
+    0x56bc75e2d6310000, 0x0000000000000001,
+    0x4563918244f40000, 0x0000000000000001,
+    0x6f05b59d3b200000, 0x0000000000000001,
+    0x58d15e1762800000, 0x0000000000000001,
+    0x470de4df82000000, 0x0000000000000001,
+    0x71afd498d0000000, 0x0000000000000001,
+    0x5af3107a40000000, 0x0000000000000001,
+    0x48c2739500000000, 0x0000000000000001,
+    0x746a528800000000, 0x0000000000000001,
+    0x5d21dba000000000, 0x0000000000000001,
+    0x4a817c8000000000, 0x0000000000000001,
+    0x7735940000000000, 0x0000000000000001,
+    0x5f5e100000000000, 0x0000000000000001,
+    0x4c4b400000000000, 0x0000000000000001,
+    0x7a12000000000000, 0x0000000000000001,
+    0x61a8000000000000, 0x0000000000000001,
+    0x4e20000000000000, 0x0000000000000001,
+    0x7d00000000000000, 0x0000000000000001,
+    0x6400000000000000, 0x0000000000000001,
+    0x5000000000000000, 0x0000000000000001,
+    0x4000000000000000, 0x0000000000000001,
+    0x6666666666666666, 0x3333333333333334,
+    0x51eb851eb851eb85, 0x0f5c28f5c28f5c29,
+    0x4189374bc6a7ef9d, 0x5916872b020c49bb,
+    0x68db8bac710cb295, 0x74f0d844d013a92b,
+    0x53e2d6238da3c211, 0x43f3e0370cdc8755,
+    0x431bde82d7b634da, 0x698fe69270b06c44,
+    0x6b5fca6af2bd215e, 0x0f4ca41d811a46d4,
+    0x55e63b88c230e77e, 0x3f70834acdae9f10,
+    0x44b82fa09b5a52cb, 0x4c5a02a23e254c0d,
+    0x6df37f675ef6eadf, 0x2d5cd10396a21347,
+    0x57f5ff85e592557f, 0x3de3da69454e75d3,
+    0x465e6604b7a84465, 0x7e4fe1edd10b9175,
+    0x709709a125da0709, 0x4a19697c81ac1bef,
+    0x5a126e1a84ae6c07, 0x54e1213067bce326,
+    0x480ebe7b9d58566c, 0x43e74dc052fd8285,
+    0x734aca5f6226f0ad, 0x530baf9a1e626a6d,
+    0x5c3bd5191b525a24, 0x426fbfae7eb521f1,
+    0x49c97747490eae83, 0x4ebfcc8b9890e7f4,
+    0x760f253edb4ab0d2, 0x4acc7a78f41b0cba,
+    0x5e72843249088d75, 0x223d2ec729af3d62,
+    0x4b8ed0283a6d3df7, 0x34fdbf05baf29781,
+    0x78e480405d7b9658, 0x54c931a2c4b758cf,
+    0x60b6cd004ac94513, 0x5d6dc14f03c5e0a5,
+    0x4d5f0a66a23a9da9, 0x31249aa59c9e4d51,
+    0x7bcb43d769f762a8, 0x4ea0f76f60fd4882,
+    0x63090312bb2c4eed, 0x254d92bf80caa068,
+    0x4f3a68dbc8f03f24, 0x1dd7a89933d54d20,
+    0x7ec3daf941806506, 0x62f2a75b86221500,
+    0x65697bfa9acd1d9f, 0x025bb91604e810cd,
+    0x51212ffbaf0a7e18, 0x684960de6a5340a4,
+    0x40e7599625a1fe7a, 0x203ab3e521dc33b6,
+    0x67d88f56a29cca5d, 0x19f7863b696052bd,
+    0x5313a5dee87d6eb0, 0x7b2c6b62bab37564,
+    0x42761e4bed31255a, 0x2f56bc4efbc2c450,
+    0x6a5696dfe1e83bc3, 0x655793b192d13a1a,
+    0x5512124cb4b9c969, 0x377942f475742e7b,
+    0x440e750a2a2e3aba, 0x5f9435905df68b96,
+    0x6ce3ee76a9e3912a, 0x65b9ef4d63241289,
+    0x571cbec554b60dbb, 0x6afb25d782834207,
+    0x45b0989ddd5e7163, 0x08c8eb12cecf6806,
+    0x6f80f42fc8971bd1, 0x5adb11b7b14bd9a3,
+    0x5933f68ca078e30e, 0x157c0e2c8dd647b5,
+    0x475cc53d4d2d8271, 0x5dfcd823a4ab6c91,
+    0x722e086215159d82, 0x632e269f6ddf141b,
+    0x5b5806b4ddaae468, 0x4f581ee5f17f4349,
+    0x49133890b1558386, 0x72ace584c1329c3b,
+    0x74eb8db44eef38d7, 0x6aae3c079b842d2a,
+    0x5d893e29d8bf60ac, 0x5558300616035755,
+    0x4ad431bb13cc4d56, 0x7779c004de6912ab,
+    0x77b9e92b52e07bbe, 0x258f99a163db5111,
+    0x5fc7edbc424d2fcb, 0x37a614811caf740d,
+    0x4c9ff163683dbfd5, 0x7951aa00e3bf900b,
+    0x7a998238a6c932ef, 0x754f7667d2cc19ab,
+    0x6214682d523a8f26, 0x2aa5f8530f09ae22,
+    0x4e76b9bddb620c1e, 0x55519375a5a1581b,
+    0x7d8ac2c95f034697, 0x3bb5b8bc3c3559c5,
+    0x646f023ab2690545, 0x7c9160969691149e,
+    0x5058ce955b87376b, 0x16dab3ababa743b2,
+    0x40470baaaf9f5f88, 0x78aef622efb902f5,
+    0x66d812aab29898db, 0x0de4bd04b2c19e54,
+    0x524675555bad4715, 0x57ea30d08f014b76,
+    0x41d1f7777c8a9f44, 0x4654f3da0c01092c,
+    0x694ff258c7443207, 0x23bb1fc346680eac,
+    0x543ff513d29cf4d2, 0x4fc8e635d1ecd88a,
+    0x43665da9754a5d75, 0x263a51c4a7f0ad3b,
+    0x6bd6fc425543c8bb, 0x56c3b607731aaec4,
+    0x5645969b77696d62, 0x789c919f8f488bd0,
+    0x4504787c5f878ab5, 0x46e3a7b2d906d640,
+    0x6e6d8d93cc0c1122, 0x3e390c515b3e239a,
+    0x5857a4763cd6741b, 0x4b60d6a77c31b615,
+    0x46ac8391ca4529af, 0x55e7121f968e2b44,
+    0x711405b6106ea919, 0x0971b698f0e3786d,
+    0x5a766af80d255414, 0x078e2bad8d82c6bd,
+    0x485ebbf9a41ddcdc, 0x6c71bc8ad79bd231,
+    0x73cac65c39c96161, 0x2d82c7448c2c8382,
+    0x5ca23849c7d44de7, 0x3e023903a356cf9b,
+    0x4a1b603b06437185, 0x7e682d9c82abd949,
+    0x76923391a39f1c09, 0x4a4048fa6aac8edb,
+    0x5edb5c7482e5b007, 0x55003a61eef07249,
+    0x4be2b05d35848cd2, 0x773361e7f259f507,
+    0x796ab3c855a0e151, 0x3eb89ca6508fee71,
+    0x6122296d114d810d, 0x7efa16eb73a6585b,
+    0x4db4edf0daa4673e, 0x3261abef8fb846af,
+    0x7c54afe7c43a3eca, 0x1d691318e5f3a44b,
+    0x6376f31fd02e98a1, 0x64540f471e5c836f,
+    0x4f925c1973587a1b, 0x0376729f4b7d35f3,
+    0x7f50935bebc0c35e, 0x38bd84321261efeb,
+    0x65da0f7cbc9a35e5, 0x13cad0280eb4bfef,
+    0x517b3f96fd482b1d, 0x5ca240200bc3ccbf,
+    0x412f66126439bc17, 0x63b50019a3030a33,
+    0x684bd683d38f9359, 0x1f88002904d1a9ea,
+    0x536fdecfdc72dc47, 0x32d3335403daee55,
+    0x42bfe57316c249d2, 0x5bdc291003158b77,
+    0x6acca251be03a951, 0x12f9db4cd1bc1258,
+    0x557081dafe695440, 0x7594af70a7c9a847,
+    0x445a017bfebaa9cd, 0x4476f2c0863aed06,
+    0x6d5ccf2ccac442e2, 0x3a57eacda3917b3c,
+    0x577d728a3bd03581, 0x7b7988a482dac8fd,
+    0x45fdf53b630cf79b, 0x15fad3b6cf156d97,
+    0x6ffcbb923814bf5e, 0x565e1f8ae4ef15be,
+    0x5996fc74f9aa32b2, 0x11e4e608b725aaff,
+    0x47abfd2a6154f55b, 0x27ea51a0928488cc,
+    0x72acc843ceee555e, 0x7310829a84074146,
+    0x5bbd6d030bf1dde5, 0x42739baed005cdd2,
+    0x49645735a327e4b7, 0x4ec2e2f24004a4a8,
+    0x756d5855d1d96df2, 0x4ad16b1d333aa10c,
+    0x5df11377db1457f5, 0x2241227dc2954da3,
+    0x4b2742c648dd132a, 0x4e9a81fe35443e1c,
+    0x783ed13d4161b844, 0x175d9cc9eed39694,
+    0x603240fdcde7c69c, 0x7917b0a18bdc7876,
+    0x4cf500cb0b1fd217, 0x1412f3b46fe39392,
+    0x7b219ade7832e9be, 0x535185ed7fd285b6,
+    0x628148b1f9c25498, 0x42a79e57997537c5,
+    0x4ecdd3c1949b76e0, 0x3552e512e12a9304,
+    0x7e161f9c20f8be33, 0x6eeb081e3510eb39,
+    0x64de7fb01a609829, 0x3f226ce4f740bc2e,
+    0x50b1ffc0151a1354, 0x3281f0b72c33c9be,
+    0x408e66334414dc43, 0x42018d5f568fd498,
+    0x674a3d1ed354939f, 0x1ccf48988a7fba8d,
+    0x52a1ca7f0f76dc7f, 0x30a5d3ad3b99620b,
+    0x421b0865a5f8b065, 0x73b7dc8a96144e6f,
+    0x69c4da3c3cc11a3c, 0x52bfc7442353b0b1,
+    0x549d7b6363cdae96, 0x756639034f7626f4,
+    0x43b12f82b63e2545, 0x4451c735d92b525d,
+    0x6c4eb26abd303ba2, 0x3a1c71efc1deea2e,
+    0x56a55b889759c94e, 0x61b05b2634b254f2,
+    0x45511606df7b0772, 0x1af37c1e908eaa5b,
+    0x6ee8233e325e7250, 0x2b1f2cfdb41776f8,
+    0x58b9b5cb5b7ec1d9, 0x6f4c23fe29ac5f2d,
+    0x46faf7d5e2cbce47, 0x72a34ffe87bd18f1,
+    0x71918c896adfb073, 0x04387ffda5fb5b1b,
+    0x5adad6d4557fc05c, 0x0360666484c915af,
+    0x48af1243779966b0, 0x02b3851d3707448c,
+    0x744b506bf28f0ab3, 0x1dec082ebe720746,
+    0x5d090d2328726ef5, 0x64bcd358985b3905,
+    0x4a6da41c205b8bf7, 0x6a30a913ad15c738,
+    0x7715d36033c5acbf, 0x5d1aa81f7b560b8c,
+    0x5f44a919c3048a32, 0x7daeece5fc44d609,
+    0x4c36edae359d3b5b, 0x7e258a51969d7808,
+    0x79f17c49ef61f893, 0x16a276e8f0fbf33f,
+    0x618dfd07f2b4c6dc, 0x121b9253f3fcc299,
+    0x4e0b30d328909f16, 0x41afa84329970214,
+    0x7cdeb4850db431bd, 0x4f7f739ea8f19ced,
+    0x63e55d373e29c164, 0x3f99294bba5ae3f1,
+    0x4feab0f8fe87cde9, 0x7fadbaa2fb7be98d,
+    0x7fdde7f4ca72e30f, 0x7f7c5dd1925fdc15,
+    0x664b1ff7085be8d9, 0x4c637e4141e649ab,
+    0x51d5b32c06afed7a, 0x704f983434b83aef,
+    0x4177c2899ef32462, 0x26a6135cf6f9c8bf,
+    0x68bf9da8fe51d3d0, 0x3dd685618b294132,
+    0x53cc7e20cb74a973, 0x4b12044e08edcdc2,
+    0x4309fe80a2c3bac2, 0x6f419d0b3a57d7ce,
+    0x6b4330cdd1392ad1, 0x320294dec3bfbfb0,
+    0x55cf5a3e40fa88a7, 0x419baa4bcfcc995a,
+    0x44a5e1cb672ed3b9, 0x1ae2eea30ca3ade1,
+    0x6dd636123eb152c1, 0x77d17dd1add2afcf,
+    0x57de91a832277567, 0x797464a7be42263f,
+    0x464ba7b9c1b92ab9, 0x4790508631ce84ff,
+    0x70790c5c6928445c, 0x0c1a1a704fb0d4cc,
+    0x59fa7049edb9d049, 0x567b4859d95a43d6,
+    0x47fb8d07f161736e, 0x11fc39e17aae9cab,
+    0x732c14d98235857d, 0x032d2968c44a9445,
+    0x5c2343e134f79dfd, 0x4f575453d03ba9d1,
+    0x49b5cfe75d92e4ca, 0x72ac4376402fbb0e,
+    0x75efb30bc8eb07ab, 0x0446d256cd192b49,
+    0x5e595c096d88d2ef, 0x1d0575123dadbc3a,
+    0x4b7ab0078ad3dbf2, 0x4a6ac40e97be302f,
+    0x78c44cd8de1fc650, 0x771139b0f2c9e6b1,
+    0x609d0a4718196b73, 0x78da948d8f07ebc1,
+    0x4d4a6e9f467abc5c, 0x60aedd3e0c065634,
+    0x7baa4a9870c46094, 0x344afb9679a3bd20,
+    0x62eea2138d69e6dd, 0x103bfc78614fca80,
+    0x4f254e760abb1f17, 0x26966393810ca200,
+    0x7ea21723445e9825, 0x2423d2859b476999,
+    0x654e78e9037ee01d, 0x69b642047c392148,
+    0x510b93ed9c658017, 0x6e2b680396941aa0,
+    0x40d60ff149eaccdf, 0x71bc53361210154d,
+    0x67bce64edcaae166, 0x1c6085235019bbae,
+    0x52fd850be3bbe784, 0x7d1a041c40149625,
+    0x42646a6fe9631f9d, 0x4a7b367d0010781d,
+    0x6a3a43e642383295, 0x5d91f0c8001a59c8,
+    0x54fb698501c68ede, 0x17a7f3d3334847d4,
+    0x43fc546a67d20be4, 0x79532975c2a03976,
+    0x6cc6ed770c83463b, 0x0eeb75893766c256,
+    0x57058ac5a39c382f, 0x25892ad42c523512,
+    0x459e089e1c7cf9bf, 0x37a0ef102374f742,
+    0x6f6340fcfa618f98, 0x59017e8038bb2536,
+    0x591c33fd951ad946, 0x7a67986693c8ea91,
+    0x4749c33144157a9f, 0x151fad1edca0bba8,
+    0x720f9eb539bbf765, 0x0832ae97c76792a5,
+    0x5b3fb22a94965f84, 0x068ef21305ec7551,
+    0x48ffc1bbaa11e603, 0x1ed8c1a8d189f774,
+    0x74cc692c434fd66b, 0x4af4690e1c0ff253,
+    0x5d705423690cab89, 0x225d20d816732843,
+    0x4ac0434f873d5607, 0x35174d79ab8f5369,
+    0x779a054c0b955672, 0x21bee25c45b21f0e,
+    0x5fae6aa33c77785b, 0x3498b5169e2818d8,
+    0x4c8b888296c5f9e2, 0x5d46f7454b534713,
+    0x7a78da6a8ad65c9d, 0x7ba4bed545520b52,
+    0x61fa48553bdeb07e, 0x2fb6ff110441a2a8,
+    0x4e61d37763188d31, 0x72f8cc0d9d014eed,
+    0x7d6952589e8daeb6, 0x1e5ae015c80217e1,
+    0x645441e07ed7bef8, 0x1848b344a001acb4,
+    0x504367e6cbdfcbf9, 0x603a2903b3348a2a,
+    0x4035ecb8a3196ffb, 0x002e873628f6d4ee,
+    0x66bcadf43828b32b, 0x19e40b89db2487e3,
+    0x52308b29c686f5bc, 0x14b66fa17c1d3983,
+    0x41c06f549ed25e30, 0x1091f2e7967dc79c,
+    0x6933e554315096b3, 0x341cb7d8f0c93f5f,
+    0x542984435aa6def5, 0x767d5fe0c0a0ff80,
+    0x435469cf7bb8b25e, 0x2b977fe70080cc66,
+    0x6bba42e592c11d63, 0x5f58cca4cd9ae0a3,
+    0x562e9beadbcdb11c, 0x4c470a1d7148b3b6,
+    0x44f216557ca48db0, 0x3d05a1b1276d5c92,
+    0x6e5023bbfaa0e2b3, 0x7b3c35e83f1560e9,
+    0x58401c96621a4ef6, 0x2f635e5365aab3ed,
+    0x4699b0784e7b725e, 0x591c4b75eaeef658,
+    0x70f5e726e3f8b6fd, 0x74fa125644b18a26,
+    0x5a5e5285832d5f31, 0x43fb41de9d5ad4eb,
+    0x484b75379c244c27, 0x4ffc34b2177bdd89,
+    0x73abeebf603a1372, 0x4cc6bab68bf96274,
+    0x5c898bcc4cfb42c2, 0x0a38955ed6611b90,
+    0x4a07a309d72f689b, 0x21c6dde5784dafa7,
+    0x76729e762518a75e, 0x693e2fd58d49190b,
+    0x5ec2185e8413b918, 0x5431bfde0aa0e0d5,
+    0x4bce79e536762dad, 0x29c1664b3bb3e711,
+    0x794a5ca1f0bd15e2, 0x0f9bd6dec5eca4e8,
+    0x61084a1b26fdab1b, 0x2616457f04bd50ba,
+    0x4da03b48ebfe227c, 0x1e783798d09773c8,
+    0x7c33920e46636a60, 0x30c058f480f252d9,
+    0x635c74d8384f884d, 0x0d66ad9067284247,
+    0x4f7d2a469372d370, 0x711ef14052869b6c,
+    0x7f2eaa0a85848581, 0x34fe4ecd50d75f14,
+    0x65beee6ed136d134, 0x2a650bd773df7f43,
+    0x51658b8bda9240f6, 0x551da312c319329c,
+    0x411e093caedb672b, 0x5db14f4235adc217,
+    0x68300ec77e2bd845, 0x7c4ee536bc49368a,
+    0x5359a56c64efe037, 0x7d0bea92303a9208,
+    0x42ae1df050bfe693, 0x173cbba8269541a0,
+    0x6ab02fe6e79970eb, 0x3ec792a6a422029a,
+    0x5559bfebec7ac0bc, 0x3239421ee9b4cee1,
+    0x4447ccbcbd2f0096, 0x5b6101b25490a581,
+    0x6d3fadfac84b3424, 0x2bce691d541aa268,
+    0x576624c8a03c29b6, 0x563eba7ddce21b87,
+    0x45eb50a08030215e, 0x78322ecb171b4939,
+    0x6fdee76733803564, 0x59e9e47824f87527,
+    0x597f1f85c2ccf783, 0x6187e9f9b72d2a86,
+    0x4798e6049bd72c69, 0x346cbb2e2c242205,
+    0x728e3cd42c8b7a42, 0x20adf849e039d007,
+    0x5ba4fd768a092e9b, 0x33be603b19c7d99f,
+    0x4950cac53b3a8baf, 0x42feb3627b0647b3,
+    0x754e113b91f745e5, 0x5197856a5e7072b8,
+    0x5dd80dc941929e51, 0x27ac6abb7ec05bc6,
+    0x4b133e3a9adbb1da, 0x52f05562cbcd1638,
+    0x781ec9f75e2c4fc4, 0x1e4d556adfae89f3,
+    0x6018a192b1bd0c9c, 0x7ea444557fbed4c3,
+    0x4ce0814227ca707d, 0x4bb69d1132ff109c,
+    0x7b00ced03faa4d95, 0x5f8a94e851981a93,
+    0x62670bd9cc883e11, 0x32d543ed0e134875,
+    0x4eb8d647d6d364da, 0x5bddcff0d80f6d2b,
+    0x7df48a0c8aebd491, 0x12fc7fe7c018aeab,
+    0x64c3a1a3a25643a7, 0x28c9ffec99ad5889,
+    0x509c814fb511cfb9, 0x0707fff07af113a1,
+    0x407d343fc40e3fc7, 0x1f39998d2f2742e7,
+    0x672eb9ffa016cc71, 0x7ec28f484b7204a4,
+    0x528bc7ffb345705b, 0x189ba5d36f8e6a1d,
+    0x42096ccc8f6ac048, 0x7a161e42bfa521b1,
+    0x69a8ae1418aacd41, 0x435696d132a1cf81,
+    0x5486f1a9ad557101, 0x1c454574288172ce,
+    0x439f27baf1112734, 0x169dd129ba0128a5,
+    0x6c31d92b1b4ea520, 0x242fb50f9001daa1,
+    0x568e4755af721db3, 0x368c90d940017bb4,
+    0x453e9f77bf8e7e29, 0x120a0d7a999ac95d,
+    0x6eca98bf98e3fd0e, 0x50101590f5c47561,
+    0x58a213cc7a4ffda5, 0x26734473f7d05de8,
+    0x46e80fd6c83ffe1d, 0x6b8f69f65fd9e4b9,
+    0x71734c8ad9fffcfc, 0x45b24323cc8fd45c,
+    0x5ac2a3a247fffd96, 0x6af502830a0ca9e3,
+    0x489bb61b6ccccadf, 0x08c402026e7087e9,
+    0x742c569247ae1164, 0x746cd003e3e73fdb,
+    0x5cf04541d2f1a783, 0x76bd73364fec3315,
+    0x4a59d101758e1f9c, 0x5efdf5c50cbcf5ab,
+    0x76f61b3588e365c7, 0x4b2fefa1adfb22ab,
+    0x5f2b48f7a0b5eb06, 0x08f3261af195b555,
+    0x4c22a0c61a2b226b, 0x20c284e25ade2aab,
+    0x79d1013cf6ab6a45, 0x1ad0d49d5e304444,
+    0x617400fd9222bb6a, 0x48a7107de4f369d0,
+    0x4df6673141b562bb, 0x53b8d9fe50c2bb0d,
+    0x7cbd71e869223792, 0x52c15cca1ad12b48,
+    0x63cac186ba81c60e, 0x75677d6e7bda8906,
+    0x4fd5679efb9b04d8, 0x5dec645863153a6c,
+    0x7fbbd8fe5f5e6e27, 0x497a3a2704eec3df,
+};
+
+// high, low for q in [-342, 308]
+static constexpr u64 EISEL_LEMIRE_POW5[1302] = {
+    0xeef453d6923bd65a, 0x113faa2906a13b3f,
+    0x9558b4661b6565f8, 0x4ac7ca59a424c507,
+    0xbaaee17fa23ebf76, 0x5d79bcf00d2df649,
+    0xe95a99df8ace6f53, 0xf4d82c2c107973dc,
+    0x91d8a02bb6c10594, 0x79071b9b8a4be869,
+    0xb64ec836a47146f9, 0x9748e2826cdee284,
+    0xe3e27a444d8d98b7, 0xfd1b1b2308169b25,
+    0x8e6d8c6ab0787f72, 0xfe30f0f5e50e20f7,
+    0xb208ef855c969f4f, 0xbdbd2d335e51a935,
+    0xde8b2b66b3bc4723, 0xad2c788035e61382,
+    0x8b16fb203055ac76, 0x4c3bcb5021afcc31,
+    0xaddcb9e83c6b1793, 0xdf4abe242a1bbf3d,
+    0xd953e8624b85dd78, 0xd71d6dad34a2af0d,
+    0x87d4713d6f33aa6b, 0x8672648c40e5ad68,
+    0xa9c98d8ccb009506, 0x680efdaf511f18c2,
+    0xd43bf0effdc0ba48, 0x0212bd1b2566def2,
+    0x84a57695fe98746d, 0x014bb630f7604b57,
+    0xa5ced43b7e3e9188, 0x419ea3bd35385e2d,
+    0xcf42894a5dce35ea, 0x52064cac828675b9,
+    0x818995ce7aa0e1b2, 0x7343efebd1940993,
+    0xa1ebfb4219491a1f, 0x1014ebe6c5f90bf8,
+    0xca66fa129f9b60a6, 0xd41a26e077774ef6,
+    0xfd00b897478238d0, 0x8920b098955522b4,
+    0x9e20735e8cb16382, 0x55b46e5f5d5535b0,
+    0xc5a890362fddbc62, 0xeb2189f734aa831d,
+    0xf712b443bbd52b7b, 0xa5e9ec7501d523e4,
+    0x9a6bb0aa55653b2d, 0x47b233c92125366e,
+    0xc1069cd4eabe89f8, 0x999ec0bb696e840a,
+    0xf148440a256e2c76, 0xc00670ea43ca250d,
+    0x96cd2a865764dbca, 0x380406926a5e5728,
+    0xbc807527ed3e12bc, 0xc605083704f5ecf2,
+    0xeba09271e88d976b, 0xf7864a44c633682e,
+    0x93445b8731587ea3, 0x7ab3ee6afbe0211d,
+    0xb8157268fdae9e4c, 0x5960ea05bad82964,
+    0xe61acf033d1a45df, 0x6fb92487298e33bd,
+    0x8fd0c16206306bab, 0xa5d3b6d479f8e056,
+    0xb3c4f1ba87bc8696, 0x8f48a4899877186c,
+    0xe0b62e2929aba83c, 0x331acdabfe94de87,
+    0x8c71dcd9ba0b4925, 0x9ff0c08b7f1d0b14,
+    0xaf8e5410288e1b6f, 0x07ecf0ae5ee44dd9,
+    0xdb71e91432b1a24a, 0xc9e82cd9f69d6150,
+    0x892731ac9faf056e, 0xbe311c083a225cd2,
+    0xab70fe17c79ac6ca, 0x6dbd630a48aaf406,
+    0xd64d3d9db981787d, 0x092cbbccdad5b108,
+    0x85f0468293f0eb4e, 0x25bbf56008c58ea5,
+    0xa76c582338ed2621, 0xaf2af2b80af6f24e,
+    0xd1476e2c07286faa, 0x1af5af660db4aee1,
+    0x82cca4db847945ca, 0x50d98d9fc890ed4d,
+    0xa37fce126597973c, 0xe50ff107bab528a0,
+    0xcc5fc196fefd7d0c, 0x1e53ed49a96272c8,
+    0xff77b1fcbebcdc4f, 0x25e8e89c13bb0f7a,
+    0x9faacf3df73609b1, 0x77b191618c54e9ac,
+    0xc795830d75038c1d, 0xd59df5b9ef6a2417,
+    0xf97ae3d0d2446f25, 0x4b0573286b44ad1d,
+    0x9becce62836ac577, 0x4ee367f9430aec32,
+    0xc2e801fb244576d5, 0x229c41f793cda73f,
+    0xf3a20279ed56d48a, 0x6b43527578c1110f,
+    0x9845418c345644d6, 0x830a13896b78aaa9,
+    0xbe5691ef416bd60c, 0x23cc986bc656d553,
+    0xedec366b11c6cb8f, 0x2cbfbe86b7ec8aa8,
+    0x94b3a202eb1c3f39, 0x7bf7d71432f3d6a9,
+    0xb9e08a83a5e34f07, 0xdaf5ccd93fb0cc53,
+    0xe858ad248f5c22c9, 0xd1b3400f8f9cff68,
+    0x91376c36d99995be, 0x23100809b9c21fa1,
+    0xb58547448ffffb2d, 0xabd40a0c2832a78a,
+    0xe2e69915b3fff9f9, 0x16c90c8f323f516c,
+    0x8dd01fad907ffc3b, 0xae3da7d97f6792e3,
+    0xb1442798f49ffb4a, 0x99cd11cfdf41779c,
+    0xdd95317f31c7fa1d, 0x40405643d711d583,
+    0x8a7d3eef7f1cfc52, 0x482835ea666b2572,
+    0xad1c8eab5ee43b66, 0xda3243650005eecf,
+    0xd863b256369d4a40, 0x90bed43e40076a82,
+    0x873e4f75e2224e68, 0x5a7744a6e804a291,
+    0xa90de3535aaae202, 0x711515d0a205cb36,
+    0xd3515c2831559a83, 0x0d5a5b44ca873e03,
+    0x8412d9991ed58091, 0xe858790afe9486c2,
+    0xa5178fff668ae0b6, 0x626e974dbe39a872,
+    0xce5d73ff402d98e3, 0xfb0a3d212dc8128f,
+    0x80fa687f881c7f8e, 0x7ce66634bc9d0b99,
+    0xa139029f6a239f72, 0x1c1fffc1ebc44e80,
+    0xc987434744ac874e, 0xa327ffb266b56220,
+    0xfbe9141915d7a922, 0x4bf1ff9f0062baa8,
+    0x9d71ac8fada6c9b5, 0x6f773fc3603db4a9,
+    0xc4ce17b399107c22, 0xcb550fb4384d21d3,
+    0xf6019da07f549b2b, 0x7e2a53a146606a48,
+    0x99c102844f94e0fb, 0x2eda7444cbfc426d,
+    0xc0314325637a1939, 0xfa911155fefb5308,
+    0xf03d93eebc589f88, 0x793555ab7eba27ca,
+    0x96267c7535b763b5, 0x4bc1558b2f3458de,
+    0xbbb01b9283253ca2, 0x9eb1aaedfb016f16,
+    0xea9c227723ee8bcb, 0x465e15a979c1cadc,
+    0x92a1958a7675175f, 0x0bfacd89ec191ec9,
+    0xb749faed14125d36, 0xcef980ec671f667b,
+    0xe51c79a85916f484, 0x82b7e12780e7401a,
+    0x8f31cc0937ae58d2, 0xd1b2ecb8b0908810,
+    0xb2fe3f0b8599ef07, 0x861fa7e6dcb4aa15,
+    0xdfbdcece67006ac9, 0x67a791e093e1d49a,
+    0x8bd6a141006042bd, 0xe0c8bb2c5c6d24e0,
+    0xaecc49914078536d, 0x58fae9f773886e18,
+    0xda7f5bf590966848, 0xaf39a475506a899e,
+    0x888f99797a5e012d, 0x6d8406c952429603,
+    0xaab37fd7d8f58178, 0xc8e5087ba6d33b83,
+    0xd5605fcdcf32e1d6, 0xfb1e4a9a90880a64,
+    0x855c3be0a17fcd26, 0x5cf2eea09a55067f,
+    0xa6b34ad8c9dfc06f, 0xf42faa48c0ea481e,
+    0xd0601d8efc57b08b, 0xf13b94daf124da26,
+    0x823c12795db6ce57, 0x76c53d08d6b70858,
+    0xa2cb1717b52481ed, 0x54768c4b0c64ca6e,
+    0xcb7ddcdda26da268, 0xa9942f5dcf7dfd09,
+    0xfe5d54150b090b02, 0xd3f93b35435d7c4c,
+    0x9efa548d26e5a6e1, 0xc47bc5014a1a6daf,
+    0xc6b8e9b0709f109a, 0x359ab6419ca1091b,
+    0xf867241c8cc6d4c0, 0xc30163d203c94b62,
+    0x9b407691d7fc44f8, 0x79e0de63425dcf1d,
+    0xc21094364dfb5636, 0x985915fc12f542e4,
+    0xf294b943e17a2bc4, 0x3e6f5b7b17b2939d,
+    0x979cf3ca6cec5b5a, 0xa705992ceecf9c42,
+    0xbd8430bd08277231, 0x50c6ff782a838353,
+    0xece53cec4a314ebd, 0xa4f8bf5635246428,
+    0x940f4613ae5ed136, 0x871b7795e136be99,
+    0xb913179899f68584, 0x28e2557b59846e3f,
+    0xe757dd7ec07426e5, 0x331aeada2fe589cf,
+    0x9096ea6f3848984f, 0x3ff0d2c85def7621,
+    0xb4bca50b065abe63, 0x0fed077a756b53a9,
+    0xe1ebce4dc7f16dfb, 0xd3e8495912c62894,
+    0x8d3360f09cf6e4bd, 0x64712dd7abbbd95c,
+    0xb080392cc4349dec, 0xbd8d794d96aacfb3,
+    0xdca04777f541c567, 0xecf0d7a0fc5583a0,
+    0x89e42caaf9491b60, 0xf41686c49db57244,
+    0xac5d37d5b79b6239, 0x311c2875c522ced5,
+    0xd77485cb25823ac7, 0x7d633293366b828b,
+    0x86a8d39ef77164bc, 0xae5dff9c02033197,
+    0xa8530886b54dbdeb, 0xd9f57f830283fdfc,
+    0xd267caa862a12d66, 0xd072df63c324fd7b,
+    0x8380dea93da4bc60, 0x4247cb9e59f71e6d,
+    0xa46116538d0deb78, 0x52d9be85f074e608,
+    0xcd795be870516656, 0x67902e276c921f8b,
+    0x806bd9714632dff6, 0x00ba1cd8a3db53b6,
+    0xa086cfcd97bf97f3, 0x80e8a40eccd228a4,
+    0xc8a883c0fdaf7df0, 0x6122cd128006b2cd,
+    0xfad2a4b13d1b5d6c, 0x796b805720085f81,
+    0x9cc3a6eec6311a63, 0xcbe3303674053bb0,
+    0xc3f490aa77bd60fc, 0xbedbfc4411068a9c,
+    0xf4f1b4d515acb93b, 0xee92fb5515482d44,
+    0x991711052d8bf3c5, 0x751bdd152d4d1c4a,
+    0xbf5cd54678eef0b6, 0xd262d45a78a0635d,
+    0xef340a98172aace4, 0x86fb897116c87c34,
+    0x9580869f0e7aac0e, 0xd45d35e6ae3d4da0,
+    0xbae0a846d2195712, 0x8974836059cca109,
+    0xe998d258869facd7, 0x2bd1a438703fc94b,
+    0x91ff83775423cc06, 0x7b6306a34627ddcf,
+    0xb67f6455292cbf08, 0x1a3bc84c17b1d542,
+    0xe41f3d6a7377eeca, 0x20caba5f1d9e4a93,
+    0x8e938662882af53e, 0x547eb47b7282ee9c,
+    0xb23867fb2a35b28d, 0xe99e619a4f23aa43,
+    0xdec681f9f4c31f31, 0x6405fa00e2ec94d4,
+    0x8b3c113c38f9f37e, 0xde83bc408dd3dd04,
+    0xae0b158b4738705e, 0x9624ab50b148d445,
+    0xd98ddaee19068c76, 0x3badd624dd9b0957,
+    0x87f8a8d4cfa417c9, 0xe54ca5d70a80e5d6,
+    0xa9f6d30a038d1dbc, 0x5e9fcf4ccd211f4c,
+    0xd47487cc8470652b, 0x7647c3200069671f,
+    0x84c8d4dfd2c63f3b, 0x29ecd9f40041e073,
+    0xa5fb0a17c777cf09, 0xf468107100525890,
+    0xcf79cc9db955c2cc, 0x7182148d4066eeb4,
+    0x81ac1fe293d599bf, 0xc6f14cd848405530,
+    0xa21727db38cb002f, 0xb8ada00e5a506a7c,
+    0xca9cf1d206fdc03b, 0xa6d90811f0e4851c,
+    0xfd442e4688bd304a, 0x908f4a166d1da663,
+    0x9e4a9cec15763e2e, 0x9a598e4e043287fe,
+    0xc5dd44271ad3cdba, 0x40eff1e1853f29fd,
+    0xf7549530e188c128, 0xd12bee59e68ef47c,
+    0x9a94dd3e8cf578b9, 0x82bb74f8301958ce,
+    0xc13a148e3032d6e7, 0xe36a52363c1faf01,
+    0xf18899b1bc3f8ca1, 0xdc44e6c3cb279ac1,
+    0x96f5600f15a7b7e5, 0x29ab103a5ef8c0b9,
+    0xbcb2b812db11a5de, 0x7415d448f6b6f0e7,
+    0xebdf661791d60f56, 0x111b495b3464ad21,
+    0x936b9fcebb25c995, 0xcab10dd900beec34,
+    0xb84687c269ef3bfb, 0x3d5d514f40eea742,
+    0xe65829b3046b0afa, 0x0cb4a5a3112a5112,
+    0x8ff71a0fe2c2e6dc, 0x47f0e785eaba72ab,
+    0xb3f4e093db73a093, 0x59ed216765690f56,
+    0xe0f218b8d25088b8, 0x306869c13ec3532c,
+    0x8c974f7383725573, 0x1e414218c73a13fb,
+    0xafbd2350644eeacf, 0xe5d1929ef90898fa,
+    0xdbac6c247d62a583, 0xdf45f746b74abf39,
+    0x894bc396ce5da772, 0x6b8bba8c328eb783,
+    0xab9eb47c81f5114f, 0x066ea92f3f326564,
+    0xd686619ba27255a2, 0xc80a537b0efefebd,
+    0x8613fd0145877585, 0xbd06742ce95f5f36,
+    0xa798fc4196e952e7, 0x2c48113823b73704,
+    0xd17f3b51fca3a7a0, 0xf75a15862ca504c5,
+    0x82ef85133de648c4, 0x9a984d73dbe722fb,
+    0xa3ab66580d5fdaf5, 0xc13e60d0d2e0ebba,
+    0xcc963fee10b7d1b3, 0x318df905079926a8,
+    0xffbbcfe994e5c61f, 0xfdf17746497f7052,
+    0x9fd561f1fd0f9bd3, 0xfeb6ea8bedefa633,
+    0xc7caba6e7c5382c8, 0xfe64a52ee96b8fc0,
+    0xf9bd690a1b68637b, 0x3dfdce7aa3c673b0,
+    0x9c1661a651213e2d, 0x06bea10ca65c084e,
+    0xc31bfa0fe5698db8, 0x486e494fcff30a62,
+    0xf3e2f893dec3f126, 0x5a89dba3c3efccfa,
+    0x986ddb5c6b3a76b7, 0xf89629465a75e01c,
+    0xbe89523386091465, 0xf6bbb397f1135823,
+    0xee2ba6c0678b597f, 0x746aa07ded582e2c,
+    0x94db483840b717ef, 0xa8c2a44eb4571cdc,
+    0xba121a4650e4ddeb, 0x92f34d62616ce413,
+    0xe896a0d7e51e1566, 0x77b020baf9c81d17,
+    0x915e2486ef32cd60, 0x0ace1474dc1d122e,
+    0xb5b5ada8aaff80b8, 0x0d819992132456ba,
+    0xe3231912d5bf60e6, 0x10e1fff697ed6c69,
+    0x8df5efabc5979c8f, 0xca8d3ffa1ef463c1,
+    0xb1736b96b6fd83b3, 0xbd308ff8a6b17cb2,
+    0xddd0467c64bce4a0, 0xac7cb3f6d05ddbde,
+    0x8aa22c0dbef60ee4, 0x6bcdf07a423aa96b,
+    0xad4ab7112eb3929d, 0x86c16c98d2c953c6,
+    0xd89d64d57a607744, 0xe871c7bf077ba8b7,
+    0x87625f056c7c4a8b, 0x11471cd764ad4972,
+    0xa93af6c6c79b5d2d, 0xd598e40d3dd89bcf,
+    0xd389b47879823479, 0x4aff1d108d4ec2c3,
+    0x843610cb4bf160cb, 0xcedf722a585139ba,
+    0xa54394fe1eedb8fe, 0xc2974eb4ee658828,
+    0xce947a3da6a9273e, 0x733d226229feea32,
+    0x811ccc668829b887, 0x0806357d5a3f525f,
+    0xa163ff802a3426a8, 0xca07c2dcb0cf26f7,
+    0xc9bcff6034c13052, 0xfc89b393dd02f0b5,
+    0xfc2c3f3841f17c67, 0xbbac2078d443ace2,
+    0x9d9ba7832936edc0, 0xd54b944b84aa4c0d,
+    0xc5029163f384a931, 0x0a9e795e65d4df11,
+    0xf64335bcf065d37d, 0x4d4617b5ff4a16d5,
+    0x99ea0196163fa42e, 0x504bced1bf8e4e45,
+    0xc06481fb9bcf8d39, 0xe45ec2862f71e1d6,
+    0xf07da27a82c37088, 0x5d767327bb4e5a4c,
+    0x964e858c91ba2655, 0x3a6a07f8d510f86f,
+    0xbbe226efb628afea, 0x890489f70a55368b,
+    0xeadab0aba3b2dbe5, 0x2b45ac74ccea842e,
+    0x92c8ae6b464fc96f, 0x3b0b8bc90012929d,
+    0xb77ada0617e3bbcb, 0x09ce6ebb40173744,
+    0xe55990879ddcaabd, 0xcc420a6a101d0515,
+    0x8f57fa54c2a9eab6, 0x9fa946824a12232d,
+    0xb32df8e9f3546564, 0x47939822dc96abf9,
+    0xdff9772470297ebd, 0x59787e2b93bc56f7,
+    0x8bfbea76c619ef36, 0x57eb4edb3c55b65a,
+    0xaefae51477a06b03, 0xede622920b6b23f1,
+    0xdab99e59958885c4, 0xe95fab368e45eced,
+    0x88b402f7fd75539b, 0x11dbcb0218ebb414,
+    0xaae103b5fcd2a881, 0xd652bdc29f26a119,
+    0xd59944a37c0752a2, 0x4be76d3346f0495f,
+    0x857fcae62d8493a5, 0x6f70a4400c562ddb,
+    0xa6dfbd9fb8e5b88e, 0xcb4ccd500f6bb952,
+    0xd097ad07a71f26b2, 0x7e2000a41346a7a7,
+    0x825ecc24c873782f, 0x8ed400668c0c28c8,
+    0xa2f67f2dfa90563b, 0x728900802f0f32fa,
+    0xcbb41ef979346bca, 0x4f2b40a03ad2ffb9,
+    0xfea126b7d78186bc, 0xe2f610c84987bfa8,
+    0x9f24b832e6b0f436, 0x0dd9ca7d2df4d7c9,
+    0xc6ede63fa05d3143, 0x91503d1c79720dbb,
+    0xf8a95fcf88747d94, 0x75a44c6397ce912a,
+    0x9b69dbe1b548ce7c, 0xc986afbe3ee11aba,
+    0xc24452da229b021b, 0xfbe85badce996168,
+    0xf2d56790ab41c2a2, 0xfae27299423fb9c3,
+    0x97c560ba6b0919a5, 0xdccd879fc967d41a,
+    0xbdb6b8e905cb600f, 0x5400e987bbc1c920,
+    0xed246723473e3813, 0x290123e9aab23b68,
+    0x9436c0760c86e30b, 0xf9a0b6720aaf6521,
+    0xb94470938fa89bce, 0xf808e40e8d5b3e69,
+    0xe7958cb87392c2c2, 0xb60b1d1230b20e04,
+    0x90bd77f3483bb9b9, 0xb1c6f22b5e6f48c2,
+    0xb4ecd5f01a4aa828, 0x1e38aeb6360b1af3,
+    0xe2280b6c20dd5232, 0x25c6da63c38de1b0,
+    0x8d590723948a535f, 0x579c487e5a38ad0e,
+    0xb0af48ec79ace837, 0x2d835a9df0c6d851,
+    0xdcdb1b2798182244, 0xf8e431456cf88e65,
+    0x8a08f0f8bf0f156b, 0x1b8e9ecb641b58ff,
+    0xac8b2d36eed2dac5, 0xe272467e3d222f3f,
+    0xd7adf884aa879177, 0x5b0ed81dcc6abb0f,
+    0x86ccbb52ea94baea, 0x98e947129fc2b4e9,
+    0xa87fea27a539e9a5, 0x3f2398d747b36224,
+    0xd29fe4b18e88640e, 0x8eec7f0d19a03aad,
+    0x83a3eeeef9153e89, 0x1953cf68300424ac,
+    0xa48ceaaab75a8e2b, 0x5fa8c3423c052dd7,
+    0xcdb02555653131b6, 0x3792f412cb06794d,
+    0x808e17555f3ebf11, 0xe2bbd88bbee40bd0,
+    0xa0b19d2ab70e6ed6, 0x5b6aceaeae9d0ec4,
+    0xc8de047564d20a8b, 0xf245825a5a445275,
+    0xfb158592be068d2e, 0xeed6e2f0f0d56712,
+    0x9ced737bb6c4183d, 0x55464dd69685606b,
+    0xc428d05aa4751e4c, 0xaa97e14c3c26b886,
+    0xf53304714d9265df, 0xd53dd99f4b3066a8,
+    0x993fe2c6d07b7fab, 0xe546a8038efe4029,
+    0xbf8fdb78849a5f96, 0xde98520472bdd033,
+    0xef73d256a5c0f77c, 0x963e66858f6d4440,
+    0x95a8637627989aad, 0xdde7001379a44aa8,
+    0xbb127c53b17ec159, 0x5560c018580d5d52,
+    0xe9d71b689dde71af, 0xaab8f01e6e10b4a6,
+    0x9226712162ab070d, 0xcab3961304ca70e8,
+    0xb6b00d69bb55c8d1, 0x3d607b97c5fd0d22,
+    0xe45c10c42a2b3b05, 0x8cb89a7db77c506a,
+    0x8eb98a7a9a5b04e3, 0x77f3608e92adb242,
+    0xb267ed1940f1c61c, 0x55f038b237591ed3,
+    0xdf01e85f912e37a3, 0x6b6c46dec52f6688,
+    0x8b61313bbabce2c6, 0x2323ac4b3b3da015,
+    0xae397d8aa96c1b77, 0xabec975e0a0d081a,
+    0xd9c7dced53c72255, 0x96e7bd358c904a21,
+    0x881cea14545c7575, 0x7e50d64177da2e54,
+    0xaa242499697392d2, 0xdde50bd1d5d0b9e9,
+    0xd4ad2dbfc3d07787, 0x955e4ec64b44e864,
+    0x84ec3c97da624ab4, 0xbd5af13bef0b113e,
+    0xa6274bbdd0fadd61, 0xecb1ad8aeacdd58e,
+    0xcfb11ead453994ba, 0x67de18eda5814af2,
+    0x81ceb32c4b43fcf4, 0x80eacf948770ced7,
+    0xa2425ff75e14fc31, 0xa1258379a94d028d,
+    0xcad2f7f5359a3b3e, 0x096ee45813a04330,
+    0xfd87b5f28300ca0d, 0x8bca9d6e188853fc,
+    0x9e74d1b791e07e48, 0x775ea264cf55347e,
+    0xc612062576589dda, 0x95364afe032a819e,
+    0xf79687aed3eec551, 0x3a83ddbd83f52205,
+    0x9abe14cd44753b52, 0xc4926a9672793543,
+    0xc16d9a0095928a27, 0x75b7053c0f178294,
+    0xf1c90080baf72cb1, 0x5324c68b12dd6339,
+    0x971da05074da7bee, 0xd3f6fc16ebca5e04,
+    0xbce5086492111aea, 0x88f4bb1ca6bcf585,
+    0xec1e4a7db69561a5, 0x2b31e9e3d06c32e6,
+    0x9392ee8e921d5d07, 0x3aff322e62439fd0,
+    0xb877aa3236a4b449, 0x09befeb9fad487c3,
+    0xe69594bec44de15b, 0x4c2ebe687989a9b4,
+    0x901d7cf73ab0acd9, 0x0f9d37014bf60a11,
+    0xb424dc35095cd80f, 0x538484c19ef38c95,
+    0xe12e13424bb40e13, 0x2865a5f206b06fba,
+    0x8cbccc096f5088cb, 0xf93f87b7442e45d4,
+    0xafebff0bcb24aafe, 0xf78f69a51539d749,
+    0xdbe6fecebdedd5be, 0xb573440e5a884d1c,
+    0x89705f4136b4a597, 0x31680a88f8953031,
+    0xabcc77118461cefc, 0xfdc20d2b36ba7c3e,
+    0xd6bf94d5e57a42bc, 0x3d32907604691b4d,
+    0x8637bd05af6c69b5, 0xa63f9a49c2c1b110,
+    0xa7c5ac471b478423, 0x0fcf80dc33721d54,
+    0xd1b71758e219652b, 0xd3c36113404ea4a9,
+    0x83126e978d4fdf3b, 0x645a1cac083126ea,
+    0xa3d70a3d70a3d70a, 0x3d70a3d70a3d70a4,
+    0xcccccccccccccccc, 0xcccccccccccccccd,
+    0x8000000000000000, 0x0000000000000000,
+    0xa000000000000000, 0x0000000000000000,
+    0xc800000000000000, 0x0000000000000000,
+    0xfa00000000000000, 0x0000000000000000,
+    0x9c40000000000000, 0x0000000000000000,
+    0xc350000000000000, 0x0000000000000000,
+    0xf424000000000000, 0x0000000000000000,
+    0x9896800000000000, 0x0000000000000000,
+    0xbebc200000000000, 0x0000000000000000,
+    0xee6b280000000000, 0x0000000000000000,
+    0x9502f90000000000, 0x0000000000000000,
+    0xba43b74000000000, 0x0000000000000000,
+    0xe8d4a51000000000, 0x0000000000000000,
+    0x9184e72a00000000, 0x0000000000000000,
+    0xb5e620f480000000, 0x0000000000000000,
+    0xe35fa931a0000000, 0x0000000000000000,
+    0x8e1bc9bf04000000, 0x0000000000000000,
+    0xb1a2bc2ec5000000, 0x0000000000000000,
+    0xde0b6b3a76400000, 0x0000000000000000,
+    0x8ac7230489e80000, 0x0000000000000000,
+    0xad78ebc5ac620000, 0x0000000000000000,
+    0xd8d726b7177a8000, 0x0000000000000000,
+    0x878678326eac9000, 0x0000000000000000,
+    0xa968163f0a57b400, 0x0000000000000000,
+    0xd3c21bcecceda100, 0x0000000000000000,
+    0x84595161401484a0, 0x0000000000000000,
+    0xa56fa5b99019a5c8, 0x0000000000000000,
+    0xcecb8f27f4200f3a, 0x0000000000000000,
+    0x813f3978f8940984, 0x4000000000000000,
+    0xa18f07d736b90be5, 0x5000000000000000,
+    0xc9f2c9cd04674ede, 0xa400000000000000,
+    0xfc6f7c4045812296, 0x4d00000000000000,
+    0x9dc5ada82b70b59d, 0xf020000000000000,
+    0xc5371912364ce305, 0x6c28000000000000,
+    0xf684df56c3e01bc6, 0xc732000000000000,
+    0x9a130b963a6c115c, 0x3c7f400000000000,
+    0xc097ce7bc90715b3, 0x4b9f100000000000,
+    0xf0bdc21abb48db20, 0x1e86d40000000000,
+    0x96769950b50d88f4, 0x1314448000000000,
+    0xbc143fa4e250eb31, 0x17d955a000000000,
+    0xeb194f8e1ae525fd, 0x5dcfab0800000000,
+    0x92efd1b8d0cf37be, 0x5aa1cae500000000,
+    0xb7abc627050305ad, 0xf14a3d9e40000000,
+    0xe596b7b0c643c719, 0x6d9ccd05d0000000,
+    0x8f7e32ce7bea5c6f, 0xe4820023a2000000,
+    0xb35dbf821ae4f38b, 0xdda2802c8a800000,
+    0xe0352f62a19e306e, 0xd50b2037ad200000,
+    0x8c213d9da502de45, 0x4526f422cc340000,
+    0xaf298d050e4395d6, 0x9670b12b7f410000,
+    0xdaf3f04651d47b4c, 0x3c0cdd765f114000,
+    0x88d8762bf324cd0f, 0xa5880a69fb6ac800,
+    0xab0e93b6efee0053, 0x8eea0d047a457a00,
+    0xd5d238a4abe98068, 0x72a4904598d6d880,
+    0x85a36366eb71f041, 0x47a6da2b7f864750,
+    0xa70c3c40a64e6c51, 0x999090b65f67d924,
+    0xd0cf4b50cfe20765, 0xfff4b4e3f741cf6d,
+    0x82818f1281ed449f, 0xbff8f10e7a8921a4,
+    0xa321f2d7226895c7, 0xaff72d52192b6a0d,
+    0xcbea6f8ceb02bb39, 0x9bf4f8a69f764490,
+    0xfee50b7025c36a08, 0x02f236d04753d5b4,
+    0x9f4f2726179a2245, 0x01d762422c946590,
+    0xc722f0ef9d80aad6, 0x424d3ad2b7b97ef5,
+    0xf8ebad2b84e0d58b, 0xd2e0898765a7deb2,
+    0x9b934c3b330c8577, 0x63cc55f49f88eb2f,
+    0xc2781f49ffcfa6d5, 0x3cbf6b71c76b25fb,
+    0xf316271c7fc3908a, 0x8bef464e3945ef7a,
+    0x97edd871cfda3a56, 0x97758bf0e3cbb5ac,
+    0xbde94e8e43d0c8ec, 0x3d52eeed1cbea317,
+    0xed63a231d4c4fb27, 0x4ca7aaa863ee4bdd,
+    0x945e455f24fb1cf8, 0x8fe8caa93e74ef6a,
+    0xb975d6b6ee39e436, 0xb3e2fd538e122b44,
+    0xe7d34c64a9c85d44, 0x60dbbca87196b616,
+    0x90e40fbeea1d3a4a, 0xbc8955e946fe31cd,
+    0xb51d13aea4a488dd, 0x6babab6398bdbe41,
+    0xe264589a4dcdab14, 0xc696963c7eed2dd1,
+    0x8d7eb76070a08aec, 0xfc1e1de5cf543ca2,
+    0xb0de65388cc8ada8, 0x3b25a55f43294bcb,
+    0xdd15fe86affad912, 0x49ef0eb713f39ebe,
+    0x8a2dbf142dfcc7ab, 0x6e3569326c784337,
+    0xacb92ed9397bf996, 0x49c2c37f07965404,
+    0xd7e77a8f87daf7fb, 0xdc33745ec97be906,
+    0x86f0ac99b4e8dafd, 0x69a028bb3ded71a3,
+    0xa8acd7c0222311bc, 0xc40832ea0d68ce0c,
+    0xd2d80db02aabd62b, 0xf50a3fa490c30190,
+    0x83c7088e1aab65db, 0x792667c6da79e0fa,
+    0xa4b8cab1a1563f52, 0x577001b891185938,
+    0xcde6fd5e09abcf26, 0xed4c0226b55e6f86,
+    0x80b05e5ac60b6178, 0x544f8158315b05b4,
+    0xa0dc75f1778e39d6, 0x696361ae3db1c721,
+    0xc913936dd571c84c, 0x03bc3a19cd1e38e9,
+    0xfb5878494ace3a5f, 0x04ab48a04065c723,
+    0x9d174b2dcec0e47b, 0x62eb0d64283f9c76,
+    0xc45d1df942711d9a, 0x3ba5d0bd324f8394,
+    0xf5746577930d6500, 0xca8f44ec7ee36479,
+    0x9968bf6abbe85f20, 0x7e998b13cf4e1ecb,
+    0xbfc2ef456ae276e8, 0x9e3fedd8c321a67e,
+    0xefb3ab16c59b14a2, 0xc5cfe94ef3ea101e,
+    0x95d04aee3b80ece5, 0xbba1f1d158724a12,
+    0xbb445da9ca61281f, 0x2a8a6e45ae8edc97,
+    0xea1575143cf97226, 0xf52d09d71a3293bd,
+    0x924d692ca61be758, 0x593c2626705f9c56,
+    0xb6e0c377cfa2e12e, 0x6f8b2fb00c77836c,
+    0xe498f455c38b997a, 0x0b6dfb9c0f956447,
+    0x8edf98b59a373fec, 0x4724bd4189bd5eac,
+    0xb2977ee300c50fe7, 0x58edec91ec2cb657,
+    0xdf3d5e9bc0f653e1, 0x2f2967b66737e3ed,
+    0x8b865b215899f46c, 0xbd79e0d20082ee74,
+    0xae67f1e9aec07187, 0xecd8590680a3aa11,
+    0xda01ee641a708de9, 0xe80e6f4820cc9495,
+    0x884134fe908658b2, 0x3109058d147fdcdd,
+    0xaa51823e34a7eede, 0xbd4b46f0599fd415,
+    0xd4e5e2cdc1d1ea96, 0x6c9e18ac7007c91a,
+    0x850fadc09923329e, 0x03e2cf6bc604ddb0,
+    0xa6539930bf6bff45, 0x84db8346b786151c,
+    0xcfe87f7cef46ff16, 0xe612641865679a63,
+    0x81f14fae158c5f6e, 0x4fcb7e8f3f60c07e,
+    0xa26da3999aef7749, 0xe3be5e330f38f09d,
+    0xcb090c8001ab551c, 0x5cadf5bfd3072cc5,
+    0xfdcb4fa002162a63, 0x73d9732fc7c8f7f6,
+    0x9e9f11c4014dda7e, 0x2867e7fddcdd9afa,
+    0xc646d63501a1511d, 0xb281e1fd541501b8,
+    0xf7d88bc24209a565, 0x1f225a7ca91a4226,
+    0x9ae757596946075f, 0x3375788de9b06958,
+    0xc1a12d2fc3978937, 0x0052d6b1641c83ae,
+    0xf209787bb47d6b84, 0xc0678c5dbd23a49a,
+    0x9745eb4d50ce6332, 0xf840b7ba963646e0,
+    0xbd176620a501fbff, 0xb650e5a93bc3d898,
+    0xec5d3fa8ce427aff, 0xa3e51f138ab4cebe,
+    0x93ba47c980e98cdf, 0xc66f336c36b10137,
+    0xb8a8d9bbe123f017, 0xb80b0047445d4184,
+    0xe6d3102ad96cec1d, 0xa60dc059157491e5,
+    0x9043ea1ac7e41392, 0x87c89837ad68db2f,
+    0xb454e4a179dd1877, 0x29babe4598c311fb,
+    0xe16a1dc9d8545e94, 0xf4296dd6fef3d67a,
+    0x8ce2529e2734bb1d, 0x1899e4a65f58660c,
+    0xb01ae745b101e9e4, 0x5ec05dcff72e7f8f,
+    0xdc21a1171d42645d, 0x76707543f4fa1f73,
+    0x899504ae72497eba, 0x6a06494a791c53a8,
+    0xabfa45da0edbde69, 0x0487db9d17636892,
+    0xd6f8d7509292d603, 0x45a9d2845d3c42b6,
+    0x865b86925b9bc5c2, 0x0b8a2392ba45a9b2,
+    0xa7f26836f282b732, 0x8e6cac7768d7141e,
+    0xd1ef0244af2364ff, 0x3207d795430cd926,
+    0x8335616aed761f1f, 0x7f44e6bd49e807b8,
+    0xa402b9c5a8d3a6e7, 0x5f16206c9c6209a6,
+    0xcd036837130890a1, 0x36dba887c37a8c0f,
+    0x802221226be55a64, 0xc2494954da2c9789,
+    0xa02aa96b06deb0fd, 0xf2db9baa10b7bd6c,
+    0xc83553c5c8965d3d, 0x6f92829494e5acc7,
+    0xfa42a8b73abbf48c, 0xcb772339ba1f17f9,
+    0x9c69a97284b578d7, 0xff2a760414536efb,
+    0xc38413cf25e2d70d, 0xfef5138519684aba,
+    0xf46518c2ef5b8cd1, 0x7eb258665fc25d69,
+    0x98bf2f79d5993802, 0xef2f773ffbd97a61,
+    0xbeeefb584aff8603, 0xaafb550ffacfd8fa,
+    0xeeaaba2e5dbf6784, 0x95ba2a53f983cf38,
+    0x952ab45cfa97a0b2, 0xdd945a747bf26183,
+    0xba756174393d88df, 0x94f971119aeef9e4,
+    0xe912b9d1478ceb17, 0x7a37cd5601aab85d,
+    0x91abb422ccb812ee, 0xac62e055c10ab33a,
+    0xb616a12b7fe617aa, 0x577b986b314d6009,
+    0xe39c49765fdf9d94, 0xed5a7e85fda0b80b,
+    0x8e41ade9fbebc27d, 0x14588f13be847307,
+    0xb1d219647ae6b31c, 0x596eb2d8ae258fc8,
+    0xde469fbd99a05fe3, 0x6fca5f8ed9aef3bb,
+    0x8aec23d680043bee, 0x25de7bb9480d5854,
+    0xada72ccc20054ae9, 0xaf561aa79a10ae6a,
+    0xd910f7ff28069da4, 0x1b2ba1518094da04,
+    0x87aa9aff79042286, 0x90fb44d2f05d0842,
+    0xa99541bf57452b28, 0x353a1607ac744a53,
+    0xd3fa922f2d1675f2, 0x42889b8997915ce8,
+    0x847c9b5d7c2e09b7, 0x69956135febada11,
+    0xa59bc234db398c25, 0x43fab9837e699095,
+    0xcf02b2c21207ef2e, 0x94f967e45e03f4bb,
+    0x8161afb94b44f57d, 0x1d1be0eebac278f5,
+    0xa1ba1ba79e1632dc, 0x6462d92a69731732,
+    0xca28a291859bbf93, 0x7d7b8f7503cfdcfe,
+    0xfcb2cb35e702af78, 0x5cda735244c3d43e,
+    0x9defbf01b061adab, 0x3a0888136afa64a7,
+    0xc56baec21c7a1916, 0x088aaa1845b8fdd0,
+    0xf6c69a72a3989f5b, 0x8aad549e57273d45,
+    0x9a3c2087a63f6399, 0x36ac54e2f678864b,
+    0xc0cb28a98fcf3c7f, 0x84576a1bb416a7dd,
+    0xf0fdf2d3f3c30b9f, 0x656d44a2a11c51d5,
+    0x969eb7c47859e743, 0x9f644ae5a4b1b325,
+    0xbc4665b596706114, 0x873d5d9f0dde1fee,
+    0xeb57ff22fc0c7959, 0xa90cb506d155a7ea,
+    0x9316ff75dd87cbd8, 0x09a7f12442d588f2,
+    0xb7dcbf5354e9bece, 0x0c11ed6d538aeb2f,
+    0xe5d3ef282a242e81, 0x8f1668c8a86da5fa,
+    0x8fa475791a569d10, 0xf96e017d694487bc,
+    0xb38d92d760ec4455, 0x37c981dcc395a9ac,
+    0xe070f78d3927556a, 0x85bbe253f47b1417,
+    0x8c469ab843b89562, 0x93956d7478ccec8e,
+    0xaf58416654a6babb, 0x387ac8d1970027b2,
+    0xdb2e51bfe9d0696a, 0x06997b05fcc0319e,
+    0x88fcf317f22241e2, 0x441fece3bdf81f03,
+    0xab3c2fddeeaad25a, 0xd527e81cad7626c3,
+    0xd60b3bd56a5586f1, 0x8a71e223d8d3b074,
+    0x85c7056562757456, 0xf6872d5667844e49,
+    0xa738c6bebb12d16c, 0xb428f8ac016561db,
+    0xd106f86e69d785c7, 0xe13336d701beba52,
+    0x82a45b450226b39c, 0xecc0024661173473,
+    0xa34d721642b06084, 0x27f002d7f95d0190,
+    0xcc20ce9bd35c78a5, 0x31ec038df7b441f4,
+    0xff290242c83396ce, 0x7e67047175a15271,
+    0x9f79a169bd203e41, 0x0f0062c6e984d386,
+    0xc75809c42c684dd1, 0x52c07b78a3e60868,
+    0xf92e0c3537826145, 0xa7709a56ccdf8a82,
+    0x9bbcc7a142b17ccb, 0x88a66076400bb691,
+    0xc2abf989935ddbfe, 0x6acff893d00ea435,
+    0xf356f7ebf83552fe, 0x0583f6b8c4124d43,
+    0x98165af37b2153de, 0xc3727a337a8b704a,
+    0xbe1bf1b059e9a8d6, 0x744f18c0592e4c5c,
+    0xeda2ee1c7064130c, 0x1162def06f79df73,
+    0x9485d4d1c63e8be7, 0x8addcb5645ac2ba8,
+    0xb9a74a0637ce2ee1, 0x6d953e2bd7173692,
+    0xe8111c87c5c1ba99, 0xc8fa8db6ccdd0437,
+    0x910ab1d4db9914a0, 0x1d9c9892400a22a2,
+    0xb54d5e4a127f59c8, 0x2503beb6d00cab4b,
+    0xe2a0b5dc971f303a, 0x2e44ae64840fd61d,
+    0x8da471a9de737e24, 0x5ceaecfed289e5d2,
+    0xb10d8e1456105dad, 0x7425a83e872c5f47,
+    0xdd50f1996b947518, 0xd12f124e28f77719,
+    0x8a5296ffe33cc92f, 0x82bd6b70d99aaa6f,
+    0xace73cbfdc0bfb7b, 0x636cc64d1001550b,
+    0xd8210befd30efa5a, 0x3c47f7e05401aa4e,
+    0x8714a775e3e95c78, 0x65acfaec34810a71,
+    0xa8d9d1535ce3b396, 0x7f1839a741a14d0d,
+    0xd31045a8341ca07c, 0x1ede48111209a050,
+    0x83ea2b892091e44d, 0x934aed0aab460432,
+    0xa4e4b66b68b65d60, 0xf81da84d5617853f,
+    0xce1de40642e3f4b9, 0x36251260ab9d668e,
+    0x80d2ae83e9ce78f3, 0xc1d72b7c6b426019,
+    0xa1075a24e4421730, 0xb24cf65b8612f81f,
+    0xc94930ae1d529cfc, 0xdee033f26797b627,
+    0xfb9b7cd9a4a7443c, 0x169840ef017da3b1,
+    0x9d412e0806e88aa5, 0x8e1f289560ee864e,
+    0xc491798a08a2ad4e, 0xf1a6f2bab92a27e2,
+    0xf5b5d7ec8acb58a2, 0xae10af696774b1db,
+    0x9991a6f3d6bf1765, 0xacca6da1e0a8ef29,
+    0xbff610b0cc6edd3f, 0x17fd090a58d32af3,
+    0xeff394dcff8a948e, 0xddfc4b4cef07f5b0,
+    0x95f83d0a1fb69cd9, 0x4abdaf101564f98e,
+    0xbb764c4ca7a4440f, 0x9d6d1ad41abe37f1,
+    0xea53df5fd18d5513, 0x84c86189216dc5ed,
+    0x92746b9be2f8552c, 0x32fd3cf5b4e49bb4,
+    0xb7118682dbb66a77, 0x3fbc8c33221dc2a1,
+    0xe4d5e82392a40515, 0x0fabaf3feaa5334a,
+    0x8f05b1163ba6832d, 0x29cb4d87f2a7400e,
+    0xb2c71d5bca9023f8, 0x743e20e9ef511012,
+    0xdf78e4b2bd342cf6, 0x914da9246b255416,
+    0x8bab8eefb6409c1a, 0x1ad089b6c2f7548e,
+    0xae9672aba3d0c320, 0xa184ac2473b529b1,
+    0xda3c0f568cc4f3e8, 0xc9e5d72d90a2741e,
+    0x8865899617fb1871, 0x7e2fa67c7a658892,
+    0xaa7eebfb9df9de8d, 0xddbb901b98feeab7,
+    0xd51ea6fa85785631, 0x552a74227f3ea565,
+    0x8533285c936b35de, 0xd53a88958f87275f,
+    0xa67ff273b8460356, 0x8a892abaf368f137,
+    0xd01fef10a657842c, 0x2d2b7569b0432d85,
+    0x8213f56a67f6b29b, 0x9c3b29620e29fc73,
+    0xa298f2c501f45f42, 0x8349f3ba91b47b8f,
+    0xcb3f2f7642717713, 0x241c70a936219a73,
+    0xfe0efb53d30dd4d7, 0xed238cd383aa0110,
+    0x9ec95d1463e8a506, 0xf4363804324a40aa,
+    0xc67bb4597ce2ce48, 0xb143c6053edcd0d5,
+    0xf81aa16fdc1b81da, 0xdd94b7868e94050a,
+    0x9b10a4e5e9913128, 0xca7cf2b4191c8326,
+    0xc1d4ce1f63f57d72, 0xfd1c2f611f63a3f0,
+    0xf24a01a73cf2dccf, 0xbc633b39673c8cec,
+    0x976e41088617ca01, 0xd5be0503e085d813,
+    0xbd49d14aa79dbc82, 0x4b2d8644d8a74e18,
+    0xec9c459d51852ba2, 0xddf8e7d60ed1219e,
+    0x93e1ab8252f33b45, 0xcabb90e5c942b503,
+    0xb8da1662e7b00a17, 0x3d6a751f3b936243,
+    0xe7109bfba19c0c9d, 0x0cc512670a783ad4,
+    0x906a617d450187e2, 0x27fb2b80668b24c5,
+    0xb484f9dc9641e9da, 0xb1f9f660802dedf6,
+    0xe1a63853bbd26451, 0x5e7873f8a0396973,
+    0x8d07e33455637eb2, 0xdb0b487b6423e1e8,
+    0xb049dc016abc5e5f, 0x91ce1a9a3d2cda62,
+    0xdc5c5301c56b75f7, 0x7641a140cc7810fb,
+    0x89b9b3e11b6329ba, 0xa9e904c87fcb0a9d,
+    0xac2820d9623bf429, 0x546345fa9fbdcd44,
+    0xd732290fbacaf133, 0xa97c177947ad4095,
+    0x867f59a9d4bed6c0, 0x49ed8eabcccc485d,
+    0xa81f301449ee8c70, 0x5c68f256bfff5a74,
+    0xd226fc195c6a2f8c, 0x73832eec6fff3111,
+    0x83585d8fd9c25db7, 0xc831fd53c5ff7eab,
+    0xa42e74f3d032f525, 0xba3e7ca8b77f5e55,
+    0xcd3a1230c43fb26f, 0x28ce1bd2e55f35eb,
+    0x80444b5e7aa7cf85, 0x7980d163cf5b81b3,
+    0xa0555e361951c366, 0xd7e105bcc332621f,
+    0xc86ab5c39fa63440, 0x8dd9472bf3fefaa7,
+    0xfa856334878fc150, 0xb14f98f6f0feb951,
+    0x9c935e00d4b9d8d2, 0x6ed1bf9a569f33d3,
+    0xc3b8358109e84f07, 0x0a862f80ec4700c8,
+    0xf4a642e14c6262c8, 0xcd27bb612758c0fa,
+    0x98e7e9cccfbd7dbd, 0x8038d51cb897789c,
+    0xbf21e44003acdd2c, 0xe0470a63e6bd56c3,
+    0xeeea5d5004981478, 0x1858ccfce06cac74,
+    0x95527a5202df0ccb, 0x0f37801e0c43ebc8,
+    0xbaa718e68396cffd, 0xd30560258f54e6ba,
+    0xe950df20247c83fd, 0x47c6b82ef32a2069,
+    0x91d28b7416cdd27e, 0x4cdc331d57fa5441,
+    0xb6472e511c81471d, 0xe0133fe4adf8e952,
+    0xe3d8f9e563a198e5, 0x58180fddd97723a6,
+    0x8e679c2f5e44ff8f, 0x570f09eaa7ea7648,
+};
+
+}
+
+#endif // ZEN_FMT_TABLES_H
@@ -6,8 +6,8 @@
 namespace zen {
 
 // Handle define macros
-#define ZEN_DEFINE_HANDLE(name, type)             using name = handle<type, 0, struct name ## tag>
-#define ZEN_DEFINE_HANDLE_INFO(name, type, ninfo) using name = handle<type, ninfo, struct name ## tag>
+#define ZEN_DEFINE_HANDLE(name, type)             using name = zen::handle<type, 0, struct name ## tag>
+#define ZEN_DEFINE_HANDLE_INFO(name, type, ninfo) using name = zen::handle<type, ninfo, struct name ## tag>
 
 
 // Handle with info bits
@@ -15,27 +15,27 @@ template<typename T, usize NInfoBits = 0, typename Tag = void>
 struct handle {
     using type = T;
 
-    ZEN_FORCEINLINE constexpr handle() : value{INVALID}, info{0} {}
-    ZEN_FORCEINLINE constexpr handle(T id, T info) noexcept : value{id}, info{info} {}
-    ZEN_FORCEINLINE explicit constexpr handle(T id) noexcept : value{id}, info{0} {}
+    ZEN_FORCEINLINE constexpr handle() : m_value{INVALID}, m_info{0} {}
+    ZEN_FORCEINLINE constexpr handle(T id, T info) noexcept : m_value{id}, m_info{info} {}
+    ZEN_FORCEINLINE explicit constexpr handle(T id) noexcept : m_value{id}, m_info{0} {}
 
-    ZEN_FORCEINLINE          constexpr operator T   () const noexcept { return value; }
-    ZEN_FORCEINLINE explicit constexpr operator bool() const noexcept { return value != INVALID; }
+    ZEN_FORCEINLINE          constexpr operator T   () const noexcept { return m_value; }
+    ZEN_FORCEINLINE explicit constexpr operator bool() const noexcept { return m_value != INVALID; }
 
-    ZEN_FORCEINLINE constexpr T      info()          const noexcept { return info; }
-    ZEN_FORCEINLINE constexpr T      value()         const noexcept { return value; }
-    ZEN_FORCEINLINE constexpr bool   valid()         const noexcept { return value != INVALID; }
-    ZEN_FORCEINLINE constexpr handle with_info(T i)  const noexcept { return handle{value, i}; }
-    ZEN_FORCEINLINE constexpr handle with_value(T v) const noexcept { return handle{v, info}; }
+    ZEN_FORCEINLINE constexpr T      info()          const noexcept { return m_info; }
+    ZEN_FORCEINLINE constexpr T      value()         const noexcept { return m_value; }
+    ZEN_FORCEINLINE constexpr bool   valid()         const noexcept { return m_value != INVALID; }
+    ZEN_FORCEINLINE constexpr handle with_info(T i)  const noexcept { return handle{m_value, i}; }
+    ZEN_FORCEINLINE constexpr handle with_value(T v) const noexcept { return handle{v, m_info}; }
 
-    ZEN_FORCEINLINE constexpr bool operator==(const handle& h) const noexcept { return value == h.value && info == h.info; }
-    ZEN_FORCEINLINE constexpr bool operator!=(const handle& h) const noexcept { return value != h.value || info != h.info; }
+    ZEN_FORCEINLINE constexpr bool operator==(const handle& h) const noexcept { return m_value == h.m_value && m_info == h.m_info; }
+    ZEN_FORCEINLINE constexpr bool operator!=(const handle& h) const noexcept { return m_value != h.m_value || m_info != h.m_info; }
 
 private:
     static constexpr usize NBits = sizeof(T) * 8;
     static constexpr T INVALID   = 0;
-    T value: NBits - NInfoBits;
-    T info : NInfoBits;
+    T m_value: NBits - NInfoBits;
+    T m_info : NInfoBits;
 };
 
 
@@ -44,21 +44,21 @@ template<typename T, typename Tag>
 struct handle<T, 0, Tag> {
     using type = T;
 
-    ZEN_FORCEINLINE constexpr handle() noexcept : value{INVALID} {}
-    ZEN_FORCEINLINE explicit constexpr handle(T id) noexcept : value{id} {}
+    ZEN_FORCEINLINE constexpr handle() noexcept : m_value{INVALID} {}
+    ZEN_FORCEINLINE explicit constexpr handle(T id) noexcept : m_value{id} {}
 
-             constexpr operator T   () const noexcept { return value; }
-    explicit constexpr operator bool() const noexcept { return value != INVALID; }
+             constexpr operator T   () const noexcept { return m_value; }
+    explicit constexpr operator bool() const noexcept { return m_value != INVALID; }
 
-    constexpr T    value() const noexcept { return value; }
-    constexpr bool valid() const noexcept { return value != INVALID; }
+    constexpr T    value() const noexcept { return m_value; }
+    constexpr bool valid() const noexcept { return m_value != INVALID; }
 
-    ZEN_FORCEINLINE constexpr bool operator==(const handle& h) const noexcept { return value == h.value; }
-    ZEN_FORCEINLINE constexpr bool operator!=(const handle& h) const noexcept { return value != h.value; }
+    ZEN_FORCEINLINE constexpr bool operator==(const handle& h) const noexcept { return m_value == h.m_value; }
+    ZEN_FORCEINLINE constexpr bool operator!=(const handle& h) const noexcept { return m_value != h.m_value; }
 
 private:
     static constexpr T INVALID   = T(UINT64_MAX);
-    T value{};
+    T m_value{};
 };
 
 }
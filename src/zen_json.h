@@ -0,0 +1,325 @@
+#ifndef ZEN_JSON_H
+#define ZEN_JSON_H
+
+#include "zen_fmt.h"
+
+namespace zen {
+
+namespace json {
+
+enum class layout : u8 {
+    compact,    // No whitespace at all
+    pretty      // One value or member per line, indented by PRETTY_INDENT per level
+};
+
+static constexpr usize PRETTY_INDENT = 2;
+
+// Objects and arrays nest at most this deep
+static constexpr usize MAX_DEPTH = 64;
+
+// Writes s as a quoted JSON string, escaping quotes, backslashes and control chars
+template<typename Out>
+void write_string(Out& out, string_view s) noexcept;
+
+}
+
+// Streaming JSON output to a zen sink, structure mistakes assert in debug builds
+//
+//  fmt::dynamic_buffer<> out{};
+//  json_writer json{out};
+//  json.begin_object().member("id", 7).key("tags").begin_array().value("a").end_array().end_object();   // {"id":7,"tags":["a"]}
+//
+// With a sink reference the writer writes to that sink, otherwise it owns a Sink and
+// reset() clears it for the next document, keeping whatever memory it grew to
+template<typename Sink = fmt::dynamic_buffer<>>
+struct json_writer {
+    using sink_type = std::remove_reference_t<Sink>;
+
+    static_assert(fmt::impl::is_sink<sink_type>, "json_writer writes to zen sinks");
+
+    template<typename S = Sink, typename = std::enable_if_t<std::is_reference_v<S>>>
+    explicit json_writer(sink_type& out, json::layout layout = json::layout::compact) noexcept
+        : m_out{out}, m_pretty{layout == json::layout::pretty} {}
+
+    template<typename S = Sink, typename = std::enable_if_t<!std::is_reference_v<S>>>
+    explicit json_writer(json::layout layout = json::layout::compact) noexcept
+        : m_out{}, m_pretty{layout == json::layout::pretty} {}
+
+    ZEN_ND sink_type&       sink()              noexcept { return m_out; }
+    ZEN_ND const sink_type& sink()        const noexcept { return m_out; }
+    ZEN_ND usize            depth()       const noexcept { return m_depth; }
+
+    // The root value was written and every object and array was closed
+    ZEN_ND bool             complete()    const noexcept { return m_depth == 0 && m_has_items; }
+
+    // Starts the next document, the owned sink is cleared
+    void reset() noexcept;
+
+    json_writer& begin_object() noexcept { return begin(true, '{'); }
+    json_writer& end_object()   noexcept { return end(true, '}'); }
+    json_writer& begin_array()  noexcept { return begin(false, '['); }
+    json_writer& end_array()    noexcept { return end(false, ']'); }
+
+    // Name of the next member of the current object
+    json_writer& key(string_view name) noexcept;
+
+    // Strings, chars, bools, integers, floats (non-finite ones as null) and nullptr
+    template<typename T>
+    json_writer& value(const T& v) noexcept;
+
+    json_writer& null() noexcept { return value(nullptr); }
+
+    // Already encoded JSON written as the next value, for example a cached fragment
+    json_writer& raw(string_view json) noexcept;
+
+    template<typename T>
+    json_writer& member(string_view name, const T& v) noexcept { return key(name).value(v); }
+
+private:
+    json_writer& begin(bool object, char c) noexcept;
+    json_writer& end(bool object, char c) noexcept;
+    void before_value() noexcept;
+    void separate() noexcept;
+
+    ZEN_ND bool in_object() const noexcept { return m_depth > 0 && ((m_objects >> (m_depth - 1)) & 1); }
+
+    Sink m_out;
+    u64  m_objects{};       // Bit i is set when level i + 1 is an object
+    u8   m_depth{};
+    bool m_has_items{};     // The current level has a value, so the next one needs a comma
+    bool m_after_key{};     // A key was written and its value is next
+    bool m_pretty{};
+};
+
+template<typename Sink>
+json_writer(Sink&, json::layout = json::layout::compact) -> json_writer<Sink&>;
+
+}
+
+
+// JSON impl
+namespace zen::json::impl {
+
+// Char written after the backslash for chars a string must escape, 'u' for \u00XX, 0 for chars written as is
+static constexpr auto ESCAPES = []{
+    struct { char data[256]; } t{};
+    for (u32 i = 0; i < 0x20; ++i)
+        t.data[i] = 'u';
+    t.data[u8('\b')] = 'b';
+    t.data[u8('\f')] = 'f';
+    t.data[u8('\n')] = 'n';
+    t.data[u8('\r')] = 'r';
+    t.data[u8('\t')] = 't';
+    t.data[u8('"')]  = '"';
+    t.data[u8('\\')] = '\\';
+    return t;
+}();
+
+// Chars of a string written at most once per reserve, at most 6 chars each
+static constexpr usize STRING_CHUNK = 64;
+static_assert(STRING_CHUNK * 6 + 2 <= fmt::impl::MAX_CONVERSION_LEN);
+
+ZEN_FORCEINLINE char* escape_char(char* p, char c) noexcept {
+    const char e = ESCAPES.data[u8(c)];
+    p[0] = '\\';
+    p[1] = e;
+    if (e != 'u') 
+        return p + 2;
+    p[2] = '0';
+    p[3] = '0';
+    p[4] = fmt::impl::DIGIT_CHARS[u8(c) >> 4];
+    p[5] = fmt::impl::DIGIT_CHARS[u8(c) & 15];
+    return p + 6;
+}
+
+// Escapes [it, end) to p, which has room for 6 chars per input char
+// Whole vectors are stored before they are checked, so clean text costs one compare per 16 or 32 chars 
+// and the output only moves past the chars before the first one that needs escaping
+inline char* escape(char* p, const char* it, const char* end) noexcept {
+    #ifdef ZEN_AVX2
+    {
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i control = _mm256_set1_epi8(0x1f);
+        while (end - it >= 32) {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+            // Unsigned x <= 0x1f, bytes above 0x7f must not count as control chars
+            const __m256i low = _mm256_cmpeq_epi8(_mm256_max_epu8(x, control), control);
+            const __m256i bad = _mm256_or_si256(low, _mm256_or_si256(_mm256_cmpeq_epi8(x, quote), _mm256_cmpeq_epi8(x, backslash)));
+            const u32 mask = u32(_mm256_movemask_epi8(bad));
+            if (mask == 0) { 
+                it += 32; 
+                p += 32; 
+                continue; 
+            }
+            const usize n = trailing_zeros(mask);
+            p = escape_char(p + n, it[n]);
+            it += n + 1;
+        }
+    }
+    #endif
+    #ifdef ZEN_SSE2
+    {
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i control = _mm_set1_epi8(0x1f);
+        while (end - it >= 16) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p), x);
+            const __m128i low = _mm_cmpeq_epi8(_mm_max_epu8(x, control), control);
+            const __m128i bad = _mm_or_si128(low, _mm_or_si128(_mm_cmpeq_epi8(x, quote), _mm_cmpeq_epi8(x, backslash)));
+            const u32 mask = u32(_mm_movemask_epi8(bad));
+            if (mask == 0) { 
+                it += 16; 
+                p += 16; 
+                continue; 
+            }
+            const usize n = trailing_zeros(mask);
+            p = escape_char(p + n, it[n]);
+            it += n + 1;
+        }
+    }
+    #endif
+    for (; it != end; ++it) {
+        if (ZEN_LIKELY(ESCAPES.data[u8(*it)] == 0)) *p++ = *it;
+        else                                        p = escape_char(p, *it);
+    }
+    return p;
+}
+
+}
+
+namespace zen {
+
+template<typename Out>
+void json::write_string(Out& out, string_view s) noexcept
+{
+    const char* it = s.data();
+    const char* end = it + s.size();
+    do {
+        const usize n = usize(end - it) < impl::STRING_CHUNK ? usize(end - it) : impl::STRING_CHUNK;
+        char* p = out.reserve(n * 6 + 2);
+        char* const start = p;
+        if (it == s.data()) *p++ = '"';
+        p = impl::escape(p, it, it + n);
+        it += n;
+        if (it == end) *p++ = '"';
+        out.commit(usize(p - start));
+    } while (it != end);
+}
+
+template<typename Sink>
+void json_writer<Sink>::reset() noexcept
+{
+    if constexpr(!std::is_reference_v<Sink>)
+        m_out.clear();
+    m_objects = 0;
+    m_depth = 0;
+    m_has_items = false;
+    m_after_key = false;
+}
+
+template<typename Sink>
+json_writer<Sink>& json_writer<Sink>::key(string_view name) noexcept
+{
+    assertf(in_object() && !m_after_key, "json_writer: key \"{}\" outside of an object or after another key", name);
+    separate();
+    json::write_string(m_out, name);
+    if (m_pretty) m_out.append(": ", 2);
+    else          m_out.append(':');
+    m_after_key = true;
+    return *this;
+}
+
+template<typename Sink>
+template<typename T>
+json_writer<Sink>& json_writer<Sink>::value(const T& v) noexcept
+{
+    using U = std::remove_cvref_t<T>;
+    before_value();
+    if constexpr(std::is_same_v<U, bool>) {
+        m_out << v;
+    } else if constexpr(std::is_same_v<U, char>) {
+        json::write_string(m_out, string_view{&v, 1});
+    } else if constexpr(std::is_integral_v<U>) {
+        m_out << v;
+    } else if constexpr(std::is_floating_point_v<U>) {
+        // JSON has no inf or nan
+        if (ZEN_LIKELY(v - v == 0)) m_out << v;
+        else                        m_out.append("null", 4);
+    } else if constexpr(std::is_null_pointer_v<U>) {
+        m_out.append("null", 4);
+    } else if constexpr(std::is_pointer_v<U>) {
+        static_assert(std::is_convertible_v<U, string_view>, "json_writer writes strings, chars, bools, numbers and nullptr");
+        if (v != nullptr) json::write_string(m_out, string_view{v});
+        else              m_out.append("null", 4);
+    } else {
+        static_assert(std::is_convertible_v<const U&, string_view>, "json_writer writes strings, chars, bools, numbers and nullptr");
+        json::write_string(m_out, string_view(v));
+    }
+    return *this;
+}
+
+template<typename Sink>
+json_writer<Sink>& json_writer<Sink>::raw(string_view json) noexcept
+{
+    before_value();
+    m_out.append(json.data(), json.size());
+    return *this;
+}
+
+template<typename Sink>
+json_writer<Sink>& json_writer<Sink>::begin(bool object, char c) noexcept
+{
+    assertf(m_depth < json::MAX_DEPTH, "json_writer: more than {} nested objects and arrays", json::MAX_DEPTH);
+    before_value();
+    m_out.append(c);
+    m_objects = (m_objects & ~(u64(1) << m_depth)) | (u64(object) << m_depth);
+    ++m_depth;
+    m_has_items = false;
+    return *this;
+}
+
+template<typename Sink>
+json_writer<Sink>& json_writer<Sink>::end([[maybe_unused]] bool object, char c) noexcept
+{
+    assertf(m_depth > 0 && in_object() == object && !m_after_key, "json_writer: '{}' does not close the current {}", c,
+        m_depth == 0 ? "document" : in_object() ? "object" : "array");
+    --m_depth;
+    if (m_pretty && m_has_items) {
+        m_out.append('\n');
+        m_out.append_n(' ', m_depth * json::PRETTY_INDENT);
+    }
+    m_out.append(c);
+    m_has_items = true;
+    return *this;
+}
+
+template<typename Sink>
+void json_writer<Sink>::before_value() noexcept
+{
+    if (m_after_key) {
+        m_after_key = false;
+        return;
+    }
+    assertf(!in_object(), "json_writer: object members need a key");
+    assertf(m_depth > 0 || !m_has_items, "json_writer: a document has one root value, reset() starts the next");
+    separate();
+}
+
+template<typename Sink>
+void json_writer<Sink>::separate() noexcept
+{
+    if (m_has_items)
+        m_out.append(',');
+    m_has_items = true;
+    if (m_pretty && m_depth > 0) {
+        m_out.append('\n');
+        m_out.append_n(' ', m_depth * json::PRETTY_INDENT);
+    }
+}
+
+}
+
+#endif // ZEN_JSON_H
@@ -0,0 +1,384 @@
+#ifndef ZEN_LOG_H
+#define ZEN_LOG_H
+
+#include "zen_fmt.h"
+#include <atomic>
+#include <memory>
+#include <new>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+// Deferred logging, the call site only copies its arguments, formatting happens on the logger thread
+// The format string is checked at compile time like zen::format
+// Arguments are only evaluated when the level is enabled, a filtered call is one relaxed load
+#define ZEN_LOG(logger, lvl, format, ...) \
+    ((logger).enabled(zen::logging::level::lvl) \
+        ? (logger).template write<zen::logging::level::lvl>([]{ return format; } __VA_OPT__(,) __VA_ARGS__) \
+        : void())
+
+#define ZEN_LOG_TRACE(logger, format, ...)  ZEN_LOG(logger, trace, format __VA_OPT__(,) __VA_ARGS__)
+#define ZEN_LOG_DEBUG(logger, format, ...)  ZEN_LOG(logger, debug, format __VA_OPT__(,) __VA_ARGS__)
+#define ZEN_LOG_INFO(logger, format, ...)   ZEN_LOG(logger, info,  format __VA_OPT__(,) __VA_ARGS__)
+#define ZEN_LOG_WARN(logger, format, ...)   ZEN_LOG(logger, warn,  format __VA_OPT__(,) __VA_ARGS__)
+#define ZEN_LOG_ERROR(logger, format, ...)  ZEN_LOG(logger, error, format __VA_OPT__(,) __VA_ARGS__)
+
+namespace zen::logging {
+
+enum class level : u8 { trace, debug, info, warn, error };
+
+// What a producer does when its ring has no room for a message
+enum class overflow : u8 {
+    drop,   // Discard the message, the logger thread reports how many were dropped
+    block,  // Wait for the logger thread to make room
+    grow    // Switch to a ring twice the size, the old one is freed once drained
+};
+
+struct options {
+    usize    ring_size{64 * 1024};      // Initial bytes per producer thread, rounded up to a power of two
+    overflow policy{overflow::drop};
+    level    min_level{level::trace};
+    u32      idle_sleep_us{1000};       // Logger thread sleep when every ring is empty
+};
+
+struct logger;
+
+namespace impl {
+
+// Static per call site, records only point to it
+struct descriptor {
+    string_view             fmt{};
+    const fmt::impl::part*  parts{};
+    level                   lvl{};
+    void                  (*format)(fmt::fd_writer& out, const descriptor& d, const u8* args) noexcept{};
+};
+
+// Precedes each record in a ring, records start and end on RECORD_ALIGN boundaries
+struct record_header {
+    const descriptor* desc{};   // nullptr pads the rest of the ring before wrapping
+    usize             size{};   // Including the header
+};
+
+static constexpr usize RECORD_ALIGN = sizeof(record_header);
+
+
+// Arguments are copied as raw bytes, strings as length and chars and read back as string_view
+// Named arguments are stored as their value and get their name back when read
+template<typename T>
+static constexpr bool is_string_arg = std::is_convertible_v<const T&, string_view>;
+
+template<typename T>
+struct stored { using type = std::conditional_t<is_string_arg<T>, string_view, T>; };
+
+template<fmt::fixed_string Name, typename T>
+struct stored<fmt::named_arg<Name, T>> { using type = fmt::named_arg<Name, typename stored<std::remove_cvref_t<T>>::type>; };
+
+template<typename T>
+using stored_t = typename stored<T>::type;
+
+template<typename T>
+ZEN_FORCEINLINE string_view string_arg(const T& v) noexcept {
+    if constexpr(std::is_pointer_v<T>) { if (v == nullptr) return {}; }
+    return string_view(v);
+}
+
+template<typename T>
+ZEN_FORCEINLINE usize arg_size(const T& v) noexcept {
+    if constexpr(fmt::impl::is_named<T>) return arg_size(v.value);
+    else if constexpr(is_string_arg<T>)  return sizeof(u32) + string_arg(v).size();
+    else                                 return sizeof(T);
+}
+
+template<typename T>
+ZEN_FORCEINLINE u8* arg_write(u8* p, const T& v) noexcept {
+    if constexpr(fmt::impl::is_named<T>) {
+        return arg_write(p, v.value);
+    } else if constexpr(is_string_arg<T>) {
+        const string_view s = string_arg(v);
+        const u32 n = u32(s.size());
+        memcpy(p, &n, sizeof(u32));
+        memcpy(p + sizeof(u32), s.data(), n);
+        return p + sizeof(u32) + n;
+    } else {
+        static_assert(std::is_trivially_copyable_v<T>, "log arguments must be strings or trivially copyable");
+        memcpy(p, &v, sizeof(T));
+        return p + sizeof(T);
+    }
+}
+
+template<typename T>
+ZEN_FORCEINLINE stored_t<T> arg_read(const u8*& p) noexcept {
+    if constexpr(fmt::impl::is_named<T>) {
+        return {arg_read<std::remove_cvref_t<decltype(T::value)>>(p)};
+    } else if constexpr(is_string_arg<T>) {
+        u32 n{};
+        memcpy(&n, p, sizeof(u32));
+        const string_view s{reinterpret_cast<const char*>(p + sizeof(u32)), n};
+        p += sizeof(u32) + n;
+        return s;
+    } else {
+        alignas(T) u8 bytes[sizeof(T)];
+        memcpy(bytes, p, sizeof(T));
+        p += sizeof(T);
+        return *std::launder(reinterpret_cast<T*>(bytes));
+    }
+}
+
+template<typename... Args>
+void format_record(fmt::fd_writer& out, const descriptor& d, [[maybe_unused]] const u8* p) noexcept {
+    // Braced initialization reads the arguments in order
+    std::tuple<stored_t<Args>...> args{arg_read<Args>(p)...};
+    std::apply([&](auto&... a) { fmt::vformat(out, d.fmt, d.parts, fmt::make_args(a...)); }, args);
+}
+
+
+// Single producer single consumer byte ring
+struct ring {
+    ring(alloc_t<> alloc, usize capacity) noexcept
+        : data{alloc.allocate(capacity)}, capacity{capacity} {}
+
+    alignas(ZEN_CACHE_LINE) std::atomic<u64> head{};    // Consumer position
+    alignas(ZEN_CACHE_LINE) std::atomic<u64> tail{};    // Producer position
+    u64                     cached_head{};              // Producer copy of head, refreshed when the ring looks full
+    std::atomic<ring*>      next{};                     // Set by the producer when it grows into a new ring
+    u8*                     data{};
+    usize                   capacity{};
+};
+
+// Rings of one producer thread
+struct producer {
+    std::thread::id     id{};
+    ring*               write{};        // Only used by the producer
+    std::atomic<ring*>  read{};         // Only used by the logger thread after registration
+    std::atomic<u64>    dropped{};
+};
+
+}
+
+
+// Asynchronous logger writing to a file descriptor it does not own
+// Each producer thread serializes the message arguments into its own lock free ring with a pointer to the
+// static descriptor of the call site. The logger thread formats them into a batched fd_writer.
+// Messages from one thread keep their order, messages from different threads are only ordered per drain.
+// Threads must stop logging before the logger is destroyed, rings of exited threads are kept until then.
+// The memory resource must be thread safe when the grow policy is used.
+struct logger {
+    explicit logger(int fd, options opts = {}, alloc_t<> alloc = {}) noexcept
+        : m_opts{opts}, m_alloc{alloc}, m_out{fd, true}, m_min_level{u8(opts.min_level)}
+    {
+        m_opts.ring_size = po2::round_up(opts.ring_size < 4096 ? usize(4096) : opts.ring_size);
+        m_thread = std::thread{[this] { run(); }};
+    }
+
+    ~logger() noexcept {
+        m_stop.store(true, std::memory_order_release);
+        m_thread.join();
+        for (auto& p : m_producers) {
+            for (auto* r = p->read.load(std::memory_order_acquire); r != nullptr; ) {
+                auto* next = r->next.load(std::memory_order_acquire);
+                destroy_ring(r);
+                r = next;
+            }
+        }
+    }
+
+    logger(const logger&) = delete;
+    logger& operator=(const logger&) = delete;
+
+    ZEN_ND bool enabled(level l) const noexcept { return u8(l) >= m_min_level.load(std::memory_order_relaxed); }
+    void        set_level(level l)     noexcept { m_min_level.store(u8(l), std::memory_order_relaxed); }
+
+    // Use the ZEN_LOG macros, F returns the format string literal of the call site
+    template<level L, typename F, typename... Args>
+    void write(F, Args&&... args) noexcept {
+        static constexpr fmt::format_string<Args...> fmt_str{F{}()};
+        static constexpr impl::descriptor desc{fmt_str.str, fmt_str.parts, L, &impl::format_record<std::remove_cvref_t<Args>...>};
+        if (ZEN_UNLIKELY(!enabled(L)))
+            return;
+        const usize size = round_up((sizeof(impl::record_header) + ... + impl::arg_size(args)), impl::RECORD_ALIGN);
+        impl::producer& prod = this_producer();
+        u8* p = reserve(prod, size);
+        if (ZEN_UNLIKELY(p == nullptr))
+            return;
+        const impl::record_header header{&desc, size};
+        memcpy(p, &header, sizeof(header));
+        [[maybe_unused]] u8* it = p + sizeof(header);
+        ((it = impl::arg_write(it, args)), ...);
+        impl::ring& r = *prod.write;
+        r.tail.store(r.tail.load(std::memory_order_relaxed) + size, std::memory_order_release);
+    }
+
+    // Waits until every message logged before the call is written to the fd
+    void flush() noexcept {
+        const u64 ticket = m_flush_requested.fetch_add(1, std::memory_order_acq_rel) + 1;
+        while (m_flush_done.load(std::memory_order_acquire) < ticket)
+            std::this_thread::yield();
+    }
+
+private:
+    // Producer side
+
+    impl::producer& this_producer() noexcept {
+        struct cache { const logger* owner; u64 id; impl::producer* p; };
+        static thread_local cache c{};
+        if (ZEN_LIKELY(c.owner == this && c.id == m_id))
+            return *c.p;
+        const auto tid = std::this_thread::get_id();
+        std::lock_guard lock{m_mutex};
+        impl::producer* found{};
+        for (auto& p : m_producers)
+            if (p->id == tid) found = p.get();
+        if (found == nullptr) {
+            auto p = std::make_unique<impl::producer>();
+            p->id = tid;
+            p->write = create_ring(m_opts.ring_size);
+            p->read.store(p->write, std::memory_order_release);
+            found = p.get();
+            m_producers.push_back(std::move(p));
+        }
+        c = cache{this, m_id, found};
+        return *found;
+    }
+
+    // Returns where to write a record of size bytes in the current ring of the producer
+    u8* reserve(impl::producer& prod, usize size) noexcept {
+        for (;;) {
+            impl::ring& r = *prod.write;
+            const u64 tail = r.tail.load(std::memory_order_relaxed);
+            const usize offset = usize(tail & (r.capacity - 1));
+            // Records never wrap, the end of the ring is skipped when the record does not fit before it
+            const usize skip = offset + size > r.capacity ? r.capacity - offset : 0;
+            const auto fits = [&] { return size <= r.capacity && tail + skip + size - r.cached_head <= r.capacity; };
+            if (ZEN_UNLIKELY(!fits()))
+                r.cached_head = r.head.load(std::memory_order_acquire);
+            if (ZEN_LIKELY(fits())) {
+                if (skip > 0) {
+                    const impl::record_header pad{nullptr, skip};
+                    memcpy(r.data + offset, &pad, sizeof(pad));
+                    r.tail.store(tail + skip, std::memory_order_release);
+                }
+                return r.data + ((tail + skip) & (r.capacity - 1));
+            }
+            switch (m_opts.policy) {
+                case overflow::block:
+                    if (size <= r.capacity) {
+                        std::this_thread::yield();
+                        break;
+                    }
+                    [[fallthrough]];
+                case overflow::drop:
+                    prod.dropped.fetch_add(1, std::memory_order_relaxed);
+                    return nullptr;
+                case overflow::grow: {
+                    usize capacity = r.capacity * 2;
+                    while (capacity < size) capacity *= 2;
+                    impl::ring* next = create_ring(capacity);
+                    r.next.store(next, std::memory_order_release);
+                    prod.write = next;
+                    break;
+                }
+            }
+        }
+    }
+
+    impl::ring* create_ring(usize capacity) noexcept {
+        auto* r = alloc_t<impl::ring>{m_alloc}.allocate(1);
+        return new (r) impl::ring{m_alloc, capacity};
+    }
+
+    void destroy_ring(impl::ring* r) noexcept {
+        m_alloc.deallocate(r->data, r->capacity);
+        r->~ring();
+        alloc_t<impl::ring>{m_alloc}.deallocate(r, 1);
+    }
+
+    // Logger thread
+
+    void run() noexcept {
+        std::vector<impl::producer*> producers{};
+        for (;;) {
+            const bool stop = m_stop.load(std::memory_order_acquire);
+            const u64 flush_ticket = m_flush_requested.load(std::memory_order_acquire);
+            {
+                std::lock_guard lock{m_mutex};
+                producers.clear();
+                for (auto& p : m_producers) producers.push_back(p.get());
+            }
+            usize n{};
+            for (auto* p : producers)
+                n += drain(*p);
+            if (n == 0 || stop || flush_ticket != m_flush_done.load(std::memory_order_relaxed)) {
+                m_out.flush();
+                m_flush_done.store(flush_ticket, std::memory_order_release);
+            }
+            if (stop)
+                return;
+            if (n == 0)
+                std::this_thread::sleep_for(std::chrono::microseconds(m_opts.idle_sleep_us));
+        }
+    }
+
+    usize drain(impl::producer& p) noexcept {
+        usize n{};
+        if (const u64 dropped = p.dropped.exchange(0, std::memory_order_relaxed); ZEN_UNLIKELY(dropped > 0)) {
+            m_out.begin_message();
+            m_out << "[warn] dropped " << dropped << " log messages\n";
+            m_out.end_message();
+        }
+        for (impl::ring* r = p.read.load(std::memory_order_relaxed); ; ) {
+            // Everything written to the old ring happens before next is published
+            impl::ring* next = r->next.load(std::memory_order_acquire);
+            n += drain(*r);
+            if (next == nullptr)
+                return n;
+            p.read.store(next, std::memory_order_relaxed);
+            destroy_ring(r);
+            r = next;
+        }
+    }
+
+    usize drain(impl::ring& r) noexcept {
+        static constexpr string_view LEVELS[]{"[trace] ", "[debug] ", "[info] ", "[warn] ", "[error] "};
+        const u64 tail = r.tail.load(std::memory_order_acquire);
+        u64 head = r.head.load(std::memory_order_relaxed);
+        usize n{};
+        while (head != tail) {
+            const u8* p = r.data + (head & (r.capacity - 1));
+            impl::record_header header{};
+            memcpy(&header, p, sizeof(header));
+            if (ZEN_LIKELY(header.desc != nullptr)) {
+                m_out.begin_message();
+                m_out << LEVELS[u8(header.desc->lvl)];
+                header.desc->format(m_out, *header.desc, p + sizeof(header));
+                m_out.append('\n');
+                m_out.end_message();
+                ++n;
+            }
+            head += header.size;
+        }
+        r.head.store(head, std::memory_order_release);
+        return n;
+    }
+
+    static u64 next_id() noexcept {
+        static std::atomic<u64> id{};
+        return id.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    options                                      m_opts{};
+    alloc_t<>                                    m_alloc{};
+    fmt::fd_writer                               m_out;
+    std::atomic<u8>                              m_min_level{};
+    const u64                                    m_id{next_id()};
+    std::mutex                                   m_mutex{};
+    std::vector<std::unique_ptr<impl::producer>> m_producers{};
+    std::atomic<bool>                            m_stop{};
+    std::atomic<u64>                             m_flush_requested{};
+    std::atomic<u64>                             m_flush_done{};
+    std::thread                                  m_thread{};
+};
+
+}
+
+#endif // ZEN_LOG_H
@@ -0,0 +1,310 @@
+#ifndef ZEN_MULTI_MATCHER_H
+#define ZEN_MULTI_MATCHER_H
+
+#include "zen_alloc.h"
+#include "zen_bit.h"
+#include "zen_span.h"
+#include "zen_string.h"
+#include <vector>
+
+#ifdef ZEN_AVX2
+#include <immintrin.h>
+#endif
+
+namespace zen {
+
+// One occurrence of a pattern, pattern is its index in the set the matcher was built from
+struct multi_match {
+    u32   pattern{};
+    usize pos{};        // Start of the match in the text
+};
+
+// Finds every occurrence of a set of patterns in one pass over a text, built once and reused for many texts
+// Up to TEDDY_MAX_PATTERNS patterns are found with a SIMD prefilter on their first chars when AVX2 is enabled,
+// otherwise with an Aho-Corasick automaton. Overlapping matches are all reported, empty patterns never match.
+// The automaton reports matches by end position, the prefilter by start position.
+//
+//  const zen::string_view keywords[]{"error", "timeout", "refused"};
+//  const zen::multi_matcher m{keywords};
+//  m.for_each(line, [](zen::multi_match hit) { ... });
+struct multi_matcher;
+
+}
+
+
+// Multi matcher impl
+namespace zen::impl {
+
+// Calls f with a match, f can return false to stop the scan
+template<typename F>
+ZEN_FORCEINLINE bool report_match(F& f, u32 pattern, usize pos) {
+    if constexpr(std::is_same_v<decltype(f(multi_match{})), bool>)
+        return f(multi_match{pattern, pos});
+    else {
+        f(multi_match{pattern, pos});
+        return true;
+    }
+}
+
+}
+
+namespace zen {
+
+struct multi_matcher {
+    static constexpr usize TEDDY_MAX_PATTERNS = 32;
+    static constexpr usize TEDDY_BUCKETS = 8;
+    static constexpr usize TEDDY_MAX_CHARS = 3;     // Chars of each pattern the prefilter looks at
+
+    explicit multi_matcher(span<const string_view> patterns, alloc_t<> alloc = std::pmr::get_default_resource()) noexcept
+        : m_chars{alloc}, m_pattern_offsets{alloc}, m_table{alloc}, m_outputs{alloc}, m_outs{alloc}, m_bucket_offsets{alloc}, m_buckets{alloc}
+    {
+        m_n_patterns = patterns.size();
+        m_pattern_offsets.reserve(patterns.size() + 1);
+        for (const string_view p: patterns) {
+            m_pattern_offsets.push_back(u32(m_chars.size()));
+            m_chars.insert(m_chars.end(), p.begin(), p.end());
+        }
+        m_pattern_offsets.push_back(u32(m_chars.size()));
+        build_automaton();
+        #ifdef ZEN_AVX2
+        build_teddy();
+        #endif
+    }
+
+    // Calls f(multi_match) for every occurrence, f can return false to stop
+    template<typename F>
+    void for_each(string_view text, F&& f) const {
+        #ifdef ZEN_AVX2
+        if (m_teddy) {
+            scan_teddy(text, f);
+            return;
+        }
+        #endif
+        scan_automaton(text, f);
+    }
+
+    ZEN_ND bool contains_any(string_view text) const noexcept {
+        bool found = false;
+        for_each(text, [&](multi_match) { found = true; return false; });
+        return found;
+    }
+
+    ZEN_ND usize count(string_view text) const noexcept {
+        usize n = 0;
+        for_each(text, [&](multi_match) { ++n; });
+        return n;
+    }
+
+    ZEN_ND usize       size()                const noexcept { return m_n_patterns; }
+    ZEN_ND string_view pattern(usize i)      const noexcept { return string_view{m_chars.data() + m_pattern_offsets[i], m_pattern_offsets[i + 1] - m_pattern_offsets[i]}; }
+    ZEN_ND bool        prefiltered()         const noexcept { return m_teddy; }
+
+private:
+    // Aho-Corasick over byte classes, bytes in no pattern share class 0 so a row has one entry per distinct pattern byte.
+    // The table is a full DFA, a row index premultiplied by the row size with the high bit set when the next state
+    // ends a pattern, so the scan is one load per char and never follows failure links.
+    static constexpr u32 MATCH_BIT = u32(1) << 31;
+
+    struct output_range {
+        u32 begin;
+        u32 end;
+    };
+
+    void build_automaton() noexcept {
+        for (const char c: m_chars) {
+            if (m_classes[u8(c)] == 0)
+                m_classes[u8(c)] = u16(++m_n_classes);
+        }
+        ++m_n_classes;
+
+        // Trie, 0 is both the root and "no child" while building since nothing points back to the root yet
+        std::pmr::vector<u32> own_pattern{m_table.get_allocator()};
+        auto new_state = [&]() {
+            m_table.resize(m_table.size() + m_n_classes, 0);
+            own_pattern.push_back(u32(-1));
+            return u32(own_pattern.size() - 1);
+        };
+        new_state();
+        std::pmr::vector<u32> next_same_end{m_table.get_allocator()};   // Patterns with the same chars as an earlier one
+        next_same_end.resize(m_n_patterns, u32(-1));
+        for (u32 p = 0; p < m_n_patterns; ++p) {
+            const string_view chars = pattern(p);
+            if (chars.empty())
+                continue;
+            u32 s = 0;
+            for (const char c: chars) {
+                const usize at = s * m_n_classes + m_classes[u8(c)];
+                if (m_table[at] == 0) {
+                    const u32 next = new_state();    // Grows the table, so no reference is held across it
+                    m_table[at] = next;
+                }
+                s = m_table[at];
+            }
+            next_same_end[p] = own_pattern[s];
+            own_pattern[s] = p;
+        }
+        const usize n_states = own_pattern.size();
+
+        // Breadth first, a state's failure link is always done before the state
+        std::pmr::vector<u32> fail(n_states, 0, m_table.get_allocator());
+        std::pmr::vector<u32> order{m_table.get_allocator()};
+        order.reserve(n_states);
+        order.push_back(0);
+        for (usize i = 0; i < order.size(); ++i) {
+            const u32 s = order[i];
+            for (u32 c = 0; c < m_n_classes; ++c) {
+                u32& next = m_table[s * m_n_classes + c];
+                const u32 via_fail = s == 0 ? 0 : m_table[fail[s] * m_n_classes + c];
+                if (next != 0) {
+                    fail[next] = via_fail;
+                    order.push_back(next);
+                } else {
+                    next = via_fail;
+                }
+            }
+        }
+
+        // Patterns ending at each state, its own and those of its failure chain
+        m_outputs.resize(n_states);
+        for (const u32 s: order) {
+            const u32 begin = u32(m_outs.size());
+            for (u32 p = own_pattern[s]; p != u32(-1); p = next_same_end[p])
+                m_outs.push_back(p);
+            if (s != 0) {
+                for (u32 i = m_outputs[fail[s]].begin; i < m_outputs[fail[s]].end; ++i)
+                    m_outs.push_back(m_outs[i]);
+            }
+            m_outputs[s] = output_range{begin, u32(m_outs.size())};
+        }
+
+        for (u32& next: m_table)
+            next = next * m_n_classes | (m_outputs[next].begin != m_outputs[next].end ? MATCH_BIT : 0);
+    }
+
+    template<typename F>
+    void scan_automaton(string_view text, F& f) const {
+        const u32* table = m_table.data();
+        const u16* classes = m_classes;
+        u32 s = 0;
+        for (usize i = 0; i < text.size(); ++i) {
+            s = table[(s & ~MATCH_BIT) + classes[u8(text[i])]];
+            if (ZEN_UNLIKELY(s & MATCH_BIT)) {
+                const output_range& out = m_outputs[(s & ~MATCH_BIT) / m_n_classes];
+                for (u32 o = out.begin; o < out.end; ++o) {
+                    const u32 p = m_outs[o];
+                    if (!impl::report_match(f, p, i + 1 - pattern(p).size()))
+                        return;
+                }
+            }
+        }
+    }
+
+    #ifdef ZEN_AVX2
+    // Teddy: patterns are spread over 8 buckets, and for each of the first m chars of the patterns two 16 entry tables
+    // give the buckets that have a char with that low or high nibble there. Shuffling a block through the tables and
+    // and-ing the results leaves, per position, the buckets whose first m chars could start there, which are verified.
+    void build_teddy() noexcept {
+        usize min_len = ~usize(0);
+        for (u32 p = 0; p < m_n_patterns; ++p) {
+            if (!pattern(p).empty() && pattern(p).size() < min_len)
+                min_len = pattern(p).size();
+        }
+        if (m_n_patterns > TEDDY_MAX_PATTERNS || min_len == ~usize(0))
+            return;
+        m_teddy = true;
+        m_teddy_chars = min_len < TEDDY_MAX_CHARS ? min_len : TEDDY_MAX_CHARS;
+        m_bucket_offsets.resize(TEDDY_BUCKETS + 1, 0);
+        for (u32 b = 0; b < TEDDY_BUCKETS; ++b) {
+            m_bucket_offsets[b] = u32(m_buckets.size());
+            for (u32 p = b; p < m_n_patterns; p += TEDDY_BUCKETS) {
+                const string_view chars = pattern(p);
+                if (chars.empty())
+                    continue;
+                m_buckets.push_back(p);
+                for (usize k = 0; k < m_teddy_chars; ++k) {
+                    m_teddy_lo[k][u8(chars[k]) & 15] |= u8(1u << b);
+                    m_teddy_hi[k][u8(chars[k]) >> 4] |= u8(1u << b);
+                }
+            }
+        }
+        m_bucket_offsets[TEDDY_BUCKETS] = u32(m_buckets.size());
+    }
+
+    // Verifies the patterns of the buckets set in bits at pos
+    template<typename F>
+    ZEN_FORCEINLINE bool verify(string_view text, usize pos, u32 bits, F& f) const {
+        for (; bits != 0; bits &= bits - 1) {
+            const usize b = trailing_zeros(bits);
+            for (u32 i = m_bucket_offsets[b]; i < m_bucket_offsets[b + 1]; ++i) {
+                const string_view chars = pattern(m_buckets[i]);
+                if (chars.size() <= text.size() - pos && memcmp(text.data() + pos, chars.data(), chars.size()) == 0) {
+                    if (!impl::report_match(f, m_buckets[i], pos))
+                        return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    template<typename F>
+    void scan_teddy(string_view text, F& f) const {
+        const usize m = m_teddy_chars;
+        if (text.size() < m)
+            return;
+        const char* data = text.data();
+        const usize last = text.size() - m;     // Last position the first m chars of a pattern fit at
+        const __m256i nibble = _mm256_set1_epi8(0x0f);
+        __m256i lo[TEDDY_MAX_CHARS], hi[TEDDY_MAX_CHARS];
+        for (usize k = 0; k < m; ++k) {
+            lo[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(m_teddy_lo[k])));
+            hi[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(m_teddy_hi[k])));
+        }
+        usize i = 0;
+        for (; i + 32 <= last + 1; i += 32) {
+            __m256i buckets = _mm256_set1_epi8(-1);
+            for (usize k = 0; k < m; ++k) {
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + k));
+                const __m256i l = _mm256_shuffle_epi8(lo[k], _mm256_and_si256(v, nibble));
+                const __m256i h = _mm256_shuffle_epi8(hi[k], _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+                buckets = _mm256_and_si256(buckets, _mm256_and_si256(l, h));
+            }
+            u32 mask = ~u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(buckets, _mm256_setzero_si256())));
+            if (ZEN_LIKELY(mask == 0))
+                continue;
+            alignas(32) u8 bits[32];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(bits), buckets);
+            for (; mask != 0; mask &= mask - 1) {
+                const usize j = trailing_zeros(mask);
+                if (!verify(text, i + j, bits[j], f))
+                    return;
+            }
+        }
+        for (; i <= last; ++i) {
+            u32 bits = 0xff;
+            for (usize k = 0; k < m; ++k)
+                bits &= m_teddy_lo[k][u8(data[i + k]) & 15] & m_teddy_hi[k][u8(data[i + k]) >> 4];
+            if (bits != 0 && !verify(text, i, bits, f))
+                return;
+        }
+    }
+    #endif
+
+    std::pmr::vector<char> m_chars;             // Chars of every pattern
+    std::pmr::vector<u32>  m_pattern_offsets;   // Pattern i is m_chars[offsets[i], offsets[i + 1])
+    std::pmr::vector<u32>  m_table;             // Automaton transitions, one row of m_n_classes per state
+    std::pmr::vector<output_range> m_outputs;   // Patterns ending at each state, a range of m_outs
+    std::pmr::vector<u32>  m_outs;
+    std::pmr::vector<u32>  m_bucket_offsets;    // Teddy bucket b is m_buckets[offsets[b], offsets[b + 1])
+    std::pmr::vector<u32>  m_buckets;
+    usize                  m_n_patterns{};
+    u32                    m_n_classes{};
+    u16                    m_classes[256]{};   // Up to 256 pattern bytes and class 0
+    bool                   m_teddy{};
+    usize                  m_teddy_chars{};
+    u8                     m_teddy_lo[TEDDY_MAX_CHARS][16]{};
+    u8                     m_teddy_hi[TEDDY_MAX_CHARS][16]{};
+};
+
+}
+
+#endif // ZEN_MULTI_MATCHER_H
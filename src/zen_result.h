@@ -61,7 +61,10 @@ struct result {
 
     ZEN_FORCEINLINE constexpr result(Code code)                 noexcept : c{code} {}
 
-    template<typename = std::enable_if_t<std::is_same_v<Code, bool>>>
+    // Value and code together, for errors that keep context like the position they happened at
+    ZEN_FORCEINLINE constexpr result(const T& value, Code code) noexcept : v{value}, c{code} {}
+
+    template<typename C = Code, typename = std::enable_if_t<std::is_same_v<C, bool>>>
     ZEN_FORCEINLINE constexpr result(error_t)                   noexcept : c{false} {}
 
     ZEN_FORCEINLINE constexpr result& operator=(const T& value) noexcept { v = value; c = Success; return *this; }
@@ -72,6 +75,7 @@ struct result {
     ZEN_FORCEINLINE constexpr bool ok()                   const noexcept { return c == Success; }
     ZEN_FORCEINLINE constexpr Code code()                 const noexcept { return c; }
     ZEN_FORCEINLINE constexpr T&&  value()                &&    noexcept { return std::move(v); }
+    ZEN_FORCEINLINE constexpr const T& value()            const& noexcept { return v; }
     ZEN_FORCEINLINE constexpr Code get(T& val)            &&    noexcept { if (ok()) val = std::move(v); return c; }
     ZEN_FORCEINLINE constexpr void tie(T& val, Code& cd)  &&    noexcept { if (ok()) val = std::move(v); else cd = c; }
 
@@ -85,6 +89,8 @@ struct result {
         } else {
             if constexpr(std::is_same_v<Code, bool>)
                 return o << "Err()";
+            else if constexpr(std::is_enum_v<Code>)
+                return o << "Err(" << i64(r.c) << ")";
             else
                 return o << "Err(" << r.c << ")";
         }
@@ -0,0 +1,267 @@
+#ifndef ZEN_SCAN_H
+#define ZEN_SCAN_H
+
+#include "zen_fmt.h"
+#include "zen_result.h"
+
+namespace zen {
+
+enum class scan_error : u8 {
+    none,
+    literal,    // The input does not match the literal text of the format
+    invalid,    // A field has no valid value, like a letter where an integer should be
+    overflow,   // An integer field does not fit its type
+    end,        // The input ended before the format did
+    format      // A runtime format string is invalid for scanning these arguments
+};
+
+// Chars of the input consumed on success, otherwise the position of the first literal char or field that failed
+using scan_result = result<usize, scan_error>;
+
+namespace fmt {
+
+// Scan format parsed at compile time, with the replacement fields of zen::format
+// Fields take a style and a width, the most chars the field reads, but no fill, alignment, precision or nested fields
+template<typename... Args>
+struct basic_scan_string;
+
+template<typename... Args>
+using scan_string = basic_scan_string<std::type_identity_t<Args>...>;
+
+// Type-erased output of a field, what vscan works with
+struct scan_arg;
+
+// The parsing engine behind zen::scan, compiled once for every argument list
+scan_result vscan(string_view input, string_view fmt, const impl::part* parts, span<const scan_arg> args) noexcept;
+
+}
+
+// Parses input with the layout of fmt into args, literal text must match exactly, whitespace included
+// Integers are read in the base of their style, with the prefix zen::format writes being optional
+// Floats, bools (true or false) and chars (one char, or an integer with a style) are read like zen::format writes them
+// Strings end where the literal after them starts, at whitespace when another field follows directly, or at the end
+// of the input. string_view fields point into input, other strings are assigned a copy.
+//
+//  string_view host{}; u16 port{}; i32 x{};
+//  auto r = zen::scan("10.0.0.1:8080 x=-3", "{}:{} x={}", host, port, x);
+//  if (!r) zen::println("bad input at {}", r.value());
+template<typename... Args>
+scan_result scan(string_view input, fmt::scan_string<Args...> fmt, Args&... args) noexcept;
+
+
+// Parses fmt at runtime, an invalid format fails with scan_error::format
+template<typename... Args>
+scan_result scan(string_view input, fmt::runtime_format_string fmt, Args&... args) noexcept;
+
+}
+
+
+// Scan format parsing
+namespace zen::fmt::impl {
+
+// Fields of a format parsed with parse_format, checked for what scanning supports
+constexpr const char* check_scan_parts(const part* parts) noexcept {
+    if (parts[0].arg == ARG_REPARSE)
+        return "more scan fields than arguments";
+    for (const part* p = parts; p->arg != ARG_END; ++p) {
+        const spec& s = p->field;
+        if (s.dynamic != 0)
+            return "scan fields cannot have nested width or precision fields";
+        if (s.fill != ' ' || s.align != '<')
+            return "scan fields cannot have a fill or alignment";
+        if (s.style == 'f')
+            return "scan fields cannot have a precision";
+        if (s.style == STYLE_DEBUG)
+            return "scan cannot read escaped strings";
+    }
+    return nullptr;
+}
+
+// Numbers, bools, chars, string_view and strings with assign(const char*, usize)
+template<typename T, typename = void>
+static constexpr bool is_scan_output = std::is_arithmetic_v<T> || std::is_same_v<T, string_view>;
+
+template<typename T>
+static constexpr bool is_scan_output<T, std::void_t<decltype(std::declval<T&>().assign(std::declval<const char*>(), usize{}))>> = true;
+
+}
+
+namespace zen::fmt {
+
+template<typename... Args>
+struct basic_scan_string {
+    static constexpr usize n_args = sizeof...(Args);
+
+    string_view str{};
+    impl::part  parts[n_args + 1]{};
+
+    static_assert(n_args <= impl::MAX_ARGS, "too many scan arguments");
+    static_assert((impl::is_scan_output<Args> && ...), "zen::scan reads integers, floats, bools, chars and strings");
+
+    template<typename S, typename = std::enable_if_t<std::is_convertible_v<const S&, string_view>>>
+    consteval basic_scan_string(const S& s) : str{s} {
+        constexpr impl::arg_kind kinds[n_args + 1]{impl::arg_kind_of<Args>()...};
+        const char* error = impl::parse_format(str, parts, n_args + 1, {n_args, kinds, nullptr});
+        if (error == nullptr)
+            error = impl::check_scan_parts(parts);
+        if (error != nullptr)
+            impl::format_error(error);
+    }
+};
+
+struct scan_arg {
+    void*           value{};
+    parse_result  (*read)(void* value, const char* begin, const char* end, char style) noexcept{};
+    impl::arg_kind  kind{impl::arg_kind::other};
+};
+
+}
+
+
+// Scan impl
+namespace zen::fmt::impl {
+
+// Skips the base prefix zen::format writes for a style, when the input has it
+ZEN_FORCEINLINE const char* skip_prefix(const char* begin, const char* end, char c) noexcept {
+    return end - begin >= 2 && begin[0] == '0' && (begin[1] == c || (c == 'x' && begin[1] == 'X')) ? begin + 2 : begin;
+}
+
+template<typename T>
+parse_result scan_value(void* out, const char* begin, const char* end, char style) noexcept {
+    T& v = *static_cast<T*>(out);
+    if constexpr(std::is_same_v<T, bool>) {
+        if (end - begin >= 4 && memcmp(begin, "true", 4) == 0)  { v = true;  return {begin + 4, parse_error::none}; }
+        if (end - begin >= 5 && memcmp(begin, "false", 5) == 0) { v = false; return {begin + 5, parse_error::none}; }
+        return {begin, parse_error::invalid};
+    } else if constexpr(std::is_integral_v<T>) {
+        if constexpr(std::is_same_v<T, char>) {
+            if (style == STYLE_NONE) {
+                if (begin == end) return {begin, parse_error::invalid};
+                v = *begin;
+                return {begin + 1, parse_error::none};
+            }
+        }
+        switch (style) {
+            case 'b':           return chars_to_int<2>(skip_prefix(begin, end, 'b'), end, v);
+            case 'x': case 'X': return chars_to_int<16>(skip_prefix(begin, end, 'x'), end, v);
+            case 'o':           return chars_to_int<8>(skip_prefix(begin, end, 'o'), end, v);
+            default:            return chars_to_int<10>(begin, end, v);
+        }
+    } else if constexpr(std::is_floating_point_v<T>) {
+        return chars_to_float(begin, end, v);
+    } else if constexpr(std::is_same_v<T, string_view>) {
+        v = string_view{begin, usize(end - begin)};
+        return {end, parse_error::none};
+    } else {
+        v.assign(begin, usize(end - begin));
+        return {end, parse_error::none};
+    }
+}
+
+template<typename T>
+ZEN_FORCEINLINE scan_arg make_scan_arg(T& v) noexcept {
+    return {&v, &scan_value<T>, arg_kind_of<T>()};
+}
+
+// Matches the literal run of p at it, it is left at the first char that does not match
+// Literals between fields are mostly a separator or two, only long ones are worth a call to memcmp
+ZEN_FORCEINLINE scan_error match_literal(const char*& it, const char* end, string_view fmt, const part& p) noexcept {
+    const char* lit = fmt.data() + p.offset;
+    if (p.size > 16 && !p.escaped && usize(end - it) >= p.size && memcmp(it, lit, p.size) == 0) {
+        it += p.size;
+        return scan_error::none;
+    }
+    // Each escaped brace pair matches one char
+    for (const char* lit_end = lit + p.size; lit != lit_end; ++lit) {
+        if (it == end)
+            return scan_error::end;
+        if (*it != *lit)
+            return scan_error::literal;
+        ++it;
+        if (p.escaped && (*lit == '{' || *lit == '}'))
+            ++lit;
+    }
+    return scan_error::none;
+}
+
+constexpr bool is_space(char c) noexcept { return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f'; }
+
+// First c in [it, end), or end
+ZEN_FORCEINLINE const char* find_char(const char* it, const char* end, char c) noexcept {
+    #ifdef ZEN_SSE2
+    const __m128i v = _mm_set1_epi8(c);
+    for (; end - it >= 16; it += 16) {
+        const u32 mask = u32(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(it)), v)));
+        if (mask != 0)
+            return it + trailing_zeros(mask);
+    }
+    #endif
+    while (it != end && *it != c)
+        ++it;
+    return it;
+}
+
+// End of a string field starting at it, next is the part after the field
+ZEN_FORCEINLINE const char* string_field_end(const char* it, const char* end, string_view fmt, const part& next) noexcept {
+    if (next.size > 0)
+        return find_char(it, end, fmt[next.offset]);
+    if (next.arg == ARG_END)
+        return end;
+    while (it != end && !is_space(*it))
+        ++it;
+    return it;
+}
+
+}
+
+namespace zen {
+
+ZEN_NEVERINLINE scan_result fmt::vscan(string_view input, string_view fmt, const impl::part* parts, span<const scan_arg> args) noexcept
+{
+    const char* const begin = input.data();
+    const char* const end = begin + input.size();
+    const char* it = begin;
+    for (const impl::part* p = parts; ; ++p) {
+        if (const scan_error e = impl::match_literal(it, end, fmt, *p); ZEN_UNLIKELY(e != scan_error::none))
+            return {usize(it - begin), e};
+        if (p->arg == impl::ARG_END)
+            return usize(it - begin);
+        const scan_arg& a = args[p->arg];
+        const char* field_end = p->field.width != 0 && p->field.width < usize(end - it) ? it + p->field.width : end;
+        if (a.kind == impl::arg_kind::string)
+            field_end = impl::string_field_end(it, field_end, fmt, p[1]);
+        const parse_result r = a.read(a.value, it, field_end, p->field.style);
+        if (ZEN_UNLIKELY(!r)) {
+            const scan_error e = r.error == parse_error::overflow ? scan_error::overflow : it == end ? scan_error::end : scan_error::invalid;
+            return {usize(it - begin), e};
+        }
+        it = r.ptr;
+    }
+}
+
+template<typename... Args>
+scan_result scan(string_view input, fmt::scan_string<Args...> fmt, Args&... args) noexcept
+{
+    const fmt::scan_arg scan_args[sizeof...(Args) + 1]{fmt::impl::make_scan_arg(args)...};
+    return fmt::vscan(input, fmt.str, fmt.parts, span<const fmt::scan_arg>{scan_args, sizeof...(Args)});
+}
+
+template<typename... Args>
+scan_result scan(string_view input, fmt::runtime_format_string fmt, Args&... args) noexcept
+{
+    static_assert(sizeof...(Args) <= fmt::impl::MAX_ARGS, "too many scan arguments");
+    static_assert((fmt::impl::is_scan_output<Args> && ...), "zen::scan reads integers, floats, bools, chars and strings");
+    constexpr fmt::impl::arg_kind kinds[sizeof...(Args) + 1]{fmt::impl::arg_kind_of<Args>()...};
+    fmt::impl::part parts[fmt::impl::MAX_RUNTIME_PARTS]{};
+    const char* error = fmt::impl::parse_format(fmt.str, parts, fmt::impl::MAX_RUNTIME_PARTS, {sizeof...(Args), kinds, nullptr});
+    if (error == nullptr)
+        error = fmt::impl::check_scan_parts(parts);
+    if (ZEN_UNLIKELY(error != nullptr))
+        return {0, scan_error::format};
+    const fmt::scan_arg scan_args[sizeof...(Args) + 1]{fmt::impl::make_scan_arg(args)...};
+    return fmt::vscan(input, fmt.str, parts, span<const fmt::scan_arg>{scan_args, sizeof...(Args)});
+}
+
+}
+
+#endif // ZEN_SCAN_H
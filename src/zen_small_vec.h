@@ -149,7 +149,7 @@ protected:
     static ZEN_FORCEINLINE constexpr void resize_shrink(usize) {}
     static ZEN_FORCEINLINE constexpr void reset_small() {}
     
-    ZEN_FORCEINLINE constexpr void ensure_capacity(usize n) {
+    ZEN_FORCEINLINE constexpr void ensure_capacity([[maybe_unused]] usize n) {
         assertf(m_size + n <= N, "vector is full");
     }
 
@@ -198,7 +198,7 @@ protected:
             new_cap <<= 1;
 
         auto* mem = static_cast<T*>(static_cast<void*>(alloc.allocate(new_cap * sizeof(T))));
-        mem::move(m_data, m_data + m_size, mem);
+        mem::relocate(m_data, m_data + m_size, mem);
         if (!small()) 
             deallocate();
 
@@ -219,7 +219,7 @@ protected:
     ZEN_FORCEINLINE void resize_shrink(usize n) {
         if (ZEN_LIKELY(!small() && n <= N)) {
             T* dst = m_buf;
-            mem::move(data(), data() + m_size, dst);
+            mem::relocate(data(), data() + n, dst);
             deallocate();
             m_cap = N;
             m_data = dst;
@@ -248,7 +248,7 @@ public:
         if (ZEN_LIKELY(small() || m_size > N))
             return;
         T* buf = m_buf;
-        mem::move(m_data, m_data + m_size, buf);
+        mem::relocate(m_data, m_data + m_size, buf);
         deallocate();
         m_cap = N;
         m_data = buf;
@@ -0,0 +1,510 @@
+#ifndef ZEN_STR_H
+#define ZEN_STR_H
+
+#include "zen_bit.h"
+#include "zen_string.h"
+
+#ifdef ZEN_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef ZEN_AVX2
+#include <immintrin.h>
+#endif
+
+// String search kernels for string_view and everything that converts to it, like sstring and small_string
+// Positions and npos follow std::string_view, AVX2 and SSE2 paths are picked at compile time with scalar fallbacks
+namespace zen::str {
+
+static constexpr usize npos = string_view::npos;
+
+// Set of bytes for find_any, built once and reused for many searches
+struct byteset;
+
+// First c in s at or after pos
+usize find(string_view s, char c, usize pos = 0) noexcept;
+
+// First needle in s at or after pos
+usize find(string_view s, string_view needle, usize pos = 0) noexcept;
+
+// Last c in s that starts at or before pos
+usize rfind(string_view s, char c, usize pos = npos) noexcept;
+
+// Last needle in s that starts at or before pos
+usize rfind(string_view s, string_view needle, usize pos = npos) noexcept;
+
+// First char of s in set at or after pos, like find_first_of
+usize find_any(string_view s, const byteset& set, usize pos = 0) noexcept;
+
+// Number of c in s
+usize count(string_view s, char c) noexcept;
+
+bool  equal(string_view a, string_view b) noexcept;
+bool  starts_with(string_view s, string_view prefix) noexcept;
+bool  ends_with(string_view s, string_view suffix) noexcept;
+
+// Lazy range of the fields returned by zen::split
+struct split_range;
+
+}
+
+namespace zen {
+
+// Fields of s between any of the delims, computed while iterating. k delimiters make k + 1 fields, empty ones included.
+// Delimiters are found 64 chars at a time as a bitmask, a long field costs one block lookup per 64 chars.
+// The range holds a view of s, s has to outlive it.
+//
+//  for (string_view field: zen::split("GET /index.html 200", ' ')) ...
+str::split_range split(string_view s, string_view delims) noexcept;
+str::split_range split(string_view s, char delim) noexcept;
+str::split_range split(string_view s, const str::byteset& delims) noexcept;
+
+}
+
+
+namespace zen::str {
+
+namespace impl { struct set_lookup; }
+
+struct byteset {
+    // Up to this many chars are also kept as a list, SSE2 compares against each of them
+    static constexpr usize MAX_LISTED = 8;
+
+    constexpr byteset() = default;
+
+    constexpr byteset(string_view chars) noexcept {
+        for (char c: chars)
+            insert(c);
+    }
+
+    constexpr void insert(char c) noexcept {
+        const u8 b = u8(c);
+        if (contains(c))
+            return;
+        if (m_size < MAX_LISTED)
+            m_listed[m_size] = c;
+        ++m_size;
+        m_bits[b >> 6] |= u64(1) << (b & 63);
+        // Rows by low nibble, one bit per high nibble, split in two tables for the high nibbles 0-7 and 8-15
+        (b < 128 ? m_low_rows : m_high_rows)[b & 15] |= u8(1u << ((b >> 4) & 7));
+    }
+
+    ZEN_ND constexpr bool  contains(char c) const noexcept { return (m_bits[u8(c) >> 6] >> (u8(c) & 63)) & 1; }
+    ZEN_ND constexpr usize size()           const noexcept { return m_size; }
+    ZEN_ND constexpr bool  empty()          const noexcept { return m_size == 0; }
+
+private:
+    friend struct impl::set_lookup;
+
+    u64   m_bits[4]{};
+    u8    m_low_rows[16]{};
+    u8    m_high_rows[16]{};
+    char  m_listed[MAX_LISTED]{};
+    usize m_size{};
+};
+
+}
+
+
+// String search impl
+namespace zen::str::impl {
+
+ZEN_FORCEINLINE u64 load_u64(const char* p) noexcept { u64 v; memcpy(&v, p, sizeof(v)); return v; }
+ZEN_FORCEINLINE u32 load_u32(const char* p) noexcept { u32 v; memcpy(&v, p, sizeof(v)); return v; }
+
+#if defined(ZEN_AVX2)
+static constexpr usize BLOCK = 32;
+
+ZEN_FORCEINLINE __m256i load(const char* p)   noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+ZEN_FORCEINLINE __m256i splat(char c)         noexcept { return _mm256_set1_epi8(c); }
+ZEN_FORCEINLINE __m256i cmp(__m256i a, __m256i b)   noexcept { return _mm256_cmpeq_epi8(a, b); }
+ZEN_FORCEINLINE __m256i any(__m256i a, __m256i b)   noexcept { return _mm256_or_si256(a, b); }
+ZEN_FORCEINLINE u32     mask(__m256i a)             noexcept { return u32(_mm256_movemask_epi8(a)); }
+ZEN_FORCEINLINE u32     eq_mask(__m256i a, __m256i b) noexcept { return u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b))); }
+ZEN_FORCEINLINE u32     eq_mask2(__m256i a, __m256i b, __m256i c, __m256i d) noexcept {
+    return u32(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, b), _mm256_cmpeq_epi8(c, d))));
+}
+#elif defined(ZEN_SSE2)
+static constexpr usize BLOCK = 16;
+
+ZEN_FORCEINLINE __m128i load(const char* p)   noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+ZEN_FORCEINLINE __m128i splat(char c)         noexcept { return _mm_set1_epi8(c); }
+ZEN_FORCEINLINE __m128i cmp(__m128i a, __m128i b)   noexcept { return _mm_cmpeq_epi8(a, b); }
+ZEN_FORCEINLINE __m128i any(__m128i a, __m128i b)   noexcept { return _mm_or_si128(a, b); }
+ZEN_FORCEINLINE u32     mask(__m128i a)             noexcept { return u32(_mm_movemask_epi8(a)); }
+ZEN_FORCEINLINE u32     eq_mask(__m128i a, __m128i b) noexcept { return u32(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b))); }
+ZEN_FORCEINLINE u32     eq_mask2(__m128i a, __m128i b, __m128i c, __m128i d) noexcept {
+    return u32(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, b), _mm_cmpeq_epi8(c, d))));
+}
+#endif
+
+// Mask of the bytes of a block that are in a byteset
+// AVX2 looks up every byte with two shuffles, one for the row of its low nibble and one for the bit of its high nibble.
+// SSE2 has no byte shuffle, sets of up to MAX_LISTED chars compare against each of them and larger ones are not vectorized.
+#if defined(ZEN_AVX2)
+struct set_lookup {
+    explicit set_lookup(const byteset& set) noexcept
+        : low_rows{_mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(set.m_low_rows)))}
+        , high_rows{_mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(set.m_high_rows)))}
+        , single{_mm256_set1_epi8(set.m_listed[0])}
+        , is_single{set.size() == 1} {}
+
+    static constexpr bool vector() noexcept { return true; }
+
+    ZEN_FORCEINLINE u32 mask(const char* p) const noexcept {
+        // One char, the most common set, is a plain compare
+        if (is_single)
+            return eq_mask(load(p), single);
+        const __m256i bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                                              1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+        const __m256i nibble = _mm256_set1_epi8(0x0f);
+        const __m256i v = load(p);
+        const __m256i lo = _mm256_and_si256(v, nibble);
+        const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+        const __m256i row = _mm256_blendv_epi8(_mm256_shuffle_epi8(low_rows, lo), _mm256_shuffle_epi8(high_rows, lo), _mm256_cmpgt_epi8(hi, _mm256_set1_epi8(7)));
+        const __m256i bit = _mm256_shuffle_epi8(bits, hi);
+        return u32(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit)));
+    }
+
+    __m256i low_rows;
+    __m256i high_rows;
+    __m256i single;
+    bool    is_single;
+};
+#elif defined(ZEN_SSE2)
+struct set_lookup {
+    explicit set_lookup(const byteset& set) noexcept : n_chars{set.size()} {
+        for (usize c = 0; c < n_chars && c < byteset::MAX_LISTED; ++c)
+            chars[c] = _mm_set1_epi8(set.m_listed[c]);
+    }
+
+    bool vector() const noexcept { return n_chars <= byteset::MAX_LISTED; }
+
+    ZEN_FORCEINLINE u32 mask(const char* p) const noexcept {
+        const __m128i v = load(p);
+        __m128i any = _mm_setzero_si128();
+        for (usize c = 0; c < n_chars; ++c)
+            any = _mm_or_si128(any, _mm_cmpeq_epi8(v, chars[c]));
+        return u32(_mm_movemask_epi8(any));
+    }
+
+    __m128i chars[byteset::MAX_LISTED];
+    usize   n_chars;
+};
+#endif
+
+// Highest set bit of a non-zero mask
+ZEN_FORCEINLINE usize last_bit(u32 mask) noexcept { return 31 - leading_zeros(mask); }
+
+// Compares n chars, overlapping loads cover every length without a byte loop
+ZEN_FORCEINLINE bool equal_n(const char* a, const char* b, usize n) noexcept {
+    if (n >= 16) {
+        #ifdef ZEN_SSE2
+        for (usize i = 0; i + 16 < n; i += 16) {
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)))) != 0xffff)
+                return false;
+        }
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + n - 16)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + n - 16)))) == 0xffff;
+        #else
+        return memcmp(a, b, n) == 0;
+        #endif
+    }
+    if (n >= 8)
+        return ((load_u64(a) ^ load_u64(b)) | (load_u64(a + n - 8) ^ load_u64(b + n - 8))) == 0;
+    if (n >= 4)
+        return ((load_u32(a) ^ load_u32(b)) | (load_u32(a + n - 4) ^ load_u32(b + n - 4))) == 0;
+    if (n > 0)
+        return a[0] == b[0] && a[n >> 1] == b[n >> 1] && a[n - 1] == b[n - 1];
+    return true;
+}
+
+}
+
+namespace zen {
+
+inline usize str::find(string_view s, char c, usize pos) noexcept
+{
+    if (pos >= s.size())
+        return npos;
+    const char* data = s.data();
+    const usize n = s.size();
+    usize i = pos;
+    #ifdef ZEN_SSE2
+    // Four blocks are compared before one branch on all of them
+    const auto v = impl::splat(c);
+    for (; i + 4 * impl::BLOCK <= n; i += 4 * impl::BLOCK) {
+        const auto e0 = impl::cmp(impl::load(data + i), v);
+        const auto e1 = impl::cmp(impl::load(data + i + impl::BLOCK), v);
+        const auto e2 = impl::cmp(impl::load(data + i + 2 * impl::BLOCK), v);
+        const auto e3 = impl::cmp(impl::load(data + i + 3 * impl::BLOCK), v);
+        if (impl::mask(impl::any(impl::any(e0, e1), impl::any(e2, e3))) != 0) {
+            if (const u32 m = impl::mask(e0); m != 0) return i + trailing_zeros(m);
+            if (const u32 m = impl::mask(e1); m != 0) return i + impl::BLOCK + trailing_zeros(m);
+            if (const u32 m = impl::mask(e2); m != 0) return i + 2 * impl::BLOCK + trailing_zeros(m);
+            return i + 3 * impl::BLOCK + trailing_zeros(impl::mask(e3));
+        }
+    }
+    for (; i + impl::BLOCK <= n; i += impl::BLOCK) {
+        if (const u32 mask = impl::eq_mask(impl::load(data + i), v); mask != 0)
+            return i + trailing_zeros(mask);
+    }
+    #endif
+    for (; i < n; ++i) {
+        if (data[i] == c)
+            return i;
+    }
+    return npos;
+}
+
+// Compares the first and last char of needle at every position of a block, only candidates that match both are compared
+// in full, see http://0x80.pl/articles/simd-strfind.html
+inline usize str::find(string_view s, string_view needle, usize pos) noexcept
+{
+    const usize m = needle.size();
+    if (m == 0)
+        return pos <= s.size() ? pos : npos;
+    if (m == 1)
+        return find(s, needle[0], pos);
+    if (pos >= s.size() || s.size() - pos < m)
+        return npos;
+    const char* data = s.data();
+    const char* nd = needle.data();
+    const usize last = s.size() - m;    // Last position needle can start at
+    usize i = pos;
+    #ifdef ZEN_SSE2
+    const auto first_v = impl::splat(nd[0]);
+    const auto last_v = impl::splat(nd[m - 1]);
+    // Two blocks at a time, their candidates are walked as one 64 or 32 bit mask
+    for (; i + 2 * impl::BLOCK <= last + 1; i += 2 * impl::BLOCK) {
+        const u64 lo = impl::eq_mask2(impl::load(data + i), first_v, impl::load(data + i + m - 1), last_v);
+        const u64 hi = impl::eq_mask2(impl::load(data + i + impl::BLOCK), first_v, impl::load(data + i + impl::BLOCK + m - 1), last_v);
+        for (u64 mask = lo | (hi << impl::BLOCK); mask != 0; mask &= mask - 1) {
+            const usize at = i + trailing_zeros(mask);
+            if (impl::equal_n(data + at + 1, nd + 1, m - 2))
+                return at;
+        }
+    }
+    for (; i + impl::BLOCK <= last + 1; i += impl::BLOCK) {
+        for (u32 mask = impl::eq_mask2(impl::load(data + i), first_v, impl::load(data + i + m - 1), last_v); mask != 0; mask &= mask - 1) {
+            const usize at = i + trailing_zeros(mask);
+            if (impl::equal_n(data + at + 1, nd + 1, m - 2))
+                return at;
+        }
+    }
+    #endif
+    for (; i <= last; ++i) {
+        if (data[i] == nd[0] && data[i + m - 1] == nd[m - 1] && impl::equal_n(data + i + 1, nd + 1, m - 2))
+            return i;
+    }
+    return npos;
+}
+
+inline usize str::rfind(string_view s, char c, usize pos) noexcept
+{
+    const char* data = s.data();
+    usize i = pos < s.size() ? pos + 1 : s.size();  // One past the last position that is searched
+    #ifdef ZEN_SSE2
+    const auto v = impl::splat(c);
+    for (; i >= impl::BLOCK; i -= impl::BLOCK) {
+        if (const u32 mask = impl::eq_mask(impl::load(data + i - impl::BLOCK), v); mask != 0)
+            return i - impl::BLOCK + impl::last_bit(mask);
+    }
+    #endif
+    while (i > 0) {
+        if (data[--i] == c)
+            return i;
+    }
+    return npos;
+}
+
+inline usize str::rfind(string_view s, string_view needle, usize pos) noexcept
+{
+    const usize m = needle.size();
+    if (m > s.size())
+        return npos;
+    if (m == 0)
+        return pos < s.size() ? pos : s.size();
+    if (m == 1)
+        return rfind(s, needle[0], pos);
+    const char* data = s.data();
+    const char* nd = needle.data();
+    usize i = (pos < s.size() - m ? pos : s.size() - m) + 1;   // One past the last start that is searched
+    #ifdef ZEN_SSE2
+    const auto first_v = impl::splat(nd[0]);
+    const auto last_v = impl::splat(nd[m - 1]);
+    for (; i >= impl::BLOCK; i -= impl::BLOCK) {
+        const usize base = i - impl::BLOCK;
+        for (u32 mask = impl::eq_mask2(impl::load(data + base), first_v, impl::load(data + base + m - 1), last_v); mask != 0; ) {
+            const usize bit = impl::last_bit(mask);
+            if (impl::equal_n(data + base + bit + 1, nd + 1, m - 2))
+                return base + bit;
+            mask &= ~(u32(1) << bit);
+        }
+    }
+    #endif
+    while (i > 0) {
+        --i;
+        if (data[i] == nd[0] && data[i + m - 1] == nd[m - 1] && impl::equal_n(data + i + 1, nd + 1, m - 2))
+            return i;
+    }
+    return npos;
+}
+
+inline usize str::find_any(string_view s, const byteset& set, usize pos) noexcept
+{
+    if (pos >= s.size())
+        return npos;
+    const char* data = s.data();
+    const usize n = s.size();
+    usize i = pos;
+    #ifdef ZEN_SSE2
+    if (const impl::set_lookup lookup{set}; lookup.vector()) {
+        for (; i + impl::BLOCK <= n; i += impl::BLOCK) {
+            if (const u32 mask = lookup.mask(data + i); mask != 0)
+                return i + trailing_zeros(mask);
+        }
+    }
+    #endif
+    for (; i < n; ++i) {
+        if (set.contains(data[i]))
+            return i;
+    }
+    return npos;
+}
+
+inline usize str::count(string_view s, char c) noexcept
+{
+    const char* data = s.data();
+    const usize n = s.size();
+    usize i = 0, total = 0;
+    #ifdef ZEN_SSE2
+    const auto v = impl::splat(c);
+    for (; i + impl::BLOCK <= n; i += impl::BLOCK)
+        total += bit_count(impl::eq_mask(impl::load(data + i), v));
+    #endif
+    for (; i < n; ++i)
+        total += data[i] == c;
+    return total;
+}
+
+inline bool str::equal(string_view a, string_view b) noexcept
+{
+    return a.size() == b.size() && impl::equal_n(a.data(), b.data(), a.size());
+}
+
+inline bool str::starts_with(string_view s, string_view prefix) noexcept
+{
+    return s.size() >= prefix.size() && impl::equal_n(s.data(), prefix.data(), prefix.size());
+}
+
+inline bool str::ends_with(string_view s, string_view suffix) noexcept
+{
+    return s.size() >= suffix.size() && impl::equal_n(s.data() + s.size() - suffix.size(), suffix.data(), suffix.size());
+}
+
+}
+
+
+// Splitting
+namespace zen::str {
+
+struct split_sentinel {};
+
+struct split_range {
+    struct iterator {
+        using value_type = string_view;
+        using difference_type = std::ptrdiff_t;
+
+        ZEN_ND string_view operator*() const noexcept { return string_view{m_range->m_text.data() + m_start, m_end - m_start}; }
+
+        iterator& operator++() noexcept {
+            if (m_end == m_range->m_text.size())
+                m_start = npos;
+            else {
+                m_start = m_end + 1;
+                m_end = next_delim();
+            }
+            return *this;
+        }
+
+        iterator operator++(int) noexcept { iterator it{*this}; ++*this; return it; }
+
+        ZEN_ND bool operator==(split_sentinel) const noexcept { return m_start == npos; }
+        ZEN_ND bool operator!=(split_sentinel) const noexcept { return m_start != npos; }
+
+    private:
+        friend struct split_range;
+
+        // Position of the next delimiter, or the end of the text, the current block is refilled as its bits run out
+        ZEN_FORCEINLINE usize next_delim() noexcept {
+            const usize n = m_range->m_text.size();
+            while (m_mask == 0) {
+                if (m_block + 64 >= n)
+                    return n;
+                m_block += 64;
+                m_mask = m_range->block_mask(m_block);
+            }
+            const usize at = m_block + trailing_zeros(m_mask);
+            m_mask &= m_mask - 1;
+            return at;
+        }
+
+        const split_range* m_range{};
+        usize              m_start{};       // Start of the current field, npos past the last one
+        usize              m_end{};         // End of the current field
+        usize              m_block{};       // Start of the 64 chars m_mask covers
+        u64                m_mask{};        // Delimiters of the block after m_end
+    };
+
+    split_range(string_view s, const byteset& delims) noexcept 
+        : m_text{s}, m_delims{delims}
+        #ifdef ZEN_SSE2
+        , m_lookup{delims}
+        #endif
+    {}
+
+    ZEN_ND iterator begin() const noexcept {
+        iterator it{};
+        it.m_range = this;
+        it.m_mask = block_mask(0);
+        it.m_end = it.next_delim();
+        return it;
+    }
+
+    ZEN_ND split_sentinel end() const noexcept { return {}; }
+
+private:
+    // Bit i is set when char block + i is a delimiter
+    u64 block_mask(usize block) const noexcept {
+        const char* p = m_text.data() + block;
+        const usize n = m_text.size() - block;
+        u64 mask = 0;
+        #ifdef ZEN_SSE2
+        if (n >= 64 && m_lookup.vector()) {
+            for (usize i = 0; i < 64; i += impl::BLOCK)
+                mask |= u64(m_lookup.mask(p + i)) << i;
+            return mask;
+        }
+        #endif
+        for (usize i = 0, end = n < 64 ? n : 64; i < end; ++i)
+            mask |= u64(m_delims.contains(p[i])) << i;
+        return mask;
+    }
+
+    string_view       m_text;
+    byteset           m_delims;
+    #ifdef ZEN_SSE2
+    impl::set_lookup  m_lookup;
+    #endif
+};
+
+}
+
+namespace zen {
+
+inline str::split_range split(string_view s, string_view delims) noexcept { return str::split_range{s, str::byteset{delims}}; }
+inline str::split_range split(string_view s, char delim) noexcept { return split(s, string_view{&delim, 1}); }
+inline str::split_range split(string_view s, const str::byteset& delims) noexcept { return str::split_range{s, delims}; }
+
+}
+
+#endif // ZEN_STR_H
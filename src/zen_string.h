@@ -2,6 +2,7 @@
 #define ZEN_STRING_H
 
 #include "zen_num.h"
+#include "zen_alloc.h"
 #include <cstring>
 #include <string_view>
 
@@ -9,6 +10,17 @@ namespace zen {
 
 using std::string_view;
 
+// Inline chars that keep small_string inside of a cache line
+static constexpr usize expected_small_string_capacity = ZEN_CACHE_LINE - 3 * sizeof(usize) - sizeof(alloc_t<>);
+
+// Growable string, N chars are stored inline and longer strings move to memory from its allocator
+// Not null-terminated, like sstring. Moves copy the inline chars and steal the heap pointer, there is
+// no pointer into the string itself, so it can also be relocated with memcpy.
+template<usize N = expected_small_string_capacity>
+struct small_string;
+
+using string = small_string<>;
+
 template<usize N>
 struct sstring {
     using size_type = num::with::max_value<N>;
@@ -49,6 +61,172 @@ private:
     size_type m_size{};
 };
 
+
+template<usize N>
+struct small_string {
+    static_assert(N > 0, "small_string needs some inline storage");
+    using size_type = usize;
+    using value_type = char;
+
+    explicit small_string(alloc_t<> alloc = std::pmr::get_default_resource()) noexcept : m_alloc{alloc} {}
+
+    small_string(string_view s, alloc_t<> alloc = std::pmr::get_default_resource()) noexcept : m_alloc{alloc} { append(s.data(), s.size()); }
+
+    small_string(const char* s, alloc_t<> alloc = std::pmr::get_default_resource()) noexcept : small_string{string_view{s}, alloc} {}
+
+    small_string(const small_string& other) noexcept : small_string{other.view()} {}
+
+    small_string(small_string&& other) noexcept : m_alloc{other.m_alloc} { take(other); }
+
+    small_string& operator=(const small_string& other) noexcept {
+        if (this != &other) assign(other.data(), other.size());
+        return *this;
+    }
+
+    small_string& operator=(small_string&& other) noexcept {
+        if (this == &other) return *this;
+        if (m_alloc == other.m_alloc) {
+            reset();
+            take(other);
+        } else {
+            assign(other.data(), other.size());
+            other.clear();
+        }
+        return *this;
+    }
+
+    small_string& operator=(string_view s) noexcept { assign(s.data(), s.size()); return *this; }
+
+    ~small_string() noexcept { reset(); }
+
+    operator string_view() const noexcept { return string_view{data(), m_size}; }
+    string_view     view() const noexcept { return string_view{data(), m_size}; }
+
+    ZEN_ND bool                     small()               const noexcept { return m_heap == nullptr; }
+    ZEN_ND usize                    capacity()            const noexcept { return m_cap; }
+    ZEN_ND bool                     empty()               const noexcept { return m_size == 0; }
+    ZEN_ND usize                    size()                const noexcept { return m_size; }
+    ZEN_ND alloc_t<>                get_allocator()       const noexcept { return m_alloc; }
+    ZEN_ND char*                    data()                      noexcept { return m_heap != nullptr ? m_heap : m_buf; }
+    ZEN_ND const char*              data()                const noexcept { return m_heap != nullptr ? m_heap : m_buf; }
+    ZEN_ND char*                    begin()                     noexcept { return data(); }
+    ZEN_ND const char*              begin()               const noexcept { return data(); }
+    ZEN_ND char*                    end()                       noexcept { return data() + m_size; }
+    ZEN_ND const char*              end()                 const noexcept { return data() + m_size; }
+    ZEN_ND char&                    front()                     noexcept { return *data(); }
+    ZEN_ND char                     front()               const noexcept { return *data(); }
+    ZEN_ND char&                    back()                      noexcept { return *(end() - 1); }
+    ZEN_ND char                     back()                const noexcept { return *(end() - 1); }
+    ZEN_ND char&                    operator[](usize i)         noexcept { return data()[i]; }
+    ZEN_ND char                     operator[](usize i)   const noexcept { return data()[i]; }
+
+    void clear()                                    noexcept { m_size = 0; }
+    void pop_back()                                 noexcept { --m_size; }
+    void push_back(char c)                          noexcept { append(c); }
+    void append(string_view s)                      noexcept { append(s.data(), s.size()); }
+    void assign(const char* s, usize n)             noexcept { m_size = 0; append(s, n); }
+    void assign(string_view s)                      noexcept { assign(s.data(), s.size()); }
+
+    small_string& operator+=(char c)                noexcept { append(c); return *this; }
+    small_string& operator+=(string_view s)         noexcept { append(s.data(), s.size()); return *this; }
+
+    void append(char c) noexcept { 
+        if (ZEN_UNLIKELY(m_size == m_cap)) grow(1);
+        data()[m_size++] = c; 
+    }
+
+    // s can point into this string, the old chars stay alive until they are copied
+    void append(const char* s, usize n) noexcept { 
+        if (ZEN_UNLIKELY(n > m_cap - m_size)) grow(n, s);
+        else memmove(end(), s, n); 
+        m_size += n; 
+    }
+
+    void append_n(char c, usize n) noexcept { 
+        if (ZEN_UNLIKELY(n > m_cap - m_size)) grow(n);
+        memset(end(), c, n); 
+        m_size += n; 
+    }
+
+    // Sink protocol, n writable chars at the end that commit(n) keeps
+    char* reserve(usize n) noexcept {
+        if (ZEN_UNLIKELY(n > m_cap - m_size)) grow(n);
+        return end();
+    }
+
+    void commit(usize n) noexcept { m_size += n; }
+
+    void resize(usize n, char c = '\0') noexcept {
+        if (n > m_size) append_n(c, n - m_size);
+        else m_size = n;
+    }
+
+    // Moves the chars back inline when they fit
+    void shrink_to_fit() noexcept {
+        if (small() || m_size > N) return;
+        char* heap = m_heap;
+        memcpy(m_buf, heap, m_size);
+        m_alloc.deallocate(reinterpret_cast<u8*>(heap), m_cap);
+        m_heap = nullptr;
+        m_cap = N;
+    }
+
+    friend bool operator==(const small_string& l, const small_string& r)   noexcept { return l.view() == r.view(); }
+    friend bool operator==(const small_string& l, string_view r)           noexcept { return l.view() == r; }
+    friend bool operator==(const small_string& l, const char* r)           noexcept { return l.view() == r; }
+
+    template<typename Out>
+    friend Out& operator<<(Out& o, const small_string& v) noexcept { return o << string_view(v); }
+
+private:
+    // Doubles the capacity until n more chars fit, src are n chars to append while the old memory is still alive
+    ZEN_NEVERINLINE void grow(usize n, const char* src = nullptr) noexcept {
+        usize new_cap = m_cap << 1;
+        while (new_cap < m_size + n) 
+            new_cap <<= 1;
+        char* mem = reinterpret_cast<char*>(m_alloc.allocate(new_cap));
+        memcpy(mem, data(), m_size);
+        if (src != nullptr) 
+            memcpy(mem + m_size, src, n);
+        if (!small()) 
+            m_alloc.deallocate(reinterpret_cast<u8*>(m_heap), m_cap);
+        m_heap = mem;
+        m_cap = new_cap;
+    }
+
+    void reset() noexcept {
+        if (!small()) 
+            m_alloc.deallocate(reinterpret_cast<u8*>(m_heap), m_cap);
+        m_heap = nullptr;
+        m_size = 0;
+        m_cap = N;
+    }
+
+    // The whole inline buffer is copied, a fixed size copy is cheaper than a branch on the size
+    void take(small_string& other) noexcept {
+        memcpy(m_buf, other.m_buf, N);
+        m_heap = other.m_heap;
+        m_size = other.m_size;
+        m_cap = other.m_cap;
+        other.m_heap = nullptr;
+        other.m_size = 0;
+        other.m_cap = N;
+    }
+
+    char*     m_heap{};
+    usize     m_size{};
+    usize     m_cap{N};
+    alloc_t<> m_alloc{};
+    char      m_buf[N];
+};
+
+namespace mem {
+
+template<usize N>
+static constexpr bool is_trivially_relocatable<small_string<N>> = true;
+
+}
+
 }
 
 #endif // ZEN_STRING_H
@@ -0,0 +1,226 @@
+#ifndef ZEN_STRING_POOL_H
+#define ZEN_STRING_POOL_H
+
+#include "zen_alloc.h"
+#include "zen_bit.h"
+#include "zen_fmt.h"
+#include "zen_handle.h"
+#include "zen_span.h"
+#include <atomic>
+#include <mutex>
+
+namespace zen {
+
+ZEN_DEFINE_HANDLE(string_id, u32);
+
+// Interns strings into an arena and gives every distinct string a dense id, counting up from 0
+// Equal strings get equal ids, so comparing them is one integer compare and ids index arrays in place of a hash.
+// find and view never lock and can run while other threads intern, intern only locks for strings it has not seen.
+// Nothing is freed before the pool is destroyed, views stay valid for its whole lifetime.
+//
+//  zen::string_pool pool;
+//  const zen::string_id cpu = pool.intern("cpu.usage");
+//  assert(pool.find("cpu.usage") == cpu && pool.view(cpu) == "cpu.usage");
+template<typename Id = string_id>
+struct basic_string_pool;
+
+using string_pool = basic_string_pool<>;
+
+}
+
+
+// String pool impl
+namespace zen::impl {
+
+ZEN_FORCEINLINE u64 pool_load_u64(const char* p) noexcept { u64 v; memcpy(&v, p, sizeof(v)); return v; }
+ZEN_FORCEINLINE u64 pool_load_u32(const char* p) noexcept { u32 v; memcpy(&v, p, sizeof(v)); return v; }
+
+// Multiply-xorshift hash, identifiers are short so the tail is read in at most two loads
+inline u64 hash_chars(const char* p, usize n) noexcept {
+    u64 h = 0x9e3779b97f4a7c15 ^ (n * 0xbf58476d1ce4e5b9);
+    for (; n >= 8; p += 8, n -= 8) {
+        h = (h ^ pool_load_u64(p)) * 0xbf58476d1ce4e5b9;
+        h ^= h >> 31;
+    }
+    u64 tail = 0;
+    if (n >= 4)
+        tail = (pool_load_u32(p) << 32) | pool_load_u32(p + n - 4);
+    else if (n > 0)
+        tail = (u64(u8(p[0])) << 16) | (u64(u8(p[n >> 1])) << 8) | u64(u8(p[n - 1]));
+    h = (h ^ tail) * 0x94d049bb133111eb;
+    h ^= h >> 32;
+    h *= 0xbf58476d1ce4e5b9;
+    return h ^ (h >> 29);
+}
+
+}
+
+namespace zen {
+
+template<typename Id>
+struct basic_string_pool {
+    using id_type = Id;
+    using value_type = typename Id::type;
+
+    static_assert(std::is_unsigned_v<value_type> && sizeof(value_type) <= sizeof(u32), "string_pool ids are at most 32 bits");
+
+    explicit basic_string_pool(alloc_t<> alloc = std::pmr::get_default_resource()) noexcept : m_arena{alloc.resource()} {
+        m_table.store(make_table(INITIAL_SLOTS), std::memory_order_relaxed);
+    }
+
+    basic_string_pool(const basic_string_pool&) = delete;
+    basic_string_pool& operator=(const basic_string_pool&) = delete;
+
+    // Id of s, adding a copy of s to the pool the first time it is seen
+    Id intern(string_view s) noexcept {
+        const u64 hash = impl::hash_chars(s.data(), s.size());
+        if (const Id id = find(s, hash); id.valid())
+            return id;
+        std::lock_guard lock{m_lock};
+        if (const Id id = find(s, hash); id.valid())
+            return id;
+        reserve_slots(1);
+        return insert(s, hash);
+    }
+
+    // Interns strings under one lock, for loading dictionaries. ids[i] is the id of strings[i] when ids is set.
+    void intern_all(span<const string_view> strings, Id* ids = nullptr) noexcept {
+        std::lock_guard lock{m_lock};
+        reserve_slots(strings.size());
+        for (usize i = 0; i < strings.size(); ++i) {
+            const string_view s = strings[i];
+            const u64 hash = impl::hash_chars(s.data(), s.size());
+            Id id = find(s, hash);
+            if (!id.valid())
+                id = insert(s, hash);
+            if (ids != nullptr)
+                ids[i] = id;
+        }
+    }
+
+    // Id of s when it was interned, otherwise an invalid id
+    ZEN_ND Id find(string_view s) const noexcept {
+        return find(s, impl::hash_chars(s.data(), s.size()));
+    }
+
+    ZEN_ND string_view view(Id id) const noexcept {
+        const entry& e = entry_at(id.value());
+        return string_view{e.data, e.size};
+    }
+
+    ZEN_ND usize size() const noexcept { return m_size.load(std::memory_order_acquire); }
+
+private:
+    struct entry {
+        const char* data;
+        usize       size;
+    };
+
+    // Open addressing with linear probing, a slot is the high half of the hash over the id + 1, 0 when empty
+    struct table {
+        std::atomic<u64>* slots;
+        usize             mask;
+    };
+
+    // Entries live in segments that double in size and never move, readers index them without a lock
+    static constexpr usize FIRST_SEGMENT_LOG2 = 6;
+    static constexpr usize MAX_SEGMENTS = sizeof(value_type) * 8 - FIRST_SEGMENT_LOG2 + 1;
+    static constexpr usize INITIAL_SLOTS = 64;
+    static constexpr usize MAX_IDS = usize(value_type(~value_type(0)));
+
+    static ZEN_FORCEINLINE usize segment_of(usize i) noexcept {
+        return sizeof(usize) * 8 - 1 - leading_zeros(i + (usize(1) << FIRST_SEGMENT_LOG2)) - FIRST_SEGMENT_LOG2;
+    }
+
+    static ZEN_FORCEINLINE usize offset_in_segment(usize i, usize segment) noexcept {
+        return i + (usize(1) << FIRST_SEGMENT_LOG2) - (usize(1) << (segment + FIRST_SEGMENT_LOG2));
+    }
+
+    const entry& entry_at(usize i) const noexcept {
+        const usize segment = segment_of(i);
+        return m_segments[segment].load(std::memory_order_acquire)[offset_in_segment(i, segment)];
+    }
+
+    Id find(string_view s, u64 hash) const noexcept {
+        const table* t = m_table.load(std::memory_order_acquire);
+        const u64 tag = hash >> 32;
+        for (usize i = usize(hash) & t->mask; ; i = (i + 1) & t->mask) {
+            const u64 slot = t->slots[i].load(std::memory_order_acquire);
+            if (slot == 0)
+                return Id{};
+            if ((slot >> 32) == tag) {
+                const value_type id = value_type(u32(slot) - 1);
+                const entry& e = entry_at(id);
+                if (e.size == s.size() && memcmp(e.data, s.data(), s.size()) == 0)
+                    return Id{id};
+            }
+        }
+    }
+
+    // The rest is only called with m_lock held
+
+    table* make_table(usize n_slots) noexcept {
+        auto* slots = static_cast<std::atomic<u64>*>(m_arena.allocate(n_slots * sizeof(std::atomic<u64>), alignof(std::atomic<u64>)));
+        for (usize i = 0; i < n_slots; ++i)
+            mem::construct_at(slots + i, u64(0));
+        return mem::construct_at(static_cast<table*>(m_arena.allocate(sizeof(table), alignof(table))), table{slots, n_slots - 1});
+    }
+
+    // Keeps the table at most half full after n more strings, readers can still be probing the old table
+    // so it is left in the arena instead of being freed
+    void reserve_slots(usize n) noexcept {
+        const table* old = m_table.load(std::memory_order_relaxed);
+        const usize needed = 2 * (m_size.load(std::memory_order_relaxed) + n);
+        if (ZEN_LIKELY(needed <= old->mask + 1))
+            return;
+        usize n_slots = (old->mask + 1) << 1;
+        while (n_slots < needed)
+            n_slots <<= 1;
+        table* t = make_table(n_slots);
+        for (usize i = 0; i <= old->mask; ++i) {
+            const u64 slot = old->slots[i].load(std::memory_order_relaxed);
+            if (slot == 0)
+                continue;
+            const entry& e = entry_at(u32(slot) - 1);
+            usize j = usize(impl::hash_chars(e.data, e.size)) & t->mask;
+            while (t->slots[j].load(std::memory_order_relaxed) != 0)
+                j = (j + 1) & t->mask;
+            t->slots[j].store(slot, std::memory_order_relaxed);
+        }
+        m_table.store(t, std::memory_order_release);
+    }
+
+    // Copies s into the arena and publishes its entry before the slot that leads readers to it
+    Id insert(string_view s, u64 hash) noexcept {
+        const usize id = m_size.load(std::memory_order_relaxed);
+        assertf(id < MAX_IDS, "string_pool is full, {} strings were interned", id);
+        const usize segment = segment_of(id);
+        entry* entries = m_segments[segment].load(std::memory_order_relaxed);
+        if (entries == nullptr) {
+            const usize n = usize(1) << (segment + FIRST_SEGMENT_LOG2);
+            entries = static_cast<entry*>(m_arena.allocate(n * sizeof(entry), alignof(entry)));
+            m_segments[segment].store(entries, std::memory_order_release);
+        }
+        char* chars = static_cast<char*>(m_arena.allocate(s.size() + (s.size() == 0), 1));
+        memcpy(chars, s.data(), s.size());
+        mem::construct_at(entries + offset_in_segment(id, segment), entry{chars, s.size()});
+        m_size.store(id + 1, std::memory_order_release);
+
+        const table* t = m_table.load(std::memory_order_relaxed);
+        usize i = usize(hash) & t->mask;
+        while (t->slots[i].load(std::memory_order_relaxed) != 0)
+            i = (i + 1) & t->mask;
+        t->slots[i].store(((hash >> 32) << 32) | u64(id + 1), std::memory_order_release);
+        return Id{value_type(id)};
+    }
+
+    std::atomic<table*> m_table{};
+    std::atomic<usize>  m_size{};
+    std::atomic<entry*> m_segments[MAX_SEGMENTS]{};
+    std::mutex          m_lock{};
+    mem_buffer          m_arena;
+};
+
+}
+
+#endif // ZEN_STRING_POOL_H
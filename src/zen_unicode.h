@@ -47,6 +47,36 @@ constexpr char32_t next(const char* text, usize& cursor)
 }
 
 
+// Length of the well formed sequence at text, 0 for a stray continuation byte, a truncated sequence,
+// an overlong encoding, a surrogate or a code point above U+10FFFF
+constexpr usize valid_length(const char* text, usize size)
+{
+    const u32 c = u32(u8(text[0]));
+    if(ZEN_LIKELY(c < 128))
+        return 1;
+    // Second byte range depends on the lead byte, it rules out overlongs, surrogates and values above U+10FFFF
+    usize n = 0;
+    u32 lo = 0x80, hi = 0xbf;
+    if(c >= 0xc2 && c <= 0xdf)      { n = 2; }
+    else if(c == 0xe0)              { n = 3; lo = 0xa0; }
+    else if(c == 0xed)              { n = 3; hi = 0x9f; }
+    else if(c >= 0xe1 && c <= 0xef) { n = 3; }
+    else if(c == 0xf0)              { n = 4; lo = 0x90; }
+    else if(c >= 0xf1 && c <= 0xf3) { n = 4; }
+    else if(c == 0xf4)              { n = 4; hi = 0x8f; }
+    if(n == 0 || size < n)
+        return 0;
+    const u32 second = u32(u8(text[1]));
+    if(second < lo || second > hi)
+        return 0;
+    for(usize i = 2; i < n; ++i) {
+        if((u8(text[i]) & 0xc0) != 0x80)
+            return 0;
+    }
+    return n;
+}
+
+
 // C++ style iterator for unicode code points
 struct iterator {
     constexpr iterator() = default;
@@ -86,4 +116,4 @@ struct iter {
 
 }
 
-#endif ZEN_UNICODE_H
+#endif // ZEN_UNICODE_H
@@ -2,11 +2,12 @@
 
 #include "zen_fmt.h"
 #include <vector>
+#include <cmath>
 
-#define TEST_FORMAT_BASIC(expected, f, value) { \
+#define TEST_FORMAT_BASIC(expected, f, ...) { \
         zen::fmt::buffer<> out{}; \
         std::string_view ex{expected}; \
-        zen::format(out, f, value); \
+        zen::format(out, f, __VA_ARGS__); \
         REQUIRE( ex.size() == out.size() ); \
         REQUIRE( memcmp(out.data(), ex.data(), ex.size()) == 0 ); \
     }
@@ -22,6 +23,24 @@ TEST_CASE("fmt integer", "[utility]")
     TEST_FORMAT_BASIC("-123456789012"       , "{}"      , -123456789012);
     TEST_FORMAT_BASIC("18446744073709551615", "{}"      , UINT64_C(18446744073709551615));
     TEST_FORMAT_BASIC("0xcafebabe"          , "{}"      , (const void*)(ptr + 0xcafebabe));
+    TEST_FORMAT_BASIC("-9223372036854775808", "{}"      , INT64_MIN);
+    TEST_FORMAT_BASIC("-128 -32768"         , "{} {}"   , i8(-128), i16(-32768));
+    TEST_FORMAT_BASIC("0b0 0o0 0x0"         , "{b:} {o:} {x:}", 0, 0, 0);
+    TEST_FORMAT_BASIC("0x-8000000000000000" , "{x:}"    , INT64_MIN);
+#ifdef ZEN_INT128
+    TEST_FORMAT_BASIC("340282366920938463463374607431768211455" , "{}" , ~u128(0));
+    TEST_FORMAT_BASIC("-170141183460469231731687303715884105728", "{}" , i128(u128(1) << 127));
+    TEST_FORMAT_BASIC("10000000000000000000000000000000000000"  , "{}" , u128(UINT64_C(10000000000000000000)) * UINT64_C(1000000000000000000));
+    TEST_FORMAT_BASIC("0xffffffffffffffffffffffffffffffff"      , "{x:}" , ~u128(0));
+#endif
+
+    // Usable in constant expressions
+    constexpr auto chars = []{ 
+        struct { char data[24]; usize size; } r{};
+        r.size = usize(zen::fmt::int_to_chars(r.data, r.data + 24, INT64_MIN + 1) - r.data);
+        return r; 
+    }();
+    STATIC_REQUIRE( std::string_view{chars.data, chars.size} == "-9223372036854775807" );
 }
 
 TEST_CASE("fmt float", "[utility]") 
@@ -30,6 +49,17 @@ TEST_CASE("fmt float", "[utility]")
     TEST_FORMAT_BASIC("2.1"                 , "{}"      , 2.1);
     TEST_FORMAT_BASIC("2.100"               , "{:.3}"   , 2.1f);
     TEST_FORMAT_BASIC("2.100"               , "{:.3}"   , 2.1);
+    TEST_FORMAT_BASIC("0.30000000000000004" , "{}"      , 0.1 + 0.2);
+    TEST_FORMAT_BASIC("0.3"                 , "{}"      , 0.1f + 0.2f);
+    TEST_FORMAT_BASIC("1e+20"               , "{}"      , 1e20);
+    TEST_FORMAT_BASIC("-1.5e-07"            , "{}"      , -1.5e-7);
+    TEST_FORMAT_BASIC("123456789"           , "{}"      , 123456789.0);
+    TEST_FORMAT_BASIC("5e-324"              , "{}"      , 4.9406564584124654e-324);
+    TEST_FORMAT_BASIC("inf"                 , "{}"      , 1e308 * 10.0);
+    TEST_FORMAT_BASIC("0.12"                , "{:.2}"   , 0.125);
+    TEST_FORMAT_BASIC("0.38"                , "{:.2}"   , 0.375);
+    TEST_FORMAT_BASIC("1.000"               , "{:.3}"   , 0.9999);
+    TEST_FORMAT_BASIC("0.1000000000000000055511151231257827" , "{:.34}" , 0.1);
 }
 
 TEST_CASE("fmt string", "[utility]") 
@@ -51,6 +81,10 @@ TEST_CASE("fmt spec - align", "[utility]")
     TEST_FORMAT_BASIC("abc  "               , "{:<5}"   , "abc");
     TEST_FORMAT_BASIC("  abc"               , "{:>5}"   , "abc");
     TEST_FORMAT_BASIC(" abc "               , "{:^5}"   , "abc");
+    TEST_FORMAT_BASIC("  abc "              , "{:^6}"   , "abc");
+    TEST_FORMAT_BASIC("abcdef"              , "{:>3}"   , "abcdef");
+    TEST_FORMAT_BASIC("[0x     ff]"         , "[{x:>7}]", 255);
+    TEST_FORMAT_BASIC("[  1.50  ]"          , "[{:^8.2}]", 1.5);
 }
 
 TEST_CASE("fmt spec - fill", "[utility]") 
@@ -59,3 +93,647 @@ TEST_CASE("fmt spec - fill", "[utility]")
     TEST_FORMAT_BASIC("00abc"               , "{:0>5}"   , "abc");
     TEST_FORMAT_BASIC("0abc0"               , "{:0^5}"   , "abc");
 }
+
+TEST_CASE("fmt literal", "[utility]") 
+{
+    TEST_FORMAT_BASIC("a{b}c"               , "a{{b}}{}", "c");
+    TEST_FORMAT_BASIC("{1}"                 , "{{{}}}"  , 1);
+    TEST_FORMAT_BASIC("x=1, y=2"            , "x={}, y={}", 1, 2);
+}
+
+TEST_CASE("fmt argument references", "[utility]") 
+{
+    using zen::fmt::named;
+    TEST_FORMAT_BASIC("2 1"                 , "{1} {0}"             , 1, 2);
+    TEST_FORMAT_BASIC("aaa"                 , "{0}{0}{0}"           , 'a');
+    TEST_FORMAT_BASIC("0xff 255 0o377"      , "{0x:} {0} {0o:}"     , 255);
+    TEST_FORMAT_BASIC("**ab**|6"            , "{0:*^{1}}|{1}"       , "ab", 6);
+    TEST_FORMAT_BASIC("   ab|3.14"          , "{:>{}}|{:.{}}"       , "ab", 5, 3.14159, 2);
+    TEST_FORMAT_BASIC("  1.500"             , "{:>{}.{}}"           , 1.5, 7, 3);
+    TEST_FORMAT_BASIC("ab"                  , "{:>{}}"              , "ab", -3);
+    TEST_FORMAT_BASIC("1:      v"           , "{id}: {value:>{width}}", named<"id">(1), named<"value">("v"), named<"width">(6));
+    TEST_FORMAT_BASIC("0xff 255"            , "{nx:} {1}"           , named<"n">(255), named<"m">(255));
+    TEST_FORMAT_BASIC("x=1 x=1"             , "x={x} x={x}"         , named<"x">(1));
+
+    REQUIRE( zen::fmt::formatted_size("{0}{0}{0}", 123) == 3 * 3 );
+    REQUIRE( zen::fmt::formatted_size("{0}{0}{0}{0}|{1:>{2}}", 123, "ab", 5) == 4 * 3 + 1 + 5 );
+    REQUIRE( zen::fmt::formatted_size("{v:>{w}}", named<"v">(1.5), named<"w">(9)) == 9 );
+
+    // Runtime formats resolve the same references
+    zen::fmt::buffer<> out{};
+    zen::format(out, zen::fmt::runtime("{1} {0:>{2}} {n}"), "a", "b", 3, named<"n">(4));
+    REQUIRE( std::string_view{out} == "b   a 4" );
+    for (const char* bad : {"{} {0}", "{0} {}", "{9}", "{missing}", "{n:>{0}}", "{0:>{0}}", "{0}"}) {
+        zen::fmt::buffer<> invalid{};
+        zen::format(invalid, zen::fmt::runtime(bad), "a", named<"n">(2));
+        REQUIRE( std::string_view{invalid} == "InvalidFormat(" + std::string{bad} + ")" );
+    }
+}
+
+TEST_CASE("fmt static format", "[utility]")
+{
+    using zen::fmt::static_format;
+    static constexpr auto key = static_format<"metric.{}.{:>4}", "cpu", 3>();
+    STATIC_REQUIRE( key.max_size() == 15 && key.view() == "metric.cpu.   3" );
+    STATIC_REQUIRE( static_format<"">().empty() );
+    STATIC_REQUIRE( static_format<"{{{}}}", true>().view() == "{true}" );
+    STATIC_REQUIRE( static_format<"{1}-{0}", 'a', -12>().view() == "-12-a" );
+    STATIC_REQUIRE( static_format<"{:*^{}}|{}", "ab", 6, u64(UINT64_MAX)>().view() == "**ab**|18446744073709551615" );
+
+    // Same output as zen::format
+    zen::fmt::buffer<> out{};
+    zen::format(out, "{x:>6} {X:} {b:} {o:<5}| {x:} {:^3}", 255, 255, i8(-5), 8, -255, 'c');
+    REQUIRE( key.view() == "metric.cpu.   3" );
+    REQUIRE( static_format<"{x:>6} {X:} {b:} {o:<5}| {x:} {:^3}", 255, 255, i8(-5), 8, -255, 'c'>().view() == std::string_view{out} );
+}
+
+TEST_CASE("fmt runtime format", "[utility]") 
+{
+    zen::fmt::buffer<> out{};
+    zen::format(out, zen::fmt::runtime("{} + {:>3}"), 1, 2);
+    REQUIRE( std::string_view{out} == "1 +   2" );
+
+    zen::fmt::buffer<> bad{};
+    zen::format(bad, zen::fmt::runtime("{} {}"), 1);
+    REQUIRE( std::string_view{bad} == "InvalidFormat({} {})" );
+}
+
+TEST_CASE("fmt vformat", "[utility]") 
+{
+    // Every argument category through the type-erased engine
+    zen::fmt::buffer<> out{};
+    const std::vector<int> list{1, 2};
+    const auto args = zen::fmt::make_args(true, 'c', i8(-5), u16(7), INT64_MIN, 1.5f, 0.25, "str", list, (const void*)nullptr);
+    zen::fmt::vformat(out, zen::fmt::runtime("{} {} {x:} {b:>5} {} {} {:.1} {:>4} {} {}"), args);
+    REQUIRE( std::string_view{out} == "true c 0x-5 0b  111 -9223372036854775808 1.5 0.2  str {1, 2} 0x0" );
+
+    // A sink_ref refers to the sink, it is not a copy
+    zen::fmt::dynamic_buffer<> dyn{};
+    zen::fmt::sink_ref ref{dyn};
+    zen::format(ref, "{}-{}", 1, "a");
+    REQUIRE( dyn.view() == "1-a" );
+    REQUIRE( (ref.size() == 3 && ref.data() == dyn.data() && !ref.counting()) );
+
+    zen::fmt::counting_sink counter{};
+    zen::fmt::sink_ref counted{counter};
+    zen::format(counted, "{:>8}|{x:}", 123456789, 255u);
+    REQUIRE( (counted.counting() && counter.size() == 9 + 1 + 4) );
+
+    // Too many arguments for the runtime parser
+    zen::fmt::buffer<> many{};
+    int values[zen::fmt::MAX_RUNTIME_ARGS + 1]{};
+    zen::fmt::arg erased[zen::fmt::MAX_RUNTIME_ARGS + 1]{};
+    for (usize i = 0; i < zen::fmt::MAX_RUNTIME_ARGS + 1; ++i) erased[i] = zen::fmt::impl::make_arg(values[i]);
+    zen::fmt::vformat(many, zen::fmt::runtime("{}"), erased);
+    REQUIRE( std::string_view{many} == "InvalidFormat({})" );
+}
+
+template<typename T, usize Base = 10>
+static zen::fmt::parse_result parse_int(std::string_view s, T& value)
+{
+    return zen::fmt::chars_to_int<Base>(s.data(), s.data() + s.size(), value);
+}
+
+TEST_CASE("fmt chars_to_int", "[utility]") 
+{
+    using zen::fmt::parse_error;
+    u64 u{};
+    i32 i{};
+    u8 b{};
+
+    REQUIRE( parse_int("1234567890123456789", u) );
+    REQUIRE( u == UINT64_C(1234567890123456789) );
+    REQUIRE( parse_int("18446744073709551615", u) );
+    REQUIRE( u == UINT64_MAX );
+    REQUIRE( parse_int("000000000000000000000000000042", u) );
+    REQUIRE( u == 42 );
+    REQUIRE( parse_int("-2147483648", i) );
+    REQUIRE( i == INT32_MIN );
+    REQUIRE( parse_int("+2147483647", i) );
+    REQUIRE( i == INT32_MAX );
+    REQUIRE( parse_int("255", b) );
+    REQUIRE( b == 255 );
+
+    // Stops at the first non-digit
+    const std::string_view partial{"12345678901234567890123x"};
+    auto r = parse_int("12345678abc", u);
+    REQUIRE( (r && u == 12345678 && r.ptr[0] == 'a') );
+    r = parse_int(partial, u);
+    REQUIRE( (r.error == parse_error::overflow && *r.ptr == 'x') );
+
+    // Overflow leaves the value untouched
+    u = 7;
+    REQUIRE( parse_int("18446744073709551616", u).error == parse_error::overflow );
+    REQUIRE( parse_int("99999999999999999999", u).error == parse_error::overflow );
+    REQUIRE( u == 7 );
+    REQUIRE( parse_int("2147483648", i).error == parse_error::overflow );
+    REQUIRE( parse_int("-2147483649", i).error == parse_error::overflow );
+    REQUIRE( parse_int("256", b).error == parse_error::overflow );
+
+    // Invalid input points at the start
+    const std::string_view bad[]{"", "-", "+", "x1", " 1", "-1"};
+    for (auto s: bad) {
+        r = parse_int(s, u);
+        REQUIRE( (r.error == parse_error::invalid && r.ptr == s.data()) );
+    }
+    REQUIRE( u == 7 );
+
+    // Other bases
+    REQUIRE( parse_int<u64, 16>("cafeBABE", u) );
+    REQUIRE( u == 0xcafebabe );
+    REQUIRE( parse_int<u64, 2>("1012", u) );
+    REQUIRE( u == 5 );
+    REQUIRE( parse_int<i32, 8>("-777", i) );
+    REQUIRE( i == -0777 );
+    REQUIRE( parse_int<u8, 16>("100", b).error == parse_error::overflow );
+
+    // Usable in constant expressions
+    constexpr auto parsed = []{ i64 v{}; zen::fmt::chars_to_int("-9000", "-9000" + 5, v); return v; }();
+    STATIC_REQUIRE( parsed == -9000 );
+}
+
+template<typename T>
+static zen::fmt::parse_result parse_float(std::string_view s, T& value)
+{
+    return zen::fmt::chars_to_float(s.data(), s.data() + s.size(), value);
+}
+
+TEST_CASE("fmt chars_to_float", "[utility]") 
+{
+    using zen::fmt::parse_error;
+    f64 d{};
+    f32 f{};
+
+    REQUIRE( (parse_float("0.1", d) && d == 0.1) );
+    REQUIRE( (parse_float("-2.5e-3", d) && d == -2.5e-3) );
+    REQUIRE( (parse_float("+.5", d) && d == 0.5) );
+    REQUIRE( (parse_float("5.", d) && d == 5.0) );
+    REQUIRE( (parse_float("1e22", d) && d == 1e22) );
+    REQUIRE( (parse_float("1e23", d) && d == 1e23) );
+    REQUIRE( (parse_float("3.4028234663852886e38", f) && f == 3.4028234663852886e38f) );
+    REQUIRE( (parse_float("1.17549435e-38", f) && f == 1.17549435e-38f) );
+    REQUIRE( (parse_float("-0", d) && d == 0.0 && std::signbit(d)) );
+    REQUIRE( (parse_float("4.9406564584124654e-324", d) && d == 4.9406564584124654e-324) );
+    REQUIRE( (parse_float("1.7976931348623158e308", d) && d == 1.7976931348623157e308) );
+
+    // Ties round to even, digits past the 19th can break them
+    REQUIRE( (parse_float("9007199254740993", d) && d == 9007199254740992.0) );
+    REQUIRE( (parse_float("9007199254740993.00000000000000000000001", d) && d == 9007199254740994.0) );
+    REQUIRE( (parse_float("9007199254740994.99999999999999999999999", d) && d == 9007199254740994.0) );
+    REQUIRE( (parse_float("0.000000000000000000000000000000000000000000000000000000000000000000000"
+                          "00000000000000000000000000000000000000000000000000000000000000000000000"
+                          "1234567890123456789012345678901234567890e10", d) && d == 1.2345678901234567e-131) );
+
+    // Round trips through float_to_chars
+    const f64 values[]{ 0.30000000000000004, 6.02214076e23, 2.2250738585072014e-308, 123456.789, 5e-324 };
+    for (auto v: values) {
+        char buf[32];
+        char* last = zen::fmt::float_to_chars(buf, buf + sizeof(buf), v);
+        REQUIRE( (parse_float(std::string_view{buf, usize(last - buf)}, d) && d == v) );
+    }
+
+    // Special values
+    REQUIRE( (parse_float("inf", d) && std::isinf(d) && d > 0) );
+    REQUIRE( (parse_float("-Infinity", d) && std::isinf(d) && d < 0) );
+    REQUIRE( (parse_float("nan(123)", f) && std::isnan(f)) );
+
+    // Stops at the first char that is not part of the number
+    auto r = parse_float("1.5x", d);
+    REQUIRE( (r && d == 1.5 && *r.ptr == 'x') );
+    r = parse_float("2e+", d);
+    REQUIRE( (r && d == 2.0 && *r.ptr == 'e') );
+    r = parse_float("infinit", d);
+    REQUIRE( (r && *r.ptr == 'i') );
+
+    // Out of range and invalid input leave the value untouched
+    d = 7.0;
+    REQUIRE( parse_float("1e309", d).error == parse_error::overflow );
+    REQUIRE( parse_float("1.7976931348623159e308", d).error == parse_error::overflow );
+    REQUIRE( parse_float("2.4703282292062327e-324", d).error == parse_error::overflow );
+    REQUIRE( parse_float("1e39", f).error == parse_error::overflow );
+    const std::string_view bad[]{"", "-", ".", "e5", "-.e1", "x"};
+    for (auto s: bad) {
+        r = parse_float(s, d);
+        REQUIRE( (r.error == parse_error::invalid && r.ptr == s.data()) );
+    }
+    REQUIRE( d == 7.0 );
+}
+
+TEST_CASE("fmt dynamic_buffer", "[utility]") 
+{
+    // Counts the bytes that spill out of the inline storage
+    struct counting_resource : zen::mem_resource {
+        usize allocated{}, live{};
+        void* do_allocate(usize n, usize align) override { allocated += n; live += n; return std::pmr::new_delete_resource()->allocate(n, align); }
+        void  do_deallocate(void* p, usize n, usize align) override { live -= n; std::pmr::new_delete_resource()->deallocate(p, n, align); }
+        bool  do_is_equal(const zen::mem_resource& o) const noexcept override { return this == &o; }
+    } resource{};
+
+    {
+        zen::fmt::dynamic_buffer<16> out{&resource};
+        zen::format(out, "{}-{}", 12345678, "abc");
+        REQUIRE( out.small() );
+        REQUIRE( out.view() == "12345678-abc" );
+        REQUIRE( resource.allocated == 0 );
+
+        const std::string long_str(1000, 'x');
+        zen::format(out, "{}{:.3}", long_str, 1e300);
+        REQUIRE( !out.small() );
+        REQUIRE( out.size() == 12 + 1000 + 301 + 4 );
+        REQUIRE( out.view().substr(0, 13) == "12345678-abcx" );
+        REQUIRE( out.view().substr(out.size() - 5) == "0.000" );
+        REQUIRE( resource.live == out.capacity() );
+
+        zen::fmt::dynamic_buffer<16> moved{std::move(out)};
+        REQUIRE( out.empty() );
+        REQUIRE( moved.size() == 1317 );
+        REQUIRE( resource.live == moved.capacity() );
+    }
+    REQUIRE( resource.live == 0 );
+}
+
+TEST_CASE("fmt truncating buffer", "[utility]") 
+{
+    zen::fmt::truncating_buffer<8> out{};
+    zen::format(out, "{}", 1234);
+    REQUIRE( (out.view() == "1234" && !out.truncated()) );
+    zen::format(out, "{}", 567890);
+    REQUIRE( (out.view() == "12345678" && out.truncated()) );
+    zen::format(out, "{} {:.2}", "more", 3.14159);
+    REQUIRE( out.view() == "12345678" );
+
+    out.clear();
+    zen::format(out, "ab{:.3}", -1.5);
+    REQUIRE( (out.view() == "ab-1.500" && !out.truncated()) );
+    out.clear();
+    zen::format(out, "abc{:.3}", -1.5);
+    REQUIRE( (out.view() == "abc-1.50" && out.truncated()) );
+}
+
+// Smallest sink: a fixed array that reports how many chars were offered
+struct array_sink : zen::fmt::sink_ops<array_sink> {
+    using zen::fmt::sink_ops<array_sink>::operator<<;
+    char  chars[4096]{};
+    usize n{};
+
+    char*       data()                              noexcept { return chars; }
+    usize       size()                        const noexcept { return n; }
+    void        append(char c)                      noexcept { chars[n++] = c; }
+    void        append(const char* s, usize count)  noexcept { memcpy(chars + n, s, count); n += count; }
+    void        append_n(char c, usize count)       noexcept { memset(chars + n, c, count); n += count; }
+    char*       reserve(usize)                      noexcept { return chars + n; }
+    void        commit(usize count)                 noexcept { n += count; }
+};
+
+TEST_CASE("fmt sink protocol", "[utility]") 
+{
+    STATIC_REQUIRE( zen::fmt::impl::is_sink<array_sink> );
+    STATIC_REQUIRE( zen::fmt::impl::is_sink<zen::fmt::buffer<>> );
+    STATIC_REQUIRE( zen::fmt::impl::is_sink<zen::fmt::dynamic_buffer<>> );
+
+    array_sink sink{};
+    zen::format(sink, "{} {:*^9} {{{}}}", -42, 3.5f, "x");
+    REQUIRE( std::string_view{sink.chars, sink.n} == "-42 ***3.5*** {x}" );
+
+    // Padding wider than the old fixed temporary
+    zen::fmt::dynamic_buffer<> out{};
+    const std::string wide(700, 'w');
+    zen::format(out, "{:>1000}", wide);
+    REQUIRE( out.size() == 1000 );
+    REQUIRE( out.view().find_first_not_of(' ') == 300 );
+
+    // Padding in front of a value that no longer fits
+    zen::fmt::truncating_buffer<8> small{};
+    zen::format(small, "ab{:>8}", 123);
+    REQUIRE( (small.view() == "ab     1" && small.truncated()) );
+    small.clear();
+    zen::format(small, "abc{:>5}", 123);
+    REQUIRE( (small.view() == "abc  123" && !small.truncated()) );
+}
+
+#ifdef ZEN_PLATFORM_LINUX
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <thread>
+
+static std::string read_pipe(int fd) {
+    std::string s(1 << 18, '\0');
+    const ssize_t n = read(fd, s.data(), s.size());
+    s.resize(n < 0 ? 0 : usize(n));
+    return s;
+}
+
+TEST_CASE("fmt fd_writer", "[utility]") 
+{
+    int fds[2]{};
+    REQUIRE( pipe(fds) == 0 );
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    fcntl(fds[1], F_SETPIPE_SZ, 1 << 18);
+
+    {
+        // Unbuffered by default, every message is written when it ends
+        zen::fmt::fd_writer w{fds[1]};
+        REQUIRE( (!w.terminal() && !w.buffered()) );
+        w.begin_message();
+        zen::format(w, "{} {:>4}", "line", 0);
+        REQUIRE( read_pipe(fds[0]).empty() );
+        w.end_message();
+        REQUIRE( read_pipe(fds[0]) == "line    0" );
+    }
+
+    {
+        zen::fmt::fd_writer w{fds[1], true};
+        REQUIRE( w.buffered() );
+
+        // Batched until flushed
+        w.begin_message();
+        zen::format(w, "{} {:>4}\n", "line", 1);
+        w.end_message();
+        w.write("line    2\n");
+        REQUIRE( read_pipe(fds[0]).empty() );
+        w.flush();
+        REQUIRE( read_pipe(fds[0]) == "line    1\nline    2\n" );
+
+        // Flushed once enough is buffered
+        const std::string line(1000, 'y');
+        usize written{};
+        while (written < zen::fmt::fd_writer::FLUSH_SIZE) {
+            w.write(line);
+            written += line.size();
+        }
+        REQUIRE( w.size() == 0 );
+        REQUIRE( read_pipe(fds[0]).size() == written );
+
+        // Ended messages of every writer are flushed, a message in progress on this thread stays buffered
+        zen::fmt::fd_writer other{fds[1], true};
+        other.write("other\n");
+        w.write("ended\n");
+        w.begin_message();
+        w << "in progress";
+        zen::fmt::fd_writer::flush_all();
+        const std::string flushed = read_pipe(fds[0]);
+        REQUIRE( (flushed == "other\nended\n" || flushed == "ended\nother\n") );
+        w.end_message();
+        REQUIRE( zen::string_view{w.data(), w.size()} == "in progress" );
+        w.flush();
+        REQUIRE( read_pipe(fds[0]) == "in progress" );
+
+        // Flushed on destruction
+        w.write("tail");
+    }
+    REQUIRE( read_pipe(fds[0]) == "tail" );
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+// Output print buffered on one thread is written when another thread panics, which never runs its destructors
+TEST_CASE("fmt panic flushes every thread", "[utility]") 
+{
+    FILE* out = tmpfile();
+    FILE* err = tmpfile();
+    const pid_t pid = fork();
+    REQUIRE( pid >= 0 );
+    if (pid == 0) {
+        dup2(fileno(out), 1);
+        dup2(fileno(err), 2);
+        zen::fmt::fd_writer::print_buffered(true);
+        zen::println("main: started");
+        std::thread{[] { zen::panic("worker: {}", "failed"); }}.join();
+        _exit(0);
+    }
+    int status{};
+    REQUIRE( waitpid(pid, &status, 0) == pid );
+    REQUIRE( (WIFEXITED(status) && WEXITSTATUS(status) == 1) );
+    auto read_file = [](FILE* f) {
+        std::string s(4096, '\0');
+        const ssize_t n = pread(fileno(f), s.data(), s.size(), 0);
+        s.resize(n < 0 ? 0 : usize(n));
+        return s;
+    };
+    REQUIRE( read_file(out) == "main: started\n" );
+    REQUIRE( read_file(err) == "worker: failed\n" );
+    fclose(out);
+    fclose(err);
+}
+
+// Writes its text as one string, which a gather_sink keeps by reference when it is long enough
+struct gather_text { std::string_view text; };
+
+template<typename Out>
+Out& operator<<(Out& out, const gather_text& v) noexcept {
+    out.append(v.text.data(), v.text.size());
+    return out;
+}
+
+TEST_CASE("fmt gather_sink", "[utility]") 
+{
+    SECTION("padded custom type") {
+        const gather_text wide{"0123456789AB"};
+        const gather_text narrow{"0123456789"};
+        zen::fmt::gather_sink<> out{8};
+        zen::format(out, "[{:>4}] [{:*>14}] [{:-^13}] [{:<12}]", wide, narrow, narrow, narrow);
+        std::vector<zen::string_view> chunks(out.max_chunks());
+        chunks.resize(out.chunks(chunks.data()));
+        std::string joined;
+        for (auto c : chunks) joined.append(c.data(), c.size());
+        REQUIRE( joined == "[0123456789AB] [****0123456789] [--0123456789-] [0123456789  ]" );
+        REQUIRE( out.total_size() == joined.size() );
+    }
+
+
+    const std::string body(300, 'b');
+    const std::string short_body(10, 's');
+    zen::fmt::gather_sink<> out{};
+    zen::format(out, "len={} [{:>4}] {} {}|{:*>302}|{}", body.size(), 7, short_body, body, body, 1.5);
+
+    // Long strings are referenced, padding and the rest are copied
+    zen::fmt::dynamic_buffer<> expected{};
+    zen::format(expected, "len={} [{:>4}] {} {}|{:*>302}|{}", body.size(), 7, short_body, body, body, 1.5);
+    REQUIRE( out.ref_count() == 2 );
+    REQUIRE( out.total_size() == expected.size() );
+    REQUIRE( out.size() == expected.size() - 2 * body.size() );
+
+    std::vector<zen::string_view> chunks(out.max_chunks());
+    chunks.resize(out.chunks(chunks.data()));
+    REQUIRE( chunks.size() == 5 );
+    REQUIRE( chunks[1].data() == body.data() );
+    REQUIRE( chunks[3].data() == body.data() );
+    std::string joined;
+    for (auto c : chunks) joined.append(c.data(), c.size());
+    REQUIRE( joined == expected.view() );
+
+    std::vector<iovec> iov(out.max_chunks());
+    REQUIRE( out.iovecs(iov.data()) == chunks.size() );
+    REQUIRE( iov[1].iov_base == body.data() );
+
+    // More references than fit inline, and more chunks than one writev takes
+    out.clear();
+    REQUIRE( out.total_size() == 0 );
+    std::string all;
+    for (int i = 0; i < 40; ++i) {
+        zen::format(out, "{}:{}", i, body);
+        all += std::to_string(i) + ":" + body;
+    }
+    REQUIRE( out.ref_count() == 40 );
+
+    int fds[2]{};
+    REQUIRE( pipe(fds) == 0 );
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    fcntl(fds[1], F_SETPIPE_SZ, 1 << 18);
+    out.write(fds[1]);
+    REQUIRE( read_pipe(fds[0]) == all );
+    close(fds[0]);
+    close(fds[1]);
+}
+#endif
+
+#define TEST_FORMATTED_SIZE(f, ...) { \
+        zen::fmt::dynamic_buffer<> out{}; \
+        zen::format(out, f, __VA_ARGS__); \
+        REQUIRE( zen::fmt::formatted_size(f, __VA_ARGS__) == out.size() ); \
+    }
+
+TEST_CASE("fmt formatted_size", "[utility]") 
+{
+    REQUIRE( zen::fmt::formatted_size("") == 0 );
+    REQUIRE( zen::fmt::formatted_size("{{}}") == 2 );
+    REQUIRE( zen::fmt::formatted_size("{}", 0) == 1 );
+    TEST_FORMATTED_SIZE("{} {} {}", "abc", std::string_view{"de"}, 'f');
+    TEST_FORMATTED_SIZE("{} {} {}", true, false, (const void*)0x1234);
+    TEST_FORMATTED_SIZE("{:.3} {} {} {:.20}", 3.14159, 1e300, -2.5f, 1e-10);
+    TEST_FORMATTED_SIZE("{:*^20} {:>3} {:<9.2}", "centered", 12345, 1.0);
+    TEST_FORMATTED_SIZE("{b:} {o:} {x:} {X:}", 0, 0, 0u, i64(0));
+    TEST_FORMATTED_SIZE("{}", std::vector<int>{1, -22, 333});
+    TEST_FORMATTED_SIZE("{{{}}} }}{x:>8} {b:} {:^5}", 'c', 255, 'a', 'z');
+
+    // Every digit count boundary and sign in each base
+    for (u64 p = 1; p != 0; p = p <= UINT64_MAX / 10 ? p * 10 : 0) {
+        for (u64 v : {p - 1, p, p + 1}) {
+            TEST_FORMATTED_SIZE("{} {}", v, -i64(v >> 1));
+            TEST_FORMATTED_SIZE("{b:} {o:} {x:} {X:}", v, v, v, i64(v));
+        }
+    }
+    for (usize shift = 0; shift < 64; ++shift) {
+        const u64 v = u64(1) << shift;
+        TEST_FORMATTED_SIZE("{} {b:} {o:} {x:}", v - 1, v, v - 1, v);
+    }
+    TEST_FORMATTED_SIZE("{} {}", UINT64_MAX, INT64_MAX);
+
+    // Sized exactly before formatting
+    const auto n = zen::fmt::formatted_size("{} = {:.2}", "pi", 3.14159);
+    zen::fmt::truncating_buffer<9> out{};
+    zen::format(out, "{} = {:.2}", "pi", 3.14159);
+    REQUIRE( (n == 9 && !out.truncated()) );
+}
+
+TEST_CASE("fmt byte encoding", "[utility]") 
+{
+    u8 bytes[40]{};
+    for (usize i = 0; i < 40; ++i) bytes[i] = u8(i * 37 + 5);
+    std::string hex_ref, upper_ref, binary_ref;
+    for (u8 b : bytes) {
+        char t[4];
+        snprintf(t, sizeof(t), "%02x", b); hex_ref += t;
+        snprintf(t, sizeof(t), "%02X", b); upper_ref += t;
+        for (int k = 7; k >= 0; --k) binary_ref += char('0' + ((b >> k) & 1));
+    }
+
+    // Every length, so the vector and scalar tails are all covered
+    for (usize n = 0; n <= 40; ++n) {
+        const zen::span<const u8> s{bytes, n};
+        char out[320];
+        REQUIRE( std::string_view(out, usize(zen::fmt::hex_encode(out, s) - out)) == std::string_view(hex_ref).substr(0, n * 2) );
+        REQUIRE( std::string_view(out, usize(zen::fmt::hex_encode(out, s, true) - out)) == std::string_view(upper_ref).substr(0, n * 2) );
+        REQUIRE( std::string_view(out, usize(zen::fmt::binary_encode(out, s) - out)) == std::string_view(binary_ref).substr(0, n * 8) );
+    }
+
+    const zen::span<const u8> all{bytes};
+    TEST_FORMAT_BASIC(hex_ref       , "{}", zen::fmt::hex{all});
+    TEST_FORMAT_BASIC(upper_ref     , "{}", zen::fmt::hexu{all});
+    TEST_FORMAT_BASIC(binary_ref    , "{}", zen::fmt::binary{all});
+
+    // Whole word integer conversions
+    TEST_FORMAT_BASIC("0xdeadbeef 0xDEADBEEF 0x1", "{x:} {X:} {x:}", 0xdeadbeefu, 0xdeadbeefu, 1);
+    TEST_FORMAT_BASIC("0x123456789abcdef0"      , "{x:}", UINT64_C(0x123456789abcdef0));
+    TEST_FORMAT_BASIC("0b101 0b1111111111111111", "{b:} {b:}", 5, u16(0xffff));
+    TEST_FORMAT_BASIC("0x1 0b1"                 , "{x:} {b:}", u8(1), u8(1));
+}
+
+TEST_CASE("fmt hexdump", "[utility]") 
+{
+    const char text[] = "Hello, hexdump!\n\x01\x02\xff world";
+    const zen::span<const u8> bytes{reinterpret_cast<const u8*>(text), sizeof(text) - 1};
+    TEST_FORMAT_BASIC(
+        "00000000  48 65 6c 6c 6f 2c 20 68  65 78 64 75 6d 70 21 0a  |Hello, hexdump!.|\n"
+        "00000010  01 02 ff 20 77 6f 72 6c  64                       |... world|\n", 
+        "{}", zen::fmt::hexdump{bytes});
+    TEST_FORMAT_BASIC(
+        "00000000fffffffc  48 65 6c 6c 6f 2c 20 68                           |Hello, h|\n", 
+        "{}", (zen::fmt::hexdump{zen::span<const u8>{bytes.data(), 8}, UINT32_MAX - 3}));
+    TEST_FORMAT_BASIC("", "{}", zen::fmt::hexdump{});
+}
+
+TEST_CASE("fmt escaped strings", "[utility]") 
+{
+    using zen::fmt::named;
+    TEST_FORMAT_BASIC(R"("abc")"                    , "{?:}"        , "abc");
+    TEST_FORMAT_BASIC(R"("")"                       , "{?:}"        , "");
+    TEST_FORMAT_BASIC(R"("q\" b\\ \n\r\t")"         , "{?:}"        , "q\" b\\ \n\r\t");
+    TEST_FORMAT_BASIC(R"("\x00\x1b\x7f")"           , "{?:}"        , std::string_view{"\0\x1b\x7f", 3});
+    TEST_FORMAT_BASIC("\"caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80\"", "{?:}", "caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80");
+    TEST_FORMAT_BASIC(R"("\xff\xc3 \xc0\xaf \xed\xa0\x80 \xf4\x90\x80\x80")", "{?:}", "\xff\xc3 \xc0\xaf \xed\xa0\x80 \xf4\x90\x80\x80");
+    TEST_FORMAT_BASIC(R"(  "a\n"|"b"--)"            , "{?:>7}|{?:-<5}", std::string{"a\n"}, "b");
+    TEST_FORMAT_BASIC(R"(x="v\t")"                  , "{0}={1?:}"   , 'x', "v\t");
+    TEST_FORMAT_BASIC(R"("n\"")"                    , "{s?:}"       , named<"s">("n\""));
+    TEST_FORMAT_BASIC(R"("ab")"                     , "{}"          , zen::fmt::escaped{"ab"});
+
+    zen::fmt::buffer<> bad{};
+    zen::format(bad, zen::fmt::runtime("{?:}"), 1);
+    REQUIRE( bad.view() == "InvalidFormat({?:})" );
+
+    // Escapes at every offset of a chunk, a sequence split by the chunk end and past the last whole vector
+    for (usize at = 0; at < 140; ++at) {
+        std::string s(140, 'x');
+        s[at] = at % 3 == 0 ? '"' : at % 3 == 1 ? '\x01' : '\xff';
+        s.replace(139 - at / 2, 2, "\xc3\xa9");
+        s.resize(140);
+        std::string expected = "\"";
+        for (usize i = 0; i < s.size(); ++i) {
+            if (s[i] == '"')                                                    expected += "\\\"";
+            else if (s[i] == '\x01')                                            expected += "\\x01";
+            else if (s[i] == '\xc3' && i + 1 < s.size() && s[i + 1] == '\xa9')  expected += s.substr(i++, 2);
+            else if (u8(s[i]) >= 0x80)                                          expected += "\\x" + std::string{"0123456789abcdef"[u8(s[i]) >> 4]} + "0123456789abcdef"[u8(s[i]) & 15];
+            else                                                                expected += s[i];
+        }
+        expected += '"';
+
+        zen::fmt::dynamic_buffer<> out{};
+        zen::format(out, "{?:}", s);
+        REQUIRE( out.view() == expected );
+        REQUIRE( zen::fmt::formatted_size("{?:}", s) == expected.size() );
+    }
+}
+
+TEST_CASE("fmt timestamp", "[utility]") 
+{
+    using zen::fmt::timestamp;
+    using zen::fmt::time_precision;
+    TEST_FORMAT_BASIC("1970-01-01T00:00:00.000Z"        , "{}", timestamp{0});
+    TEST_FORMAT_BASIC("2026-10-16T20:20:43Z"            , "{}", (timestamp{1792182043123456789, time_precision::seconds}));
+    TEST_FORMAT_BASIC("2026-10-16T20:20:43.123Z"        , "{}", timestamp{1792182043123456789});
+    TEST_FORMAT_BASIC("2026-10-16T20:20:43.123456Z"     , "{}", (timestamp{1792182043123456789, time_precision::microseconds}));
+    TEST_FORMAT_BASIC("2026-10-16T20:20:43.123456789Z"  , "{}", (timestamp{1792182043123456789, time_precision::nanoseconds}));
+    TEST_FORMAT_BASIC("1969-12-31T23:59:59.999999999Z"  , "{}", (timestamp{-1, time_precision::nanoseconds}));
+    TEST_FORMAT_BASIC("2024-02-29T23:59:59.000500Z"     , "{}", (timestamp{1709251199000500000, time_precision::microseconds}));
+    TEST_FORMAT_BASIC("2000-02-29T00:00:00.000Z"        , "{}", timestamp{951782400000000000});
+    TEST_FORMAT_BASIC("[  1970-01-01T00:00:00.000Z]"    , "[{:>26}]", timestamp{0});
+
+    // The cached second is only reused within that second
+    TEST_FORMAT_BASIC("1970-01-01T00:00:01.001Z 1970-01-01T00:00:01.999Z 1970-01-01T00:00:02.000Z 1970-01-01T00:00:01.500Z", 
+        "{} {} {} {}", timestamp{1001000000}, timestamp{1999999999}, timestamp{2000000000}, timestamp{1500000000});
+
+    const auto now = timestamp::now();
+    REQUIRE( zen::fmt::formatted_size("{}", now) == 24 );
+    REQUIRE( now.ns > INT64_C(1700000000000000000) );
+}
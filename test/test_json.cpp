@@ -0,0 +1,89 @@
+#include "catch.hpp"
+
+#include "zen_json.h"
+#include <cmath>
+#include <string>
+
+TEST_CASE("json writer", "[utility]")
+{
+    zen::fmt::dynamic_buffer<> out{};
+    zen::json_writer json{out};
+
+    SECTION("compact") {
+        json.begin_object()
+            .member("id", 7)
+            .member("neg", i64(-12))
+            .member("ratio", 0.5)
+            .member("ok", true)
+            .member("none", nullptr)
+            .key("tags").begin_array().value("a").value('b').begin_object().end_object().begin_array().end_array().end_array()
+            .key("raw").raw("[1,2]")
+            .end_object();
+        REQUIRE( json.complete() );
+        REQUIRE( out.view() == R"({"id":7,"neg":-12,"ratio":0.5,"ok":true,"none":null,"tags":["a","b",{},[]],"raw":[1,2]})" );
+    }
+
+    SECTION("pretty") {
+        zen::json_writer pretty{out, zen::json::layout::pretty};
+        pretty.begin_object().member("a", 1).key("b").begin_array().value(2).value(3).end_array().key("c").begin_object().end_object().end_object();
+        REQUIRE( out.view() == "{\n  \"a\": 1,\n  \"b\": [\n    2,\n    3\n  ],\n  \"c\": {}\n}" );
+    }
+
+    SECTION("scalar root") {
+        json.value(1.5f);
+        REQUIRE( json.complete() );
+        REQUIRE( out.view() == "1.5" );
+    }
+
+    SECTION("non-finite floats") {
+        json.begin_array().value(INFINITY).value(-INFINITY).value(NAN).value(1e20).end_array();
+        REQUIRE( out.view() == "[null,null,null,1e+20]" );
+    }
+
+    SECTION("escaping") {
+        const char* null_str = nullptr;
+        json.begin_array()
+            .value("quote\" backslash\\ slash/")
+            .value("\b\f\n\r\t")
+            .value(std::string{"\x01\x1f\x7f"})
+            .value("caf\xc3\xa9")
+            .value(null_str)
+            .end_array();
+        REQUIRE( out.view() == R"(["quote\" backslash\\ slash/","\b\f\n\r\t","\u0001\u001f)" "\x7f" R"(","caf)" "\xc3\xa9" R"(",null])" );
+    }
+
+    SECTION("long strings take the vector path") {
+        // Escapes at every offset of a chunk, and past the last whole chunk
+        for (usize at = 0; at < 70; ++at) {
+            std::string s(70, 'x');
+            s[at] = at % 2 ? '"' : '\n';
+            s[69 - at / 2] = char(0xe9);
+            zen::fmt::dynamic_buffer<> expected{};
+            expected.append('"');
+            for (char c : s) {
+                if (c == '"')       expected.append("\\\"", 2);
+                else if (c == '\n') expected.append("\\n", 2);
+                else                expected.append(c);
+            }
+            expected.append('"');
+
+            zen::fmt::dynamic_buffer<> escaped{};
+            zen::json::write_string(escaped, s);
+            REQUIRE( escaped.view() == expected.view() );
+        }
+    }
+
+    SECTION("owned buffer is reused") {
+        zen::json_writer<> owned{};
+        std::string big(1000, 'x');
+        owned.begin_array().value(big).end_array();
+        const char* data = owned.sink().data();
+        REQUIRE( owned.sink().size() == 1004 );
+
+        owned.reset();
+        REQUIRE( !owned.complete() );
+        owned.begin_object().member("k", "v").end_object();
+        REQUIRE( owned.sink().view() == R"({"k":"v"})" );
+        REQUIRE( owned.sink().data() == data );
+    }
+}
@@ -0,0 +1,94 @@
+#include "catch.hpp"
+
+#include "zen_log.h"
+#include <string>
+
+#ifdef ZEN_PLATFORM_LINUX
+
+static std::string read_file(FILE* f) {
+    std::string s(1 << 20, '\0');
+    const ssize_t n = pread(fileno(f), s.data(), s.size(), 0);
+    s.resize(n < 0 ? 0 : usize(n));
+    return s;
+}
+
+static usize count_lines(std::string_view s, std::string_view prefix) {
+    usize n{};
+    for (usize i = s.find(prefix); i != std::string_view::npos; i = s.find(prefix, i + 1)) ++n;
+    return n;
+}
+
+TEST_CASE("log formats on the logger thread", "[utility]") 
+{
+    FILE* f = tmpfile();
+    {
+        zen::logging::logger log{fileno(f)};
+        const std::string owned{"owned"};
+        const char* cstr = "cstr";
+        ZEN_LOG_INFO(log, "plain");
+        ZEN_LOG_WARN(log, "{} {:>5} {x:} {:.2}", owned, cstr, 255, 1.5);
+        ZEN_LOG_ERROR(log, "{} {} {}", std::string_view{"view"}, 'c', -7);
+        ZEN_LOG_INFO(log, "{name:>{width}}", zen::fmt::named<"name">(owned), zen::fmt::named<"width">(7));
+        log.flush();
+        REQUIRE( read_file(f) == "[info] plain\n[warn] owned  cstr 0xff 1.50\n[error] view c -7\n[info]   owned\n" );
+
+        log.set_level(zen::logging::level::warn);
+        ZEN_LOG_INFO(log, "filtered {}", 1);
+        ZEN_LOG_WARN(log, "kept {}", 2);
+
+        // Arguments of filtered levels are never evaluated
+        int evaluated{};
+        auto arg = [&] { ++evaluated; return std::string(8000, 'l'); };
+        ZEN_LOG_DEBUG(log, "filtered {}", arg());
+        ZEN_LOG_INFO(log, "filtered {}", arg());
+        REQUIRE( evaluated == 0 );
+        ZEN_LOG_ERROR(log, "kept {}", arg().size());
+        REQUIRE( evaluated == 1 );
+    }
+    REQUIRE( read_file(f).ends_with("[info]   owned\n[warn] kept 2\n[error] kept 8000\n") );
+    fclose(f);
+}
+
+TEST_CASE("log overflow policies", "[utility]") 
+{
+    using zen::logging::overflow;
+    const std::string payload(1000, 'p');
+
+    SECTION("drop") {
+        FILE* f = tmpfile();
+        {
+            zen::logging::logger log{fileno(f), {.ring_size = 4096, .policy = overflow::drop, .idle_sleep_us = 100000}};
+            ZEN_LOG_INFO(log, "first");
+            log.flush();
+            for (int i = 0; i < 100; ++i) ZEN_LOG_INFO(log, "{} {}", i, payload);
+            log.flush();
+        }
+        const auto out = read_file(f);
+        const usize kept = count_lines(out, "[info] ");
+        REQUIRE( kept < 101 );
+        REQUIRE( out.find("[warn] dropped " + std::to_string(101 - kept) + " log messages\n") != std::string::npos );
+        fclose(f);
+    }
+    SECTION("block and grow keep everything") {
+        for (auto policy : {overflow::block, overflow::grow}) {
+            FILE* f = tmpfile();
+            {
+                zen::logging::logger log{fileno(f), {.ring_size = 4096, .policy = policy}};
+                std::thread other{[&] { for (int i = 0; i < 500; ++i) ZEN_LOG_DEBUG(log, "other {} {}", i, payload); }};
+                for (int i = 0; i < 500; ++i) ZEN_LOG_INFO(log, "main {} {}", i, payload);
+                // Larger than the initial ring
+                ZEN_LOG_INFO(log, "large {}", std::string(8000, 'l'));
+                other.join();
+            }
+            const auto out = read_file(f);
+            REQUIRE( count_lines(out, "[debug] other ") == 500 );
+            REQUIRE( count_lines(out, "[info] main ") == 500 );
+            REQUIRE( count_lines(out, "[info] large ") == (policy == overflow::grow ? 1 : 0) );
+            // Messages from one thread stay in order
+            REQUIRE( out.find("[info] main 499 ") > out.find("[info] main 0 ") );
+            fclose(f);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,87 @@
+#include "catch.hpp"
+
+#include "zen_multi_matcher.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+
+using match_list = std::vector<std::pair<u32, usize>>;
+
+match_list naive_matches(std::string_view text, const std::vector<zen::string_view>& patterns) {
+    match_list out;
+    for (u32 p = 0; p < patterns.size(); ++p) {
+        if (patterns[p].empty())
+            continue;
+        for (usize pos = text.find(patterns[p]); pos != std::string_view::npos; pos = text.find(patterns[p], pos + 1))
+            out.emplace_back(p, pos);
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+match_list matches(const zen::multi_matcher& m, std::string_view text) {
+    match_list out;
+    m.for_each(text, [&](zen::multi_match hit) { out.emplace_back(hit.pattern, hit.pos); });
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+}
+
+// Compares with one find per pattern at every text length, so the prefilter's block loop and tail are both hit
+TEST_CASE("multi_matcher", "[Utilities]")
+{
+    std::string text;
+    for (int i = 0; i < 300; ++i)
+        text += char('a' + (i * 7 + i / 11) % 6);
+    text += "connection refused: timeout after error\xe9\xff";
+
+    SECTION("few patterns") {
+        const std::vector<zen::string_view> patterns{"error", "timeout", "refused", "ab", "abcd", "b", "cfd", "ab", "\xe9\xff", "", "zzz"};
+        const zen::multi_matcher m{patterns};
+        REQUIRE( m.size() == patterns.size() );
+        REQUIRE( m.pattern(2) == "refused" );
+        for (usize len = 0; len <= text.size(); ++len) {
+            const std::string_view s{text.data(), len};
+            REQUIRE( matches(m, s) == naive_matches(s, patterns) );
+        }
+        REQUIRE( m.count(text) == naive_matches(text, patterns).size() );
+        REQUIRE( m.contains_any("xx timeout") );
+        REQUIRE_FALSE( m.contains_any("xx time out") );
+        REQUIRE_FALSE( m.contains_any("") );
+    }
+
+    SECTION("many patterns") {
+        std::vector<std::string> words;
+        for (int i = 0; i < 300; ++i) {
+            std::string w;
+            for (int j = 0; j < 2 + i % 7; ++j)
+                w += char('a' + (i * 13 + j * 5 + i / 17) % 6);
+            words.push_back(w);
+        }
+        words.push_back("refused");
+        words.push_back("\xe9");
+        const std::vector<zen::string_view> patterns{words.begin(), words.end()};
+        const zen::multi_matcher m{patterns};
+        REQUIRE_FALSE( m.prefiltered() );
+        for (usize len = 0; len <= text.size(); len += 7) {
+            const std::string_view s{text.data(), len};
+            REQUIRE( matches(m, s) == naive_matches(s, patterns) );
+        }
+    }
+
+    SECTION("stop early") {
+        const std::vector<zen::string_view> patterns{"a", "b"};
+        const zen::multi_matcher m{patterns};
+        usize seen = 0;
+        m.for_each(text, [&](zen::multi_match) { return ++seen < 3; });
+        REQUIRE( seen == 3 );
+    }
+
+    SECTION("no patterns") {
+        const zen::multi_matcher m{zen::span<const zen::string_view>{}};
+        REQUIRE( m.count(text) == 0 );
+    }
+}
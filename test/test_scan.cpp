@@ -0,0 +1,94 @@
+#include "catch.hpp"
+
+#include "zen_scan.h"
+#include <string>
+
+TEST_CASE("scan", "[utility]")
+{
+    using zen::scan_error;
+
+    SECTION("fields") {
+        zen::string_view host{};
+        u16 port{};
+        i32 x{};
+        f64 ratio{};
+        bool ok{};
+        char c{};
+        const auto r = zen::scan("10.0.0.1:8080 x=-3 ratio=0.25 ok=true c=z", "{}:{} x={} ratio={} ok={} c={}", host, port, x, ratio, ok, c);
+        REQUIRE( r );
+        REQUIRE( r.value() == 41 );
+        REQUIRE( host == "10.0.0.1" );
+        REQUIRE( port == 8080 );
+        REQUIRE( x == -3 );
+        REQUIRE( ratio == 0.25 );
+        REQUIRE( ok );
+        REQUIRE( c == 'z' );
+    }
+
+    SECTION("styles and widths") {
+        u32 h{}, b{}, o{}, plain{};
+        i64 neg{};
+        u8 byte{};
+        REQUIRE( zen::scan("0xff ff 0b101 0o17 0x-10 7f", "{x:} {x:} {b:} {o:} {x:} {x:}", h, plain, b, o, neg, byte) );
+        REQUIRE( (h == 255 && plain == 255 && b == 5 && o == 15 && neg == -16 && byte == 0x7f) );
+
+        u32 year{}, month{}, day{};
+        REQUIRE( zen::scan("20261016", "{:4}{:2}{:2}", year, month, day).value() == 8 );
+        REQUIRE( (year == 2026 && month == 10 && day == 16) );
+
+        std::string a{}, rest{};
+        REQUIRE( zen::scan("abcdef", "{:2}{}", a, rest) );
+        REQUIRE( (a == "ab" && rest == "cdef") );
+    }
+
+    SECTION("strings") {
+        zen::string_view a{}, b{};
+        std::string owned{};
+        REQUIRE( zen::scan("key=value rest", "{}={} {}", a, b, owned) );
+        REQUIRE( (a == "key" && b == "value" && owned == "rest") );
+
+        // Ends at whitespace when another field follows directly
+        i32 n{};
+        REQUIRE( zen::scan("name 12", "{}{}", a, n).code() == scan_error::invalid );
+        REQUIRE( zen::scan("name12", "{:4}{}", a, n) );
+        REQUIRE( (a == "name" && n == 12) );
+
+        REQUIRE( zen::scan("[]", "[{}]", a) );
+        REQUIRE( a.empty() );
+    }
+
+    SECTION("literals") {
+        i32 v{};
+        REQUIRE( zen::scan("{7}", "{{{}}}", v) );
+        REQUIRE( v == 7 );
+        REQUIRE( zen::scan("trailing is not consumed", "trailing") .value() == 8 );
+    }
+
+    SECTION("failures report where they happened") {
+        i32 a{}, b{};
+        const auto literal = zen::scan("1,2", "{}:{}", a, b);
+        REQUIRE( (literal.code() == scan_error::literal && literal.value() == 1) );
+
+        const auto invalid = zen::scan("1:x", "{}:{}", a, b);
+        REQUIRE( (invalid.code() == scan_error::invalid && invalid.value() == 2) );
+
+        i8 small{};
+        const auto overflow = zen::scan("v=300", "v={}", small);
+        REQUIRE( (overflow.code() == scan_error::overflow && overflow.value() == 2) );
+
+        const auto end = zen::scan("1:", "{}:{}", a, b);
+        REQUIRE( (end.code() == scan_error::end && end.value() == 2) );
+
+        const auto short_literal = zen::scan("1", "{}:{}", a, b);
+        REQUIRE( (short_literal.code() == scan_error::end && short_literal.value() == 1) );
+    }
+
+    SECTION("runtime format") {
+        i32 a{};
+        zen::string_view s{};
+        REQUIRE( zen::scan("a 5", zen::fmt::runtime("{1} {0}"), a, s) );
+        REQUIRE( (a == 5 && s == "a") );
+        REQUIRE( zen::scan("5", zen::fmt::runtime("{:>3}"), a).code() == scan_error::format );
+        REQUIRE( zen::scan("5", zen::fmt::runtime("{} {}"), a).code() == scan_error::format );
+    }
+}
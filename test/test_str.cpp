@@ -0,0 +1,126 @@
+#include "catch.hpp"
+
+#include "zen_str.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// Searches at every length and position, so the vector paths, their tails and the scalar fallbacks are all hit
+TEST_CASE("str search", "[Utilities]")
+{
+    std::string text;
+    for (int i = 0; i < 200; ++i)
+        text += char('a' + (i * 7 + i / 13) % 5);
+    text[150] = 'x';
+    text[171] = '\xe9';
+
+    SECTION("find and rfind") {
+        const char* needles[]{"a", "ab", "bca", "x", "cdaeb", "dbeacdbeacdbeacdbea", "zz", "\xe9", "ecx", ""};
+        for (usize len = 0; len <= text.size(); len += (len < 70 ? 1 : 13)) {
+            const std::string_view s{text.data(), len};
+            for (const char* needle: needles) {
+                for (usize pos: {usize(0), usize(1), usize(17), usize(40), len, len + 3, zen::str::npos - 3, zen::str::npos}) {
+                    REQUIRE( zen::str::find(s, needle, pos) == s.find(needle, pos) );
+                    REQUIRE( zen::str::find(s, needle[0], pos) == s.find(needle[0], pos) );
+                    REQUIRE( zen::str::rfind(s, needle, pos) == s.rfind(needle, pos) );
+                }
+                REQUIRE( zen::str::find(s, needle[0]) == s.find(needle[0]) );
+                REQUIRE( zen::str::rfind(s, needle[0]) == s.rfind(needle[0]) );
+                REQUIRE( zen::str::count(s, needle[0]) == usize(std::count(s.begin(), s.end(), needle[0])) );
+            }
+        }
+    }
+
+    SECTION("find_any") {
+        const char* sets[]{"x", "ex", "xyz\xe9", "\xe9", "qwrtyuioxp", "0123456789"};
+        for (const char* chars: sets) {
+            const zen::str::byteset set{chars};
+            for (usize len = 0; len <= text.size(); ++len) {
+                const std::string_view s{text.data(), len};
+                REQUIRE( zen::str::find_any(s, set) == s.find_first_of(chars) );
+                for (usize pos: {usize(160), len, len + 3, zen::str::npos - 3, zen::str::npos})
+                    REQUIRE( zen::str::find_any(s, set, pos) == s.find_first_of(chars, pos) );
+            }
+        }
+        REQUIRE( zen::str::byteset{"aab"}.size() == 2 );
+        REQUIRE( zen::str::byteset{"\xe9"}.contains('\xe9') );
+        REQUIRE( !zen::str::byteset{"\xe9"}.contains('i') );
+    }
+
+    SECTION("equal, starts_with, ends_with") {
+        for (usize len = 0; len <= 70; ++len) {
+            std::string a = text.substr(0, len), b = a;
+            REQUIRE( zen::str::equal(a, b) );
+            REQUIRE( zen::str::starts_with(text, a) );
+            REQUIRE( zen::str::ends_with(text, text.substr(text.size() - len)) );
+            for (usize i = 0; i < len; ++i) {
+                b[i] ^= 1;
+                REQUIRE( !zen::str::equal(a, b) );
+                REQUIRE( !zen::str::starts_with(text, b) );
+                b[i] ^= 1;
+            }
+        }
+        REQUIRE( !zen::str::equal("abc", "ab") );
+        REQUIRE( !zen::str::starts_with("ab", "abc") );
+        REQUIRE( !zen::str::ends_with("ab", "abc") );
+    }
+
+    SECTION("sstring") {
+        zen::sstring<32> s;
+        s.append("key=value; other=thing");
+        REQUIRE( zen::str::find(s, "other") == 11 );
+        REQUIRE( zen::str::find_any(s, zen::str::byteset{";="}) == 3 );
+        REQUIRE( zen::str::count(s, '=') == 2 );
+        REQUIRE( zen::str::starts_with(s, "key") );
+    }
+}
+
+// Reference split with string_view::find_first_of
+static std::vector<std::string_view> split_fields(std::string_view s, std::string_view delims)
+{
+    std::vector<std::string_view> fields;
+    for (usize start = 0; ; ) {
+        const usize end = s.find_first_of(delims, start);
+        fields.push_back(s.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start));
+        if (end == std::string_view::npos)
+            return fields;
+        start = end + 1;
+    }
+}
+
+TEST_CASE("str split", "[Utilities]")
+{
+    SECTION("fields") {
+        std::vector<std::string_view> fields;
+        for (std::string_view f: zen::split("a,b,,c", ','))
+            fields.push_back(f);
+        REQUIRE( fields == std::vector<std::string_view>{"a", "b", "", "c"} );
+
+        fields.clear();
+        for (std::string_view f: zen::split("", ','))
+            fields.push_back(f);
+        REQUIRE( fields == std::vector<std::string_view>{""} );
+
+        fields.clear();
+        for (std::string_view f: zen::split("key=value; k2=v2;", "=;"))
+            fields.push_back(f);
+        REQUIRE( fields == std::vector<std::string_view>{"key", "value", " k2", "v2", ""} );
+    }
+
+    SECTION("block boundaries") {
+        // Fields of every length across the 64 char blocks, with small and large delimiter sets
+        std::string text;
+        for (int i = 0; i < 400; ++i)
+            text += (i * i) % 37 == 0 || i % 61 == 63 % 61 ? ',' : (i % 89 == 0 ? '\t' : char('a' + i % 26));
+        const char* delim_sets[]{",", ",\t", ",\tabcdefghi"};
+        for (const char* delims: delim_sets) {
+            for (usize len = 0; len <= text.size(); len += (len < 140 ? 1 : 17)) {
+                const std::string_view s{text.data(), len};
+                std::vector<std::string_view> fields;
+                for (std::string_view f: zen::split(s, delims))
+                    fields.push_back(f);
+                REQUIRE( fields == split_fields(s, delims) );
+            }
+        }
+    }
+}
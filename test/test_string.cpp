@@ -0,0 +1,105 @@
+#include "catch.hpp"
+
+#include "zen_fmt.h"
+#include "zen_small_vec.h"
+
+TEST_CASE("small_string", "[Utilities]")
+{
+    SECTION("layout") {
+        REQUIRE( sizeof(zen::string) == ZEN_CACHE_LINE );
+        REQUIRE( zen::mem::is_trivially_relocatable<zen::string> );
+    }
+
+    SECTION("append and grow") {
+        zen::small_string<8> s;
+        REQUIRE( s.empty() );
+        REQUIRE( s.small() );
+        REQUIRE( 8 == s.capacity() );
+
+        s.append("abcdefgh");
+        REQUIRE( s.small() );
+        REQUIRE( s == "abcdefgh" );
+
+        s += 'i';
+        REQUIRE( !s.small() );
+        REQUIRE( 16 == s.capacity() );
+        REQUIRE( s == "abcdefghi" );
+
+        s.append_n('-', 40);
+        REQUIRE( 49 == s.size() );
+        REQUIRE( 64 == s.capacity() );
+        REQUIRE( s.back() == '-' );
+
+        s.resize(3);
+        s.shrink_to_fit();
+        REQUIRE( s.small() );
+        REQUIRE( s == "abc" );
+
+        // Appending a view of itself while growing reads the old chars
+        s.append("defgh");
+        s.append(s.view());
+        REQUIRE( s == "abcdefghabcdefgh" );
+    }
+
+    SECTION("copy and move") {
+        zen::small_string<8> small{"abc"};
+        zen::small_string<8> heap{"abcdefghijklmnop"};
+
+        zen::small_string<8> a{small};
+        zen::small_string<8> b{heap};
+        REQUIRE( a == small );
+        REQUIRE( b == heap );
+        REQUIRE( b.data() != heap.data() );
+
+        const char* heap_data = heap.data();
+        zen::small_string<8> c{std::move(heap)};
+        REQUIRE( c.data() == heap_data );
+        REQUIRE( heap.empty() );
+        REQUIRE( heap.small() );
+
+        zen::small_string<8> d{std::move(small)};
+        REQUIRE( d == "abc" );
+        REQUIRE( small.empty() );
+
+        d = std::move(c);
+        REQUIRE( d.data() == heap_data );
+        c = d;
+        REQUIRE( c == d );
+    }
+
+    SECTION("allocator") {
+        char storage[256];
+        zen::mem_buffer arena{storage, sizeof(storage), std::pmr::null_memory_resource()};
+        zen::small_string<8> s{&arena};
+        s.append("a string longer than the inline chars");
+        REQUIRE( s.data() >= storage );
+        REQUIRE( s.data() < storage + sizeof(storage) );
+
+        // Different resources copy instead of stealing the memory
+        zen::small_string<8> t;
+        t = std::move(s);
+        REQUIRE( t == "a string longer than the inline chars" );
+        REQUIRE( (t.data() < storage || t.data() >= storage + sizeof(storage)) );
+    }
+
+    SECTION("format and relocate") {
+        zen::string s;
+        zen::format(s, "{} + {} = {:4}", 1, 2.5, "x");
+        REQUIRE( s == "1 + 2.5 = x   " );
+
+        zen::fmt::buffer<64> out;
+        zen::format(out, "[{}]", s);
+        REQUIRE( zen::string_view(out) == "[1 + 2.5 = x   ]" );
+
+        zen::small_vec<zen::small_string<8>, 2> v;
+        for (int i = 0; i < 8; ++i) {
+            v.emplace_back();
+            zen::format(v.back(), "string number {}", i);
+        }
+        for (int i = 0; i < 8; ++i) {
+            zen::string expected;
+            zen::format(expected, "string number {}", i);
+            REQUIRE( v[i] == expected.view() );
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#include "catch.hpp"
+
+#include "zen_string_pool.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("string_pool", "[Utilities]")
+{
+    zen::string_pool pool;
+
+    SECTION("intern and find") {
+        const zen::string_id a = pool.intern("cpu.usage");
+        const zen::string_id b = pool.intern("mem.free");
+        const zen::string_id e = pool.intern("");
+        REQUIRE( 0 == a.value() );
+        REQUIRE( 1 == b.value() );
+        REQUIRE( 2 == e.value() );
+        REQUIRE( 3 == pool.size() );
+
+        REQUIRE( a == pool.intern("cpu.usage") );
+        REQUIRE( a == pool.find("cpu.usage") );
+        REQUIRE( e == pool.find("") );
+        REQUIRE( !pool.find("cpu.usag").valid() );
+        REQUIRE( !pool.find("cpu.usage ").valid() );
+        REQUIRE( 3 == pool.size() );
+
+        REQUIRE( pool.view(a) == "cpu.usage" );
+        REQUIRE( pool.view(b) == "mem.free" );
+        REQUIRE( pool.view(e).empty() );
+    }
+
+    SECTION("growth") {
+        std::vector<std::string> names;
+        for (int i = 0; i < 5000; ++i)
+            names.push_back("metric." + std::to_string(i * 7919));
+        for (usize i = 0; i < names.size(); ++i)
+            REQUIRE( i == pool.intern(names[i]).value() );
+        for (usize i = 0; i < names.size(); ++i) {
+            REQUIRE( i == pool.find(names[i]).value() );
+            REQUIRE( pool.view(zen::string_id{u32(i)}) == names[i] );
+        }
+    }
+
+    SECTION("intern_all") {
+        pool.intern("b");
+        const zen::string_view dict[]{"a", "b", "c", "a"};
+        zen::string_id ids[4]{};
+        pool.intern_all(dict, ids);
+        REQUIRE( 1 == ids[0].value() );
+        REQUIRE( 0 == ids[1].value() );
+        REQUIRE( 2 == ids[2].value() );
+        REQUIRE( ids[0] == ids[3] );
+        REQUIRE( 3 == pool.size() );
+    }
+
+    SECTION("concurrent") {
+        static constexpr int N_THREADS = 4, N_NAMES = 2000;
+        std::vector<std::string> names;
+        for (int i = 0; i < N_NAMES; ++i)
+            names.push_back("field_" + std::to_string(i));
+
+        std::vector<zen::string_id> ids[N_THREADS];
+        std::vector<std::thread> threads;
+        for (int t = 0; t < N_THREADS; ++t) {
+            threads.emplace_back([&, t] {
+                // Every thread interns all names in a different order, looking up what it has so far
+                for (int i = 0; i < N_NAMES; ++i) {
+                    const int n = (i * (2 * t + 1)) % N_NAMES;
+                    ids[t].push_back(pool.intern(names[n]));
+                    if (pool.view(ids[t].back()) != names[n] || pool.find(names[n]) != ids[t].back())
+                        ids[t].back() = zen::string_id{};
+                }
+            });
+        }
+        for (auto& t: threads)
+            t.join();
+
+        REQUIRE( N_NAMES == pool.size() );
+        for (int t = 0; t < N_THREADS; ++t) {
+            for (int i = 0; i < N_NAMES; ++i) {
+                const int n = (i * (2 * t + 1)) % N_NAMES;
+                REQUIRE( ids[t][i].valid() );
+                REQUIRE( ids[t][i] == pool.find(names[n]) );
+            }
+        }
+    }
+}
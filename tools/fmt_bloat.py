@@ -0,0 +1,61 @@
+"""Measures the code size and compile time that zen::format call sites cost
+
+Generates a translation unit with many format calls over different argument type lists,
+compiles it and reports the object size, the .text size and the compile time.
+
+Usage: python fmt_bloat.py [--calls N] [--cxx COMPILER] [--flags "FLAGS"]
+"""
+import argparse
+import random
+import subprocess
+import tempfile
+import time
+from pathlib import Path
+
+SRC = Path(__file__).parent.parent / 'src'
+
+ARGS = [
+    ('int', '{}', '42'), ('u64', '{}', 'u64(7)'), ('i8', '{}', 'i8(-3)'), ('u16', '{x:}', 'u16(255)'),
+    ('f64', '{:.3}', '3.25'), ('f32', '{}', '1.5f'), ('const char*', '{}', '"abc"'), ('bool', '{}', 'true'),
+    ('char', '{}', "'c'"), ('zen::string_view', '{:>8}', 'zen::string_view{"view"}'), ('i64', '{:*^9}', 'i64(-9)'),
+]
+
+
+def generate(calls: int) -> str:
+    rng = random.Random(1)
+    lines = ['#include "zen_fmt.h"', '', 'void format_calls(zen::fmt::dynamic_buffer<>& out) {']
+    for i in range(calls):
+        picked = [rng.choice(ARGS) for _ in range(rng.randint(1, 5))]
+        fmt = f'call{i}: ' + ' '.join(p[1] for p in picked)
+        lines.append(f'    zen::format(out, "{fmt}", {", ".join(p[2] for p in picked)});')
+    lines.append('}')
+    return '\n'.join(lines) + '\n'
+
+
+def section_size(obj: Path, name: str) -> int:
+    out = subprocess.run(['size', '-A', str(obj)], capture_output=True, text=True, check=True).stdout
+    return sum(int(line.split()[1]) for line in out.splitlines() if line.startswith(name))
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--calls', type=int, default=200)
+    parser.add_argument('--cxx', default='g++')
+    parser.add_argument('--flags', default='-std=c++20 -O2')
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as tmp:
+        src = Path(tmp) / 'bloat.cpp'
+        obj = Path(tmp) / 'bloat.o'
+        src.write_text(generate(args.calls))
+        start = time.perf_counter()
+        subprocess.run([args.cxx, *args.flags.split(), f'-I{SRC}', '-c', str(src), '-o', str(obj)], check=True)
+        elapsed = time.perf_counter() - start
+        print(f'calls:        {args.calls}')
+        print(f'compile time: {elapsed:.2f}s')
+        print(f'object size:  {obj.stat().st_size} bytes')
+        print(f'.text size:   {section_size(obj, ".text")} bytes')
+
+
+if __name__ == '__main__':
+    main()
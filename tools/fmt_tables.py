@@ -0,0 +1,102 @@
+"""Generates src/zen_fmt_tables.h, the power of ten tables used by the float conversions in zen_fmt_float.h
+
+Usage: python fmt_tables.py [OUTPUT]
+"""
+import sys
+from pathlib import Path
+
+OUTPUT = Path(__file__).parent.parent / 'src' / 'zen_fmt_tables.h'
+
+# Schubfach (float -> chars)
+# 10^-k = b * 2^r with 2^125 <= b < 2^126, g = floor(b) + 1 split into two 63-bit halves
+SCHUBFACH_K_MIN = -324
+SCHUBFACH_K_MAX = 292
+
+# Eisel-Lemire (chars -> float)
+# 5^q normalized to 128 bits, truncated for q >= 0 and rounded up for q < 0
+EISEL_LEMIRE_Q_MIN = -342
+EISEL_LEMIRE_Q_MAX = 308
+
+
+def flog2pow10(e: int) -> int:
+    return (e * 913124641741) >> 38
+
+
+def schubfach_g(k: int) -> int:
+    num, den = (10 ** -k, 1) if k <= 0 else (1, 10 ** k)
+    r = flog2pow10(-k) - 125
+    b = (num << -r) // den if r <= 0 else num // (den << r)
+    assert (1 << 125) <= b < (1 << 126), k
+    return b + 1
+
+
+def eisel_lemire_pow5(q: int) -> int:
+    if q >= 0:
+        p = 5 ** q
+        while p < (1 << 127):
+            p <<= 1
+        while p >= (1 << 128):
+            p >>= 1
+        return p
+    p = 5 ** -q
+    z = p.bit_length()
+    b = z + 127 if q >= -27 else 2 * z + 128
+    c = (1 << b) // p + 1
+    while c >= (1 << 128):
+        c >>= 1
+    return c
+
+
+def format_table(name: str, comment: str, rows: list, per_line: int) -> str:
+    lines = [f'// {comment}', f'static constexpr u64 {name}[{len(rows)}] = {{']
+    for i in range(0, len(rows), per_line):
+        lines.append('    ' + ' '.join(f'0x{v:016x},' for v in rows[i:i + per_line]))
+    lines.append('};')
+    return '\n'.join(lines)
+
+
+def main():
+    output = Path(sys.argv[1]) if len(sys.argv) > 1 else OUTPUT
+
+    schubfach = []
+    for k in range(SCHUBFACH_K_MIN, SCHUBFACH_K_MAX + 1):
+        g = schubfach_g(k)
+        schubfach += [g >> 63, g & ((1 << 63) - 1)]
+
+    eisel_lemire = []
+    for q in range(EISEL_LEMIRE_Q_MIN, EISEL_LEMIRE_Q_MAX + 1):
+        p = eisel_lemire_pow5(q)
+        assert (1 << 127) <= p < (1 << 128), q
+        eisel_lemire += [p >> 64, p & ((1 << 64) - 1)]
+
+    tables = [
+        format_table('SCHUBFACH_G', f'g1, g0 for k in [{SCHUBFACH_K_MIN}, {SCHUBFACH_K_MAX}]', schubfach, 2),
+        format_table('EISEL_LEMIRE_POW5', f'high, low for q in [{EISEL_LEMIRE_Q_MIN}, {EISEL_LEMIRE_Q_MAX}]', eisel_lemire, 2),
+    ]
+
+    output.write_text('\n'.join([
+        '#ifndef ZEN_FMT_TABLES_H',
+        '#define ZEN_FMT_TABLES_H',
+        '',
+        '// Generated by tools/fmt_tables.py, do not edit',
+        '',
+        '#include "zen_config.h"',
+        '',
+        'namespace zen::fmt::impl {',
+        '',
+        f'static constexpr int SCHUBFACH_K_MIN = {SCHUBFACH_K_MIN};',
+        f'static constexpr int SCHUBFACH_K_MAX = {SCHUBFACH_K_MAX};',
+        f'static constexpr int EISEL_LEMIRE_Q_MIN = {EISEL_LEMIRE_Q_MIN};',
+        f'static constexpr int EISEL_LEMIRE_Q_MAX = {EISEL_LEMIRE_Q_MAX};',
+        '',
+        '\n\n'.join(tables),
+        '',
+        '}',
+        '',
+        '#endif // ZEN_FMT_TABLES_H',
+        '',
+    ]))
+
+
+if __name__ == '__main__':
+    main()